@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/osal/linux/osal.c" "CMakeFiles/soem.dir/osal/linux/osal.c.o" "gcc" "CMakeFiles/soem.dir/osal/linux/osal.c.o.d"
+  "/root/repo/oshw/linux/nicdrv.c" "CMakeFiles/soem.dir/oshw/linux/nicdrv.c.o" "gcc" "CMakeFiles/soem.dir/oshw/linux/nicdrv.c.o.d"
+  "/root/repo/oshw/linux/oshw.c" "CMakeFiles/soem.dir/oshw/linux/oshw.c.o" "gcc" "CMakeFiles/soem.dir/oshw/linux/oshw.c.o.d"
+  "/root/repo/soem/ethercatbase.c" "CMakeFiles/soem.dir/soem/ethercatbase.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatbase.c.o.d"
+  "/root/repo/soem/ethercatcoe.c" "CMakeFiles/soem.dir/soem/ethercatcoe.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatcoe.c.o.d"
+  "/root/repo/soem/ethercatconfig.c" "CMakeFiles/soem.dir/soem/ethercatconfig.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatconfig.c.o.d"
+  "/root/repo/soem/ethercatdc.c" "CMakeFiles/soem.dir/soem/ethercatdc.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatdc.c.o.d"
+  "/root/repo/soem/ethercateoe.c" "CMakeFiles/soem.dir/soem/ethercateoe.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercateoe.c.o.d"
+  "/root/repo/soem/ethercatfoe.c" "CMakeFiles/soem.dir/soem/ethercatfoe.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatfoe.c.o.d"
+  "/root/repo/soem/ethercatmain.c" "CMakeFiles/soem.dir/soem/ethercatmain.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatmain.c.o.d"
+  "/root/repo/soem/ethercatprint.c" "CMakeFiles/soem.dir/soem/ethercatprint.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatprint.c.o.d"
+  "/root/repo/soem/ethercatsoe.c" "CMakeFiles/soem.dir/soem/ethercatsoe.c.o" "gcc" "CMakeFiles/soem.dir/soem/ethercatsoe.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,33 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/soem.dir/osal/linux/osal.c.o"
+  "CMakeFiles/soem.dir/osal/linux/osal.c.o.d"
+  "CMakeFiles/soem.dir/oshw/linux/nicdrv.c.o"
+  "CMakeFiles/soem.dir/oshw/linux/nicdrv.c.o.d"
+  "CMakeFiles/soem.dir/oshw/linux/oshw.c.o"
+  "CMakeFiles/soem.dir/oshw/linux/oshw.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatbase.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatbase.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatcoe.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatcoe.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatconfig.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatconfig.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatdc.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatdc.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercateoe.c.o"
+  "CMakeFiles/soem.dir/soem/ethercateoe.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatfoe.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatfoe.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatmain.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatmain.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatprint.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatprint.c.o.d"
+  "CMakeFiles/soem.dir/soem/ethercatsoe.c.o"
+  "CMakeFiles/soem.dir/soem/ethercatsoe.c.o.d"
+  "libsoem.a"
+  "libsoem.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/soem.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eepromtool.dir/eepromtool.c.o"
+  "CMakeFiles/eepromtool.dir/eepromtool.c.o.d"
+  "eepromtool"
+  "eepromtool.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/eepromtool.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
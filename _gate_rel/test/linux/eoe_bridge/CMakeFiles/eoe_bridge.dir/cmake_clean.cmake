@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eoe_bridge.dir/eoe_bridge.c.o"
+  "CMakeFiles/eoe_bridge.dir/eoe_bridge.c.o.d"
+  "eoe_bridge"
+  "eoe_bridge.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/eoe_bridge.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/foe_update.dir/foe_update.c.o"
+  "CMakeFiles/foe_update.dir/foe_update.c.o.d"
+  "foe_update"
+  "foe_update.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/foe_update.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
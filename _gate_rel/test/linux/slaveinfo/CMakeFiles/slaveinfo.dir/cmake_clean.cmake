@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/slaveinfo.dir/slaveinfo.c.o"
+  "CMakeFiles/slaveinfo.dir/slaveinfo.c.o.d"
+  "slaveinfo"
+  "slaveinfo.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/slaveinfo.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/simple_ng.dir/simple_ng.c.o"
+  "CMakeFiles/simple_ng.dir/simple_ng.c.o.d"
+  "simple_ng"
+  "simple_ng.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/simple_ng.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
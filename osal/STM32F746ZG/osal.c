@@ -1,4 +1,6 @@
 #include "osal.h"
+#include <stdlib.h>
+#include <string.h>
 
 #include "stm32f7xx_hal.h"
 
@@ -66,6 +68,35 @@ ec_timet osal_current_time(void)
 	return rval;
 }
 
+uint64 osal_monotonic_ns(void)
+{
+	ec_timet current = osal_current_time();
+	return (uint64)current.sec * 1000000000ULL + (uint64)current.usec * 1000ULL;
+}
+
+uint64 osal_realtime_ns(void)
+{
+	ec_timet current = osal_current_time();
+
+	return (uint64)current.sec * 1000000000ULL + (uint64)current.usec * 1000ULL;
+}
+
+uint64 osal_tai_ns(void)
+{
+	return osal_realtime_ns() + (uint64)OSAL_TAI_UTC_OFFSET * 1000000000ULL;
+}
+
+int osal_sleep_until_ns(uint64 wakeup_ns)
+{
+	uint64 now = osal_monotonic_ns();
+
+	if (wakeup_ns > now)
+	{
+		return osal_usleep((uint32)((wakeup_ns - now) / 1000));
+	}
+	return 0;
+}
+
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff)
 {
 	if (end->usec < start->usec)
@@ -89,3 +120,56 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
 {
 	return 1;												//TODO not supported
 }
+
+void osal_thread_attr_init(osal_thread_attrt *attr, int stacksize)
+{
+	attr->policy = OSAL_SCHED_FIFO;
+	attr->priority = 40;
+	attr->runtime_ns = 0;
+	attr->deadline_ns = 0;
+	attr->period_ns = 0;
+	attr->cpuset = 0;
+	attr->lockmemory = FALSE;
+	attr->stacksize = stacksize;
+	attr->prefault = 0;
+}
+
+/* this port only supports the stack size, FIFO, RR and priority map to the
+ * fixed priority of osal_thread_create_rt(). lockmemory and prefault are
+ * met as memory is always resident. DEADLINE and cpuset are not supported
+ * and fail. */
+int osal_thread_create_rt_attr(void *thandle, const osal_thread_attrt *attr, void *func, void *param)
+{
+	if ((attr->policy == OSAL_SCHED_DEADLINE) || attr->cpuset)
+	{
+		return 0;
+	}
+	return osal_thread_create_rt(thandle, attr->stacksize, func, param);
+}
+
+/* no paging on this target, memory is always resident */
+int osal_mem_lock(void *p, size_t size)
+{
+	(void)p;
+	(void)size;
+	return 1;
+}
+
+void *osal_mem_alloc_locked(size_t size, boolean hugepages)
+{
+	void *p;
+
+	(void)hugepages;
+	p = malloc(size);
+	if (p != NULL)
+	{
+		memset(p, 0, size);
+	}
+	return p;
+}
+
+void osal_mem_free_locked(void *p, size_t size)
+{
+	(void)size;
+	free(p);
+}
@@ -45,6 +45,34 @@ ec_timet osal_current_time(void)
    	return ret;
 }
 
+uint64 osal_monotonic_ns(void)
+{
+   	return osEE_x86_64_tsc_read();
+}
+
+uint64 osal_realtime_ns(void)
+{
+   ec_timet current = osal_current_time();
+
+   return (uint64)current.sec * 1000000000ULL + (uint64)current.usec * 1000ULL;
+}
+
+uint64 osal_tai_ns(void)
+{
+   return osal_realtime_ns() + (uint64)OSAL_TAI_UTC_OFFSET * 1000000000ULL;
+}
+
+int osal_sleep_until_ns(uint64 wakeup_ns)
+{
+   uint64 now = osal_monotonic_ns();
+
+   if (wakeup_ns > now)
+   {
+      return osal_usleep((uint32)((wakeup_ns - now) / 1000));
+   }
+   return 0;
+}
+
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff)
 {
    	if (end->usec < start->usec) {
@@ -101,3 +129,29 @@ void osal_free(void *ptr)
    	free(ptr);
 }
 
+/* no paging on this target, memory is always resident */
+int osal_mem_lock(void *p, size_t size)
+{
+   (void)p;
+   (void)size;
+   return 1;
+}
+
+void *osal_mem_alloc_locked(size_t size, boolean hugepages)
+{
+   void *p;
+
+   (void)hugepages;
+   p = malloc(size);
+   if (p != NULL)
+   {
+      memset(p, 0, size);
+   }
+   return p;
+}
+
+void osal_mem_free_locked(void *p, size_t size)
+{
+   (void)size;
+   free(p);
+}
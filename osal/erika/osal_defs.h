@@ -30,6 +30,9 @@ extern "C"
 #define PACKED_END
 #endif
 
+/* no osal_thread_join and osal_mutex support, slave mapping runs serially */
+#define EC_MAX_MAPT 1
+
 int osal_gettimeofday(struct timeval *tv, struct timezone *tz);
 void *osal_malloc(size_t size);
 void osal_free(void *ptr);
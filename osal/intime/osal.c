@@ -5,6 +5,8 @@
 
 #include <rt.h>
 #include <sys/time.h>
+#include <stdlib.h>
+#include <string.h>
 #include <osal.h>
 
 static int64_t sysfrequency;
@@ -28,6 +30,37 @@ ec_timet osal_current_time (void)
    return return_value;
 }
 
+uint64 osal_monotonic_ns (void)
+{
+   struct timeval current_time;
+
+   osal_gettimeofday (&current_time, 0);
+   return (uint64)current_time.tv_sec * 1000000000ULL + (uint64)current_time.tv_usec * 1000ULL;
+}
+
+uint64 osal_realtime_ns (void)
+{
+   ec_timet current = osal_current_time();
+
+   return (uint64)current.sec * 1000000000ULL + (uint64)current.usec * 1000ULL;
+}
+
+uint64 osal_tai_ns (void)
+{
+   return osal_realtime_ns() + (uint64)OSAL_TAI_UTC_OFFSET * 1000000000ULL;
+}
+
+int osal_sleep_until_ns (uint64 wakeup_ns)
+{
+   uint64 now = osal_monotonic_ns();
+
+   if (wakeup_ns > now)
+   {
+      return osal_usleep((uint32)((wakeup_ns - now) / 1000));
+   }
+   return 0;
+}
+
 void osal_timer_start (osal_timert * self, uint32 timeout_usec)
 {
    struct timeval start_time;
@@ -86,3 +119,30 @@ osal_mutex_t * osal_mtx_create(void)
         /* return (void*)RtCreateMutex(NULL, FALSE, NULL); */
         return (void *)0;
 }
+
+/* no paging on this target, memory is always resident */
+int osal_mem_lock (void *p, size_t size)
+{
+   (void)p;
+   (void)size;
+   return 1;
+}
+
+void *osal_mem_alloc_locked (size_t size, boolean hugepages)
+{
+   void *p;
+
+   (void)hugepages;
+   p = malloc(size);
+   if (p != NULL)
+   {
+      memset(p, 0, size);
+   }
+   return p;
+}
+
+void osal_mem_free_locked (void *p, size_t size)
+{
+   (void)size;
+   free(p);
+}
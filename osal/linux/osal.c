@@ -3,7 +3,16 @@
  * LICENSE file in the project root for full license information
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <alloca.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <stdlib.h>
@@ -33,6 +42,50 @@ ec_timet osal_current_time(void)
    return return_value;
 }
 
+uint64 osal_monotonic_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+}
+
+uint64 osal_realtime_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_REALTIME, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+}
+
+uint64 osal_tai_ns(void)
+{
+#ifdef CLOCK_TAI
+   struct timespec ts;
+
+   /* kernel TAI offset is set by the time daemon, e.g. ptp4l or chrony */
+   clock_gettime(CLOCK_TAI, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+#else
+   return osal_realtime_ns() + (uint64)OSAL_TAI_UTC_OFFSET * 1000000000ULL;
+#endif
+}
+
+int osal_sleep_until_ns(uint64 wakeup_ns)
+{
+   struct timespec ts;
+   int return_value;
+
+   ts.tv_sec = wakeup_ns / 1000000000ULL;
+   ts.tv_nsec = wakeup_ns % 1000000000ULL;
+   /* absolute wakeup does not accumulate the time spent before the call */
+   do
+   {
+      return_value = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+   } while (return_value == EINTR);
+   return return_value;
+}
+
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff)
 {
    if (end->usec < start->usec) {
@@ -116,29 +169,306 @@ int osal_thread_create(void *thandle, int stacksize, void *func, void *param)
    return 1;
 }
 
+/* as before, returns 0 if real-time scheduling could not be set, f.e. no
+ * permission; the thread then still runs with normal scheduling */
 int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
+{
+   osal_thread_attrt attr;
+
+   osal_thread_attr_init(&attr, stacksize);
+   if (osal_thread_create_rt_attr(thandle, &attr, func, param))
+   {
+      return 1;
+   }
+   osal_thread_create(thandle, stacksize, func, param);
+   return 0;
+}
+
+/* defaults as osal_thread_create_rt(), SCHED_FIFO priority 40 on all CPUs */
+void osal_thread_attr_init(osal_thread_attrt *attr, int stacksize)
+{
+   memset(attr, 0, sizeof(*attr));
+   attr->policy = OSAL_SCHED_FIFO;
+   attr->priority = 40;
+   attr->stacksize = stacksize;
+}
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+/* argument of sched_setattr, not in all C libraries */
+struct osal_sched_attr
+{
+   uint32 size;
+   uint32 sched_policy;
+   uint64 sched_flags;
+   int32  sched_nice;
+   uint32 sched_priority;
+   uint64 sched_runtime;
+   uint64 sched_deadline;
+   uint64 sched_period;
+};
+
+/* handshake between creator and new thread */
+typedef struct
+{
+   const osal_thread_attrt *attr;
+   void  *(*func)(void *);
+   void  *param;
+   sem_t started;
+   int   result;
+} osal_thread_startt;
+
+/* touch stack pages so the first cycles do not page fault */
+static void osal_prefault_stack(int size)
+{
+   volatile uint8 *stack;
+   int i;
+
+   stack = alloca(size);
+   for (i = 0; i < size; i += 4096)
+   {
+      stack[i] = 0;
+   }
+}
+
+/* apply scheduling in the new thread, SCHED_DEADLINE can only be set there */
+static int osal_thread_apply(const osal_thread_attrt *attr)
+{
+   struct sched_param schparam;
+   struct osal_sched_attr schattr;
+   cpu_set_t cpus;
+   int cpu;
+
+   if (attr->cpuset)
+   {
+      CPU_ZERO(&cpus);
+      for (cpu = 0; cpu < 64; cpu++)
+      {
+         if (attr->cpuset & (1ULL << cpu))
+         {
+            CPU_SET(cpu, &cpus);
+         }
+      }
+      if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+      {
+         return 0;
+      }
+   }
+   if (attr->policy == OSAL_SCHED_DEADLINE)
+   {
+#ifdef SYS_sched_setattr
+      memset(&schattr, 0, sizeof(schattr));
+      schattr.size = sizeof(schattr);
+      schattr.sched_policy = SCHED_DEADLINE;
+      schattr.sched_runtime = attr->runtime_ns;
+      schattr.sched_deadline = attr->deadline_ns ? attr->deadline_ns : attr->period_ns;
+      schattr.sched_period = attr->period_ns;
+      if (syscall(SYS_sched_setattr, 0, &schattr, 0) != 0)
+      {
+         return 0;
+      }
+#else
+      (void)schattr;
+      return 0;
+#endif
+   }
+   else
+   {
+      memset(&schparam, 0, sizeof(schparam));
+      schparam.sched_priority = attr->priority;
+      if (pthread_setschedparam(pthread_self(),
+             (attr->policy == OSAL_SCHED_RR) ? SCHED_RR : SCHED_FIFO, &schparam) != 0)
+      {
+         return 0;
+      }
+   }
+   if (attr->prefault > 0)
+   {
+      osal_prefault_stack(attr->prefault);
+   }
+   return 1;
+}
+
+static void *osal_thread_start(void *arg)
+{
+   osal_thread_startt *start = arg;
+   void *(*func)(void *) = start->func;
+   void *param = start->param;
+   int result;
+
+   result = osal_thread_apply(start->attr);
+   start->result = result;
+   /* start is on the stack of the creator, not valid after the post */
+   sem_post(&start->started);
+   if (!result)
+   {
+      return NULL;
+   }
+   return func(param);
+}
+
+/* returns 1 only if the thread runs with all attributes applied */
+int osal_thread_create_rt_attr(void *thandle, const osal_thread_attrt *attr, void *func, void *param)
 {
    int                  ret;
-   pthread_attr_t       attr;
-   struct sched_param   schparam;
+   pthread_attr_t       pattr;
    pthread_t            *threadp;
+   osal_thread_startt   start;
+   int                  prefault;
+   osal_thread_attrt    tattr;
 
+   /* the kernel refuses SCHED_DEADLINE unless the affinity spans the whole
+    * root domain, restrict the CPUs with an exclusive cpuset instead */
+   if ((attr->policy == OSAL_SCHED_DEADLINE) && attr->cpuset)
+   {
+      errno = EINVAL;
+      return 0;
+   }
+   tattr = *attr;
+   /* leave room for the frames of func */
+   prefault = tattr.stacksize - 65536;
+   if (tattr.prefault > prefault)
+   {
+      tattr.prefault = (prefault > 0) ? prefault : 0;
+   }
+   if (tattr.lockmemory && (mlockall(MCL_CURRENT | MCL_FUTURE) != 0))
+   {
+      return 0;
+   }
    threadp = thandle;
-   pthread_attr_init(&attr);
-   pthread_attr_setstacksize(&attr, stacksize);
-   ret = pthread_create(threadp, &attr, func, param);
-   pthread_attr_destroy(&attr);
-   if(ret < 0)
+   start.attr = &tattr;
+   start.func = func;
+   start.param = param;
+   start.result = 0;
+   sem_init(&start.started, 0, 0);
+   pthread_attr_init(&pattr);
+   pthread_attr_setstacksize(&pattr, tattr.stacksize);
+   ret = pthread_create(threadp, &pattr, osal_thread_start, &start);
+   pthread_attr_destroy(&pattr);
+   if (ret != 0)
    {
+      sem_destroy(&start.started);
       return 0;
    }
-   memset(&schparam, 0, sizeof(schparam));
-   schparam.sched_priority = 40;
-   ret = pthread_setschedparam(*threadp, SCHED_FIFO, &schparam);
-   if(ret < 0)
+   while (sem_wait(&start.started) != 0)
+   {
+      if (errno != EINTR)
+      {
+         break;
+      }
+   }
+   sem_destroy(&start.started);
+   if (!start.result)
    {
+      pthread_join(*threadp, NULL);
       return 0;
    }
+   return 1;
+}
 
+int osal_thread_join(void *thandle)
+{
+   pthread_t            *threadp;
+
+   threadp = thandle;
+   if (pthread_join(*threadp, NULL) != 0)
+   {
+      return 0;
+   }
    return 1;
 }
+
+void *osal_mutex_create(void)
+{
+   pthread_mutex_t      *mutex;
+
+   mutex = malloc(sizeof(*mutex));
+   if (mutex && pthread_mutex_init(mutex, NULL))
+   {
+      free(mutex);
+      mutex = NULL;
+   }
+   return mutex;
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   if (mutex)
+   {
+      pthread_mutex_destroy(mutex);
+      free(mutex);
+   }
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   pthread_mutex_lock(mutex);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   pthread_mutex_unlock(mutex);
+}
+
+/* write access replaces shared zero pages and copy-on-write pages */
+static void osal_mem_touch(void *p, size_t size)
+{
+   volatile uint8 *b = p;
+   size_t page = (size_t)sysconf(_SC_PAGESIZE);
+   size_t i;
+
+   for (i = 0; i < size; i += page)
+   {
+      b[i] = b[i];
+   }
+   b[size - 1] = b[size - 1];
+}
+
+int osal_mem_lock(void *p, size_t size)
+{
+   if ((p == NULL) || (size == 0))
+   {
+      return 1;
+   }
+   osal_mem_touch(p, size);
+   return (mlock(p, size) == 0) ? 1 : 0;
+}
+
+void *osal_mem_alloc_locked(size_t size, boolean hugepages)
+{
+   void *p;
+   size_t align;
+
+   align = hugepages ? OSAL_HUGEPAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+   size = ((size + align - 1) / align) * align;
+   if (posix_memalign(&p, align, size) != 0)
+   {
+      return NULL;
+   }
+#ifdef MADV_HUGEPAGE
+   if (hugepages)
+   {
+      /* transparent hugepages, ignored if disabled in the kernel */
+      (void)madvise(p, size, MADV_HUGEPAGE);
+   }
+#endif
+   memset(p, 0, size);
+   if (!osal_mem_lock(p, size))
+   {
+      free(p);
+      return NULL;
+   }
+   return p;
+}
+
+void osal_mem_free_locked(void *p, size_t size)
+{
+   if (p == NULL)
+   {
+      return;
+   }
+   munlock(p, size);
+   free(p);
+}
@@ -5,6 +5,7 @@
 
 #include <time.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,6 +49,38 @@ ec_timet osal_current_time(void)
    return return_value;
 }
 
+uint64 osal_monotonic_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+}
+
+uint64 osal_realtime_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_REALTIME, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+}
+
+uint64 osal_tai_ns(void)
+{
+   return osal_realtime_ns() + (uint64)OSAL_TAI_UTC_OFFSET * 1000000000ULL;
+}
+
+int osal_sleep_until_ns(uint64 wakeup_ns)
+{
+   uint64 now = osal_monotonic_ns();
+
+   if (wakeup_ns > now)
+   {
+      return osal_usleep((uint32)((wakeup_ns - now) / 1000));
+   }
+   return 0;
+}
+
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff)
 {
    if (end->usec < start->usec) {
@@ -142,3 +175,128 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
 
    return 1;
 }
+
+void osal_thread_attr_init(osal_thread_attrt *attr, int stacksize)
+{
+   attr->policy = OSAL_SCHED_FIFO;
+   attr->priority = 40;
+   attr->runtime_ns = 0;
+   attr->deadline_ns = 0;
+   attr->period_ns = 0;
+   attr->cpuset = 0;
+   attr->lockmemory = FALSE;
+   attr->stacksize = stacksize;
+   attr->prefault = 0;
+}
+
+/* this port only supports the stack size, FIFO, RR and priority map to the
+ * fixed priority of osal_thread_create_rt(). DEADLINE, cpuset, lockmemory
+ * and prefault are not supported and fail. */
+int osal_thread_create_rt_attr(void *thandle, const osal_thread_attrt *attr, void *func, void *param)
+{
+   if ((attr->policy == OSAL_SCHED_DEADLINE) || attr->cpuset || attr->lockmemory ||
+       (attr->prefault > 0))
+   {
+      return 0;
+   }
+   return osal_thread_create_rt(thandle, attr->stacksize, func, param);
+}
+
+int osal_thread_join(void *thandle)
+{
+   pthread_t            *threadp;
+
+   threadp = thandle;
+   if (pthread_join(*threadp, NULL) != 0)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+void *osal_mutex_create(void)
+{
+   pthread_mutex_t      *mutex;
+
+   mutex = malloc(sizeof(*mutex));
+   if (mutex && pthread_mutex_init(mutex, NULL))
+   {
+      free(mutex);
+      mutex = NULL;
+   }
+   return mutex;
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   if (mutex)
+   {
+      pthread_mutex_destroy(mutex);
+      free(mutex);
+   }
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   pthread_mutex_lock(mutex);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   pthread_mutex_unlock(mutex);
+}
+
+/* write access replaces shared zero pages and copy-on-write pages */
+static void osal_mem_touch(void *p, size_t size)
+{
+   volatile uint8 *b = p;
+   size_t page = (size_t)sysconf(_SC_PAGESIZE);
+   size_t i;
+
+   for (i = 0; i < size; i += page)
+   {
+      b[i] = b[i];
+   }
+   b[size - 1] = b[size - 1];
+}
+
+int osal_mem_lock(void *p, size_t size)
+{
+   if ((p == NULL) || (size == 0))
+   {
+      return 1;
+   }
+   osal_mem_touch(p, size);
+   return (mlock(p, size) == 0) ? 1 : 0;
+}
+
+void *osal_mem_alloc_locked(size_t size, boolean hugepages)
+{
+   void *p;
+   size_t align;
+
+   align = hugepages ? OSAL_HUGEPAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+   size = ((size + align - 1) / align) * align;
+   if (posix_memalign(&p, align, size) != 0)
+   {
+      return NULL;
+   }
+   (void)hugepages;
+   memset(p, 0, size);
+   if (!osal_mem_lock(p, size))
+   {
+      free(p);
+      return NULL;
+   }
+   return p;
+}
+
+void osal_mem_free_locked(void *p, size_t size)
+{
+   if (p == NULL)
+   {
+      return;
+   }
+   munlock(p, size);
+   free(p);
+}
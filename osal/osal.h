@@ -13,6 +13,7 @@ extern "C"
 
 #include "osal_defs.h"
 #include <stdint.h>
+#include <stddef.h>
 
 /* General types */
 #ifndef TRUE
@@ -44,14 +45,90 @@ typedef struct osal_timer
     ec_timet stop_time;
 } osal_timert;
 
+/** deadline timer on the monotonic clock, see osal_deadline_start() */
+typedef struct osal_deadline
+{
+    uint64 expire_ns;   /*< Monotonic time of expiry in ns */
+} osal_deadlinet;
+
+/** scheduling policies of osal_thread_attrt */
+#define OSAL_SCHED_FIFO     0
+#define OSAL_SCHED_RR       1
+#define OSAL_SCHED_DEADLINE 2
+
+/** real-time thread attributes, see osal_thread_attr_init() */
+typedef struct osal_thread_attr
+{
+    int    policy;      /*< OSAL_SCHED_FIFO, OSAL_SCHED_RR or OSAL_SCHED_DEADLINE */
+    int    priority;    /*< Priority for FIFO and RR */
+    uint64 runtime_ns;  /*< Runtime per period for DEADLINE */
+    uint64 deadline_ns; /*< Relative deadline for DEADLINE, 0 = period */
+    uint64 period_ns;   /*< Period for DEADLINE */
+    uint64 cpuset;      /*< Bit n allows CPU n, 0 = all CPUs, must be 0 for DEADLINE */
+    boolean lockmemory; /*< Lock current and future memory of the process */
+    int    stacksize;   /*< Stack size in bytes */
+    int    prefault;    /*< Bytes of stack touched before func runs, 0 = none */
+} osal_thread_attrt;
+
+/** alignment of memory from osal_mem_alloc_locked() with hugepages */
+#ifndef OSAL_HUGEPAGE_SIZE
+#define OSAL_HUGEPAGE_SIZE  (2 * 1024 * 1024)
+#endif
+
+/** TAI - UTC in seconds, used by ports without a TAI clock */
+#ifndef OSAL_TAI_UTC_OFFSET
+#define OSAL_TAI_UTC_OFFSET 37
+#endif
+
 void osal_timer_start(osal_timert * self, uint32 timeout_us);
 void osal_timer_add_time(osal_timert * self, uint32_t timeout_us);
 boolean osal_timer_is_expired(osal_timert * self);
 int osal_usleep(uint32 usec);
 ec_timet osal_current_time(void);
+uint64 osal_monotonic_ns(void);
+uint64 osal_realtime_ns(void);
+uint64 osal_tai_ns(void);
+int osal_sleep_until_ns(uint64 wakeup_ns);
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff);
 int osal_thread_create(void *thandle, int stacksize, void *func, void *param);
 int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param);
+void osal_thread_attr_init(osal_thread_attrt *attr, int stacksize);
+int osal_thread_create_rt_attr(void *thandle, const osal_thread_attrt *attr, void *func, void *param);
+int osal_thread_join(void *thandle);
+void *osal_mutex_create(void);
+void osal_mutex_destroy(void *mutex);
+void osal_mutex_lock(void *mutex);
+void osal_mutex_unlock(void *mutex);
+int osal_mem_lock(void *p, size_t size);
+void *osal_mem_alloc_locked(size_t size, boolean hugepages);
+void osal_mem_free_locked(void *p, size_t size);
+
+/* Deadline timers in integer ns, an expiry check is one clock read and a
+ * compare. A port can provide its own by defining them in osal_defs.h. */
+#ifndef osal_deadline_start
+#define osal_deadline_start(self, timeout_us) \
+   ((self)->expire_ns = osal_monotonic_ns() + (uint64)(timeout_us) * 1000ULL)
+#define osal_deadline_is_expired(self)  (osal_monotonic_ns() >= (self)->expire_ns)
+#endif
+
+/* Atomic operations on uint32, used by lock-free queues. Load has acquire and
+ * store has release semantics, compare-and-swap and add are full barriers.
+ * A port can provide its own by defining them in osal_defs.h. */
+#ifndef osal_atomic_load
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define osal_atomic_load(p)        ((uint32)_InterlockedOr((volatile long *)(p), 0))
+#define osal_atomic_store(p, v)    ((void)_InterlockedExchange((volatile long *)(p), (long)(v)))
+#define osal_atomic_cas(p, o, n)   ((uint32)_InterlockedCompareExchange((volatile long *)(p), \
+                                      (long)(n), (long)(o)) == (uint32)(o))
+#define osal_atomic_add(p, v)      ((void)_InterlockedExchangeAdd((volatile long *)(p), (long)(v)))
+#else
+#define osal_atomic_load(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define osal_atomic_store(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define osal_atomic_cas(p, o, n)   __sync_bool_compare_and_swap((p), (o), (n))
+#define osal_atomic_add(p, v)      ((void)__sync_fetch_and_add((p), (v)))
+#endif
+#endif
 
 #ifdef __cplusplus
 }
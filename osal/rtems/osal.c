@@ -4,6 +4,7 @@
  */
 
 #include <time.h>
+#include <errno.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <stdlib.h>
@@ -48,6 +49,50 @@ ec_timet osal_current_time(void)
    return return_value;
 }
 
+uint64 osal_monotonic_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+}
+
+uint64 osal_realtime_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_REALTIME, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+}
+
+uint64 osal_tai_ns(void)
+{
+#ifdef CLOCK_TAI
+   struct timespec ts;
+
+   /* kernel TAI offset is set by the time daemon, e.g. ptp4l or chrony */
+   clock_gettime(CLOCK_TAI, &ts);
+   return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+#else
+   return osal_realtime_ns() + (uint64)OSAL_TAI_UTC_OFFSET * 1000000000ULL;
+#endif
+}
+
+int osal_sleep_until_ns(uint64 wakeup_ns)
+{
+   struct timespec ts;
+   int return_value;
+
+   ts.tv_sec = wakeup_ns / 1000000000ULL;
+   ts.tv_nsec = wakeup_ns % 1000000000ULL;
+   /* absolute wakeup does not accumulate the time spent before the call */
+   do
+   {
+      return_value = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+   } while (return_value == EINTR);
+   return return_value;
+}
+
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff)
 {
    if (end->usec < start->usec) {
@@ -142,3 +187,100 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
 
    return 1;
 }
+
+void osal_thread_attr_init(osal_thread_attrt *attr, int stacksize)
+{
+   attr->policy = OSAL_SCHED_FIFO;
+   attr->priority = 40;
+   attr->runtime_ns = 0;
+   attr->deadline_ns = 0;
+   attr->period_ns = 0;
+   attr->cpuset = 0;
+   attr->lockmemory = FALSE;
+   attr->stacksize = stacksize;
+   attr->prefault = 0;
+}
+
+/* this port only supports the stack size, FIFO, RR and priority map to the
+ * fixed priority of osal_thread_create_rt(). lockmemory and prefault are
+ * met as memory is always resident. DEADLINE and cpuset are not supported
+ * and fail. */
+int osal_thread_create_rt_attr(void *thandle, const osal_thread_attrt *attr, void *func, void *param)
+{
+   if ((attr->policy == OSAL_SCHED_DEADLINE) || attr->cpuset)
+   {
+      return 0;
+   }
+   return osal_thread_create_rt(thandle, attr->stacksize, func, param);
+}
+
+int osal_thread_join(void *thandle)
+{
+   pthread_t            *threadp;
+
+   threadp = thandle;
+   if (pthread_join(*threadp, NULL) != 0)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+void *osal_mutex_create(void)
+{
+   pthread_mutex_t      *mutex;
+
+   mutex = malloc(sizeof(*mutex));
+   if (mutex && pthread_mutex_init(mutex, NULL))
+   {
+      free(mutex);
+      mutex = NULL;
+   }
+   return mutex;
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   if (mutex)
+   {
+      pthread_mutex_destroy(mutex);
+      free(mutex);
+   }
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   pthread_mutex_lock(mutex);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   pthread_mutex_unlock(mutex);
+}
+
+/* no paging on this target, memory is always resident */
+int osal_mem_lock(void *p, size_t size)
+{
+   (void)p;
+   (void)size;
+   return 1;
+}
+
+void *osal_mem_alloc_locked(size_t size, boolean hugepages)
+{
+   void *p;
+
+   (void)hugepages;
+   p = malloc(size);
+   if (p != NULL)
+   {
+      memset(p, 0, size);
+   }
+   return p;
+}
+
+void osal_mem_free_locked(void *p, size_t size)
+{
+   (void)size;
+   free(p);
+}
@@ -25,4 +25,7 @@
 #define OSAL_THREAD_FUNC void
 #define OSAL_THREAD_FUNC_RT void
 
+/* no osal_thread_join and osal_mutex support, slave mapping runs serially */
+#define EC_MAX_MAPT 1
+
 #endif
@@ -67,6 +67,44 @@ ec_timet osal_current_time (void)
    return return_value;
 }
 
+uint64 osal_monotonic_ns (void)
+{
+   int64_t wintime;
+
+   if(!sysfrequency)
+   {
+      timeBeginPeriod(1);
+      QueryPerformanceFrequency((LARGE_INTEGER *)&sysfrequency);
+      qpc2usec = 1000000.0 / sysfrequency;
+   }
+   QueryPerformanceCounter((LARGE_INTEGER *)&wintime);
+   return (uint64)(wintime / sysfrequency) * 1000000000ULL +
+          (uint64)((wintime % sysfrequency) * 1000000000LL / sysfrequency);
+}
+
+uint64 osal_realtime_ns (void)
+{
+   ec_timet current = osal_current_time();
+
+   return (uint64)current.sec * 1000000000ULL + (uint64)current.usec * 1000ULL;
+}
+
+uint64 osal_tai_ns (void)
+{
+   return osal_realtime_ns() + (uint64)OSAL_TAI_UTC_OFFSET * 1000000000ULL;
+}
+
+int osal_sleep_until_ns (uint64 wakeup_ns)
+{
+   uint64 now = osal_monotonic_ns();
+
+   if (wakeup_ns > now)
+   {
+      return osal_usleep((uint32)((wakeup_ns - now) / 1000));
+   }
+   return 0;
+}
+
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff)
 {
    if (end->usec < start->usec) {
@@ -150,3 +188,114 @@ int osal_thread_create_rt(void **thandle, int stacksize, void *func, void *param
    }
    return ret;
 }
+
+void osal_thread_attr_init (osal_thread_attrt *attr, int stacksize)
+{
+   attr->policy = OSAL_SCHED_FIFO;
+   attr->priority = 40;
+   attr->runtime_ns = 0;
+   attr->deadline_ns = 0;
+   attr->period_ns = 0;
+   attr->cpuset = 0;
+   attr->lockmemory = FALSE;
+   attr->stacksize = stacksize;
+   attr->prefault = 0;
+}
+
+/* this port only supports the stack size, FIFO, RR and priority map to the
+ * fixed priority of osal_thread_create_rt(). DEADLINE, cpuset, lockmemory
+ * and prefault are not supported and fail. */
+int osal_thread_create_rt_attr (void *thandle, const osal_thread_attrt *attr, void *func, void *param)
+{
+   if ((attr->policy == OSAL_SCHED_DEADLINE) || attr->cpuset || attr->lockmemory ||
+       (attr->prefault > 0))
+   {
+      return 0;
+   }
+   return osal_thread_create_rt(thandle, attr->stacksize, func, param);
+}
+
+int osal_thread_join(void *thandle)
+{
+   HANDLE *threadp;
+
+   threadp = thandle;
+   if (WaitForSingleObject(*threadp, INFINITE) != WAIT_OBJECT_0)
+   {
+      return 0;
+   }
+   CloseHandle(*threadp);
+   return 1;
+}
+
+void *osal_mutex_create(void)
+{
+   CRITICAL_SECTION *mutex;
+
+   mutex = malloc(sizeof(*mutex));
+   if (mutex)
+   {
+      InitializeCriticalSection(mutex);
+   }
+   return mutex;
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   if (mutex)
+   {
+      DeleteCriticalSection(mutex);
+      free(mutex);
+   }
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   EnterCriticalSection(mutex);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   LeaveCriticalSection(mutex);
+}
+
+int osal_mem_lock (void *p, size_t size)
+{
+   volatile uint8 *b = p;
+   size_t i;
+
+   if ((p == NULL) || (size == 0))
+   {
+      return 1;
+   }
+   for (i = 0; i < size; i += 4096)
+   {
+      b[i] = b[i];
+   }
+   /* may need a larger working set, see SetProcessWorkingSetSize */
+   return VirtualLock(p, size) ? 1 : 0;
+}
+
+void *osal_mem_alloc_locked (size_t size, boolean hugepages)
+{
+   void *p;
+
+   (void)hugepages;
+   p = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+   if ((p != NULL) && !osal_mem_lock(p, size))
+   {
+      VirtualFree(p, 0, MEM_RELEASE);
+      return NULL;
+   }
+   return p;
+}
+
+void osal_mem_free_locked (void *p, size_t size)
+{
+   if (p == NULL)
+   {
+      return;
+   }
+   VirtualUnlock(p, size);
+   VirtualFree(p, 0, MEM_RELEASE);
+}
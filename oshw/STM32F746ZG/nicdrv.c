@@ -499,9 +499,9 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber)
  * @return Workcounter if a frame is found with corresponding index, otherwise
  * EC_NOFRAME.
  */
-static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
+static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_deadlinet *timer)
 {
-	osal_timert timer2;
+	osal_deadlinet timer2;
 	int wkc = EC_NOFRAME;
 	int wkc2 = EC_NOFRAME;
 	int primrx, secrx;
@@ -518,7 +518,7 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
 				wkc2 = ecx_inframe(port, idx, 1);
 		}
 	} while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME))
-			&& !osal_timer_is_expired(timer));
+			&& !osal_deadline_is_expired(timer));
 
 	if (port->redstate != ECT_RED_NONE)
 	{
@@ -540,12 +540,12 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
 		{
 			if ((primrx == RX_PRIM) && (secrx == RX_SEC))
 			memcpy(&(port->txbuf[idx][ETH_HEADERSIZE]), &(port->rxbuf[idx]), port->txbuflength[idx] - ETH_HEADERSIZE);
-			osal_timer_start(&timer2, EC_TIMEOUTRET);
+			osal_deadline_start(&timer2, EC_TIMEOUTRET);
 			ecx_outframe(port, idx, 1);
 			do
 			{
 				wkc2 = ecx_inframe(port, idx, 1);
-			}while ((wkc2 <= EC_NOFRAME) && !osal_timer_is_expired(&timer2));
+			}while ((wkc2 <= EC_NOFRAME) && !osal_deadline_is_expired(&timer2));
 			if (wkc2 > EC_NOFRAME)
 			{
 				memcpy(&(port->rxbuf[idx]), &(port->redport->rxbuf[idx]), port->txbuflength[idx] - ETH_HEADERSIZE);
@@ -566,9 +566,9 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
 int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 {
 	int wkc;
-	osal_timert timer;
+	osal_deadlinet timer;
 
-	osal_timer_start(&timer, timeout);
+	osal_deadline_start(&timer, timeout);
 	wkc = ecx_waitinframe_red(port, idx, &timer);
 
 	return wkc;
@@ -589,26 +589,26 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 {
 	int wkc = EC_NOFRAME;
-	osal_timert timer1, timer2;
+	osal_deadlinet timer1, timer2;
 
-	osal_timer_start(&timer1, timeout);
+	osal_deadline_start(&timer1, timeout);
 	do
 	{
 		/* tx frame on primary and if in redundant mode a dummy on secondary */
 		ecx_outframe_red(port, idx);
 		if (timeout < EC_TIMEOUTRET)
 		{
-			osal_timer_start(&timer2, timeout);
+			osal_deadline_start(&timer2, timeout);
 		}
 		else
 		{
 			/* normally use partial timeout for rx */
-			osal_timer_start(&timer2, EC_TIMEOUTRET);
+			osal_deadline_start(&timer2, EC_TIMEOUTRET);
 		}
 		/* get frame from primary or if in redundant mode possibly from secondary */
 		wkc = ecx_waitinframe_red(port, idx, &timer2);
 		/* wait for answer with WKC>=0 or otherwise retry until timeout */
-	} while ((wkc <= EC_NOFRAME) && !osal_timer_is_expired(&timer1));
+	} while ((wkc <= EC_NOFRAME) && !osal_deadline_is_expired(&timer1));
 
 	return wkc;
 }
@@ -560,9 +560,9 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber)
  * @return Workcounter if a frame is found with corresponding index, otherwise
  * EC_NOFRAME.
  */
-static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
+static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_deadlinet *timer)
 {
-   osal_timert timer2;
+   osal_deadlinet timer2;
    int wkc  = EC_NOFRAME;
    int wkc2 = EC_NOFRAME;
    int primrx, secrx;
@@ -587,7 +587,7 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
          }
       }
    /* wait for both frames to arrive or timeout */
-   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && !osal_timer_is_expired(timer));
+   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && !osal_deadline_is_expired(timer));
    /* only do redundant functions when in redundant mode */
    if (port->redstate != ECT_RED_NONE)
    {
@@ -619,14 +619,14 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
             /* copy primary rx to tx buffer */
             memcpy(&(port->txbuf[idx][ETH_HEADERSIZE]), &(port->rxbuf[idx]), port->txbuflength[idx] - ETH_HEADERSIZE);
          }
-         osal_timer_start (&timer2, EC_TIMEOUTRET);
+         osal_deadline_start (&timer2, EC_TIMEOUTRET);
          /* resend secondary tx */
          ecx_outframe(port,idx,1);
          do
          {
             /* retrieve frame */
             wkc2 = ecx_inframe(port, idx, 1);
-         } while ((wkc2 <= EC_NOFRAME) && !osal_timer_is_expired(&timer2));
+         } while ((wkc2 <= EC_NOFRAME) && !osal_deadline_is_expired(&timer2));
          if (wkc2 > EC_NOFRAME)
          {
             /* copy secondary result to primary rx buffer */
@@ -649,7 +649,7 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
 int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc;
-   osal_timert timer;
+   osal_deadlinet timer;
 
    if (timeout == 0 && (port->redstate == ECT_RED_NONE))
    {
@@ -663,7 +663,7 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
    }
    else
    {
-      osal_timer_start (&timer, timeout);
+      osal_deadline_start (&timer, timeout);
       wkc = ecx_waitinframe_red(port, idx, &timer);
    }
 
@@ -684,9 +684,9 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc = EC_NOFRAME;
-   osal_timert timer1;
+   osal_deadlinet timer1;
 
-   osal_timer_start (&timer1, timeout);
+   osal_deadline_start (&timer1, timeout);
    /* tx frame on primary and if in redundant mode a dummy on secondary */
    ecx_outframe_red(port, idx);
    wkc = ecx_waitinframe_red(port, idx, &timer1);
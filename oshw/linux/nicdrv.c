@@ -132,6 +132,12 @@ int ecx_setupnic(ecx_portt *port, const char *ifname, int secondary)
       port->sockhandle        = -1;
       port->lastidx           = 0;
       port->redstate          = ECT_RED_NONE;
+      memset(port->txtime, 0, sizeof(port->txtime));
+      memset(port->txtag, 0, sizeof(port->txtag));
+      memset(port->rtt, 0, sizeof(port->rtt));
+      port->rttadapt          = FALSE;
+      port->rttfactor         = 4;
+      port->rttmin            = EC_RTTFLOOR;
       port->stack.sock        = &(port->sockhandle);
       port->stack.txbuf       = &(port->txbuf);
       port->stack.txbuflength = &(port->txbuflength);
@@ -271,6 +277,7 @@ int ecx_outframe(ecx_portt *port, uint8 idx, int stacknumber)
 {
    int lp, rval;
    ec_stackT *stack;
+   ec_etherheadert *ehp;
 
    if (!stacknumber)
    {
@@ -281,7 +288,21 @@ int ecx_outframe(ecx_portt *port, uint8 idx, int stacknumber)
       stack = &(port->redport->stack);
    }
    lp = (*stack->txbuflength)[idx];
+   ehp = (ec_etherheadert *)&((*stack->txbuf)[idx]);
+   if (port->rttadapt)
+   {
+      /* new attempt tag, replies to earlier transmissions of this index are dropped */
+      ehp->sa2 = htons(++port->txtag[idx]);
+   }
+   else
+   {
+      ehp->sa2 = htons(priMAC[2]);
+   }
    (*stack->rxbufstat)[idx] = EC_BUF_TX;
+   if (!stacknumber)
+   {
+      port->txtime[idx] = osal_monotonic_ns();
+   }
    rval = send(*stack->sock, (*stack->txbuf)[idx], lp, 0);
    if (rval == -1)
    {
@@ -313,8 +334,9 @@ int ecx_outframe_red(ecx_portt *port, uint8 idx)
       ehp = (ec_etherheadert *)&(port->txbuf2);
       /* use dummy frame for secondary socket transmit (BRD) */
       datagramP = (ec_comt*)&(port->txbuf2[ETH_HEADERSIZE]);
-      /* write index to frame */
+      /* write index and attempt tag to frame */
       datagramP->index = idx;
+      ehp->sa2 = port->rttadapt ? htons(port->txtag[idx]) : htons(priMAC[2]);
       /* rewrite MAC source address 1 to secondary */
       ehp->sa1 = htons(secMAC[1]);
       /* transmit over secondary socket */
@@ -354,6 +376,140 @@ static int ecx_recvpkt(ecx_portt *port, int stacknumber)
    return (bytesrx > 0);
 }
 
+/* datagram class of a frame, from the command of its first datagram */
+static int ecx_rttclass(ecx_portt *port, uint8 idx)
+{
+   switch (port->txbuf[idx][ETH_HEADERSIZE + EC_CMDOFFSET])
+   {
+      case EC_CMD_BRD:
+      case EC_CMD_BWR:
+      case EC_CMD_BRW:
+         return EC_RTT_BROADCAST;
+      case EC_CMD_LRD:
+      case EC_CMD_LWR:
+      case EC_CMD_LRW:
+         return EC_RTT_LOGICAL;
+      default:
+         return EC_RTT_ADDRESSED;
+   }
+}
+
+/* histogram bin of a round trip time in us, four bins per power of two */
+static int ecx_rttbin(uint32 us)
+{
+   int e, bin;
+
+   if (us < 4)
+   {
+      return (int)us;
+   }
+   e = 2;
+   while ((us >> (e + 1)) && (e < 31))
+   {
+      e++;
+   }
+   bin = (4 * e) + (int)((us >> (e - 2)) & 3);
+   return (bin < EC_RTTBINS) ? bin : (EC_RTTBINS - 1);
+}
+
+/* largest round trip time in us counted in a bin */
+static int ecx_rttbinmax(int bin)
+{
+   int e;
+
+   if (bin < 4)
+   {
+      return bin;
+   }
+   e = bin / 4;
+   return (((4 + (bin % 4) + 1) << (e - 2)) - 1);
+}
+
+/* percentile of a class in permille, in us, -1 if no samples */
+static int ecx_rttpermille(ec_rttstatt *rtt, int permille)
+{
+   uint32 need, sum;
+   int bin;
+
+   if (rtt->count == 0)
+   {
+      return -1;
+   }
+   need = rtt->count - (uint32)(((uint64)rtt->count * (uint64)(1000 - permille)) / 1000);
+   sum = 0;
+   for (bin = 0; bin < EC_RTTBINS; bin++)
+   {
+      sum += rtt->hist[bin];
+      if (sum >= need)
+      {
+         break;
+      }
+   }
+   return ecx_rttbinmax((bin < EC_RTTBINS) ? bin : (EC_RTTBINS - 1));
+}
+
+/* add round trip time of a received frame, called with rx_mutex locked */
+static void ecx_rttsample(ecx_portt *port, uint8 idx)
+{
+   ec_rttstatt *rtt;
+   uint64 rttns;
+   int bin, timeout;
+
+   if (port->txtime[idx] == 0)
+   {
+      return;
+   }
+   rttns = osal_monotonic_ns() - port->txtime[idx];
+   port->txtime[idx] = 0;
+   rtt = &(port->rtt[ecx_rttclass(port, idx)]);
+   if (rtt->count >= EC_RTTMAXSAMPLES)
+   {
+      rtt->count = 0;
+      for (bin = 0; bin < EC_RTTBINS; bin++)
+      {
+         rtt->hist[bin] /= 2;
+         rtt->count += rtt->hist[bin];
+      }
+   }
+   rtt->hist[ecx_rttbin((uint32)(rttns / 1000))]++;
+   rtt->count++;
+   /* derive timeout from the 99.9 percentile now and then */
+   if ((rtt->count >= EC_RTTMINSAMPLES) && ((rtt->count & 63) == 0))
+   {
+      timeout = ecx_rttpermille(rtt, 999) * port->rttfactor;
+      if (timeout < port->rttmin)
+      {
+         timeout = port->rttmin;
+      }
+      if (timeout > EC_TIMEOUTRET)
+      {
+         timeout = EC_TIMEOUTRET;
+      }
+      rtt->timeout = timeout;
+   }
+}
+
+/* limit a receive timeout to the override or learned timeout of the frame */
+static int ecx_rttlimit(ecx_portt *port, uint8 idx, int timeout)
+{
+   ec_rttstatt *rtt = &(port->rtt[ecx_rttclass(port, idx)]);
+   int limit;
+
+   if (rtt->override > 0)
+   {
+      limit = rtt->override;
+   }
+   else if (port->rttadapt && (rtt->timeout > 0))
+   {
+      limit = rtt->timeout;
+   }
+   else
+   {
+      return timeout;
+   }
+   return (limit < timeout) ? limit : timeout;
+}
+
 /** Non blocking receive frame function. Uses RX buffer and index to combine
  * read frame with transmitted frame. To compensate for received frames that
  * are out-of-order all frames are stored in their respective indexed buffer.
@@ -413,8 +569,13 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber)
             ecp =(ec_comt*)(&(*stack->tempbuf)[ETH_HEADERSIZE]);
             l = etohs(ecp->elength) & 0x0fff;
             idxf = ecp->index;
+            /* late reply to an earlier transmission of this index ? */
+            if (port->rttadapt && (idxf < EC_MAXBUF) && (ntohs(ehp->sa2) != port->txtag[idxf]))
+            {
+               /* drop it */
+            }
             /* found index equals requested index ? */
-            if (idxf == idx)
+            else if (idxf == idx)
             {
                /* yes, put it in the buffer array (strip ethernet header) */
                memcpy(rxbuf, &(*stack->tempbuf)[ETH_HEADERSIZE], (*stack->txbuflength)[idx] - ETH_HEADERSIZE);
@@ -424,6 +585,10 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber)
                (*stack->rxbufstat)[idx] = EC_BUF_COMPLETE;
                /* store MAC source word 1 for redundant routing info */
                (*stack->rxsa)[idx] = ntohs(ehp->sa1);
+               if (!stacknumber)
+               {
+                  ecx_rttsample(port, idx);
+               }
             }
             else
             {
@@ -436,6 +601,10 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber)
                   /* mark as received */
                   (*stack->rxbufstat)[idxf] = EC_BUF_RCVD;
                   (*stack->rxsa)[idxf] = ntohs(ehp->sa1);
+                  if (!stacknumber)
+                  {
+                     ecx_rttsample(port, idxf);
+                  }
                }
                else
                {
@@ -464,9 +633,9 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber)
  * @return Workcounter if a frame is found with corresponding index, otherwise
  * EC_NOFRAME.
  */
-static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
+static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_deadlinet *timer)
 {
-   osal_timert timer2;
+   osal_deadlinet timer2;
    int wkc  = EC_NOFRAME;
    int wkc2 = EC_NOFRAME;
    int primrx, secrx;
@@ -487,7 +656,7 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
             wkc2 = ecx_inframe(port, idx, 1);
       }
    /* wait for both frames to arrive or timeout */
-   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && !osal_timer_is_expired(timer));
+   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && !osal_deadline_is_expired(timer));
    /* only do redundant functions when in redundant mode */
    if (port->redstate != ECT_RED_NONE)
    {
@@ -519,14 +688,14 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
             /* copy primary rx to tx buffer */
             memcpy(&(port->txbuf[idx][ETH_HEADERSIZE]), &(port->rxbuf[idx]), port->txbuflength[idx] - ETH_HEADERSIZE);
          }
-         osal_timer_start (&timer2, EC_TIMEOUTRET);
+         osal_deadline_start (&timer2, ecx_rttlimit(port, idx, EC_TIMEOUTRET));
          /* resend secondary tx */
          ecx_outframe(port, idx, 1);
          do
          {
             /* retrieve frame */
             wkc2 = ecx_inframe(port, idx, 1);
-         } while ((wkc2 <= EC_NOFRAME) && !osal_timer_is_expired(&timer2));
+         } while ((wkc2 <= EC_NOFRAME) && !osal_deadline_is_expired(&timer2));
          if (wkc2 > EC_NOFRAME)
          {
             /* copy secondary result to primary rx buffer */
@@ -550,9 +719,9 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer)
 int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc;
-   osal_timert timer;
+   osal_deadlinet timer;
 
-   osal_timer_start (&timer, timeout);
+   osal_deadline_start (&timer, ecx_rttlimit(port, idx, timeout));
    wkc = ecx_waitinframe_red(port, idx, &timer);
 
    return wkc;
@@ -573,30 +742,112 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc = EC_NOFRAME;
-   osal_timert timer1, timer2;
+   int partial;
+   osal_deadlinet timer1, timer2;
 
-   osal_timer_start (&timer1, timeout);
+   /* partial timeout for rx, learned from round trip times if enabled */
+   partial = ecx_rttlimit(port, idx, EC_TIMEOUTRET);
+   osal_deadline_start (&timer1, timeout);
    do
    {
       /* tx frame on primary and if in redundant mode a dummy on secondary */
       ecx_outframe_red(port, idx);
-      if (timeout < EC_TIMEOUTRET)
+      if (timeout < partial)
       {
-         osal_timer_start (&timer2, timeout);
+         osal_deadline_start (&timer2, timeout);
       }
       else
       {
          /* normally use partial timeout for rx */
-         osal_timer_start (&timer2, EC_TIMEOUTRET);
+         osal_deadline_start (&timer2, partial);
       }
       /* get frame from primary or if in redundant mode possibly from secondary */
       wkc = ecx_waitinframe_red(port, idx, &timer2);
    /* wait for answer with WKC>=0 or otherwise retry until timeout */
-   } while ((wkc <= EC_NOFRAME) && !osal_timer_is_expired (&timer1));
+   } while ((wkc <= EC_NOFRAME) && !osal_deadline_is_expired (&timer1));
 
    return wkc;
 }
 
+/** Enable timeouts learned from round trip times. The receive timeout of
+ * a frame and the retry interval of ecx_srconfirm() become factor times
+ * the 99.9 percentile of its datagram class, limited to mintimeout and
+ * EC_TIMEOUTRET. While enabled, frames carry a tag per transmission in MAC
+ * source word 2, so a late reply to an abandoned attempt is dropped instead
+ * of being taken for the retry. Until EC_RTTMINSAMPLES frames of a class
+ * were seen the fixed timeouts are used.
+ * @param[in] port        = port context struct
+ * @param[in] enable      = TRUE to use learned timeouts
+ * @param[in] factor      = multiplier of the 99.9 percentile
+ * @param[in] mintimeout  = lower limit in us, raised to EC_RTTFLOOR
+ */
+void ecx_rttadapt(ecx_portt *port, boolean enable, int factor, int mintimeout)
+{
+   port->rttfactor = (factor > 0) ? factor : 1;
+   port->rttmin = (mintimeout > EC_RTTFLOOR) ? mintimeout : EC_RTTFLOOR;
+   port->rttadapt = enable;
+}
+
+/** Set a fixed timeout for a datagram class, used instead of the learned
+ * one and also when learning is disabled.
+ * @param[in] port        = port context struct
+ * @param[in] rttclass    = EC_RTT_ADDRESSED, EC_RTT_BROADCAST or EC_RTT_LOGICAL
+ * @param[in] timeout     = timeout in us, 0 = no override
+ */
+void ecx_rttoverride(ecx_portt *port, int rttclass, int timeout)
+{
+   if ((rttclass >= 0) && (rttclass < EC_RTT_CLASSES))
+   {
+      port->rtt[rttclass].override = timeout;
+   }
+}
+
+/** Percentile of the measured round trip times of a datagram class.
+ * @param[in] port        = port context struct
+ * @param[in] rttclass    = EC_RTT_ADDRESSED, EC_RTT_BROADCAST or EC_RTT_LOGICAL
+ * @param[in] permille    = percentile in permille 0..1000, f.e. 999
+ * @return upper bound of round trip time in us, -1 if no samples or
+ * invalid parameters
+ */
+int ecx_rttpercentile(ecx_portt *port, int rttclass, int permille)
+{
+   int rval;
+
+   if ((rttclass < 0) || (rttclass >= EC_RTT_CLASSES) || (permille < 0) || (permille > 1000))
+   {
+      return -1;
+   }
+   pthread_mutex_lock(&(port->rx_mutex));
+   rval = ecx_rttpermille(&(port->rtt[rttclass]), permille);
+   pthread_mutex_unlock(&(port->rx_mutex));
+   return rval;
+}
+
+/** Partial timeout currently used for a datagram class.
+ * @param[in] port        = port context struct
+ * @param[in] rttclass    = EC_RTT_ADDRESSED, EC_RTT_BROADCAST or EC_RTT_LOGICAL
+ * @return timeout in us
+ */
+int ecx_rtttimeout(ecx_portt *port, int rttclass)
+{
+   ec_rttstatt *rtt;
+
+   if ((rttclass < 0) || (rttclass >= EC_RTT_CLASSES))
+   {
+      return EC_TIMEOUTRET;
+   }
+   rtt = &(port->rtt[rttclass]);
+   if (rtt->override > 0)
+   {
+      return rtt->override;
+   }
+   if (port->rttadapt && (rtt->timeout > 0))
+   {
+      return rtt->timeout;
+   }
+   return EC_TIMEOUTRET;
+}
+
 #ifdef EC_VER1
 int ec_setupnic(const char *ifname, int secondary)
 {
@@ -642,4 +893,14 @@ int ec_srconfirm(uint8 idx, int timeout)
 {
    return ecx_srconfirm(&ecx_port, idx, timeout);
 }
+
+void ec_rttadapt(boolean enable, int factor, int mintimeout)
+{
+   ecx_rttadapt(&ecx_port, enable, factor, mintimeout);
+}
+
+void ec_rttoverride(int rttclass, int timeout)
+{
+   ecx_rttoverride(&ecx_port, rttclass, timeout);
+}
 #endif
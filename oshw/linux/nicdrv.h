@@ -37,6 +37,33 @@ typedef struct
    int         (*rxsa)[EC_MAXBUF];
 } ec_stackT;
 
+/** datagram classes of the round trip time statistics, by first datagram */
+#define EC_RTT_ADDRESSED  0
+#define EC_RTT_BROADCAST  1
+#define EC_RTT_LOGICAL    2
+#define EC_RTT_CLASSES    3
+/** number of histogram bins, four per power of two microseconds */
+#define EC_RTTBINS        96
+/** samples needed before a timeout is derived */
+#define EC_RTTMINSAMPLES  256
+/** samples after which the histogram is halved, so it follows changes */
+#define EC_RTTMAXSAMPLES  65536
+/** lowest derived timeout in us, also the default lower limit */
+#define EC_RTTFLOOR       (EC_TIMEOUTRET / 10)
+
+/** round trip time statistics of one datagram class */
+typedef struct
+{
+   /** number of samples in histogram */
+   uint32 count;
+   /** histogram of round trip times */
+   uint32 hist[EC_RTTBINS];
+   /** derived timeout in us, 0 = not enough samples */
+   int    timeout;
+   /** fixed timeout in us, 0 = use derived timeout */
+   int    override;
+} ec_rttstatt;
+
 /** pointer structure to buffers for redundant port */
 typedef struct
 {
@@ -81,6 +108,19 @@ typedef struct
    int redstate;
    /** pointer to redundancy port and buffers */
    ecx_redportt *redport;
+   /** transmit time of frame in ns, 0 = not measured */
+   uint64 txtime[EC_MAXBUF];
+   /** attempt tag of frame, sent as MAC source word 2 and checked on receive
+    * while rttadapt is set */
+   uint16 txtag[EC_MAXBUF];
+   /** round trip time statistics per datagram class */
+   ec_rttstatt rtt[EC_RTT_CLASSES];
+   /** TRUE = retry and receive timeouts follow the measured round trip times */
+   boolean rttadapt;
+   /** derived timeout is rttfactor times the 99.9 percentile */
+   int rttfactor;
+   /** lower limit of derived timeouts in us, at least EC_RTTFLOOR */
+   int rttmin;
    pthread_mutex_t getindex_mutex;
    pthread_mutex_t tx_mutex;
    pthread_mutex_t rx_mutex;
@@ -101,6 +141,8 @@ int ec_outframe(uint8 idx, int sock);
 int ec_outframe_red(uint8 idx);
 int ec_waitinframe(uint8 idx, int timeout);
 int ec_srconfirm(uint8 idx,int timeout);
+void ec_rttadapt(boolean enable, int factor, int mintimeout);
+void ec_rttoverride(int rttclass, int timeout);
 #endif
 
 void ec_setupheader(void *p);
@@ -112,6 +154,10 @@ int ecx_outframe(ecx_portt *port, uint8 idx, int sock);
 int ecx_outframe_red(ecx_portt *port, uint8 idx);
 int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout);
 int ecx_srconfirm(ecx_portt *port, uint8 idx,int timeout);
+void ecx_rttadapt(ecx_portt *port, boolean enable, int factor, int mintimeout);
+void ecx_rttoverride(ecx_portt *port, int rttclass, int timeout);
+int ecx_rttpercentile(ecx_portt *port, int rttclass, int permille);
+int ecx_rtttimeout(ecx_portt *port, int rttclass);
 
 #ifdef __cplusplus
 }
@@ -441,7 +441,7 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber)
  * @return Workcounter if a frame is found with corresponding index, otherwise
  * EC_NOFRAME.
  */
-static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert timer)
+static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_deadlinet timer)
 {
    int wkc  = EC_NOFRAME;
    int wkc2 = EC_NOFRAME;
@@ -467,7 +467,7 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert timer)
             wkc2 = ecx_inframe(port, idx, 1);
       }
    /* wait for both frames to arrive or timeout */
-   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && (osal_timer_is_expired(&timer) == FALSE));
+   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && (osal_deadline_is_expired(&timer) == FALSE));
    /* only do redundant functions when in redundant mode */
    if (port->redstate != ECT_RED_NONE)
    {
@@ -496,7 +496,7 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert timer)
       if ( ((primrx == 0) && (secrx == RX_SEC)) ||
            ((primrx == RX_PRIM) && (secrx == RX_SEC)) )
       {
-         osal_timert read_timer;
+         osal_deadlinet read_timer;
 
          /* If both primary and secondary have partial connection retransmit the primary received
           * frame over the secondary socket. The result from the secondary received frame is a combined
@@ -506,14 +506,14 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert timer)
             /* copy primary rx to tx buffer */
             memcpy(&(port->txbuf[idx][ETH_HEADERSIZE]), &(port->rxbuf[idx]), port->txbuflength[idx] - ETH_HEADERSIZE);
          }
-         osal_timer_start(&read_timer, EC_TIMEOUTRET);
+         osal_deadline_start(&read_timer, EC_TIMEOUTRET);
          /* resend secondary tx */
          ecx_outframe(port, idx, 1);
          do
          {
             /* retrieve frame */
             wkc2 = ecx_inframe(port, idx, 1);
-         } while ((wkc2 <= EC_NOFRAME) && (osal_timer_is_expired(&read_timer) == FALSE));
+         } while ((wkc2 <= EC_NOFRAME) && (osal_deadline_is_expired(&read_timer) == FALSE));
          if (wkc2 > EC_NOFRAME)
          {
             /* copy secondary result to primary rx buffer */
@@ -537,9 +537,9 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert timer)
 int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc;
-   osal_timert timer;
+   osal_deadlinet timer;
 
-   osal_timer_start (&timer, timeout);
+   osal_deadline_start (&timer, timeout);
    wkc = ecx_waitinframe_red(port, idx, timer);
 
    return wkc;
@@ -560,20 +560,20 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc = EC_NOFRAME;
-   osal_timert timer;
+   osal_deadlinet timer;
 
-   osal_timer_start(&timer, timeout);
+   osal_deadline_start(&timer, timeout);
    do
    {
-      osal_timert read_timer;
+      osal_deadlinet read_timer;
 
       /* tx frame on primary and if in redundant mode a dummy on secondary */
       ecx_outframe_red(port, idx);
-      osal_timer_start(&read_timer, MIN(timeout, EC_TIMEOUTRET));
+      osal_deadline_start(&read_timer, MIN(timeout, EC_TIMEOUTRET));
       /* get frame from primary or if in redundant mode possibly from secondary */
       wkc = ecx_waitinframe_red(port, idx, read_timer);
    /* wait for answer with WKC>0 or otherwise retry until timeout */
-   } while ((wkc <= EC_NOFRAME) && (osal_timer_is_expired(&timer) == FALSE));
+   } while ((wkc <= EC_NOFRAME) && (osal_deadline_is_expired(&timer) == FALSE));
 
    return wkc;
 }
@@ -792,9 +792,9 @@ int ecx_inframe(ecx_portt *port, uint8 idx, int stacknumber, int timeout)
  * @return Workcounter if a frame is found with corresponding index, otherwise
  * EC_NOFRAME.
  */
-static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer, int timeout)
+static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_deadlinet *timer, int timeout)
 {
-   osal_timert timer2;
+   osal_deadlinet timer2;
    int wkc  = EC_NOFRAME;
    int wkc2 = EC_NOFRAME;
    int primrx, secrx;
@@ -821,7 +821,7 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer, i
          }
       }   
    /* wait for both frames to arrive or timeout */   
-   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && !osal_timer_is_expired(timer));
+   } while (((wkc <= EC_NOFRAME) || (wkc2 <= EC_NOFRAME)) && !osal_deadline_is_expired(timer));
    /* only do redundant functions when in redundant mode */
    if (port->redstate != ECT_RED_NONE)
    {
@@ -853,14 +853,14 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer, i
             /* copy primary rx to tx buffer */
             memcpy(&(port->txbuf[idx][ETH_HEADERSIZE]), &(port->rxbuf[idx]), port->txbuflength[idx] - ETH_HEADERSIZE);
          }
-         osal_timer_start (&timer2, EC_TIMEOUTRET);
+         osal_deadline_start (&timer2, EC_TIMEOUTRET);
          /* resend secondary tx */
          ecx_outframe(port, idx, 1);
          do 
          {
             /* retrieve frame */
             wkc2 = ecx_inframe(port, idx, 1, timeout);
-         } while ((wkc2 <= EC_NOFRAME) && !osal_timer_is_expired(&timer2));
+         } while ((wkc2 <= EC_NOFRAME) && !osal_deadline_is_expired(&timer2));
          if (wkc2 > EC_NOFRAME)
          {   
             /* copy secondary result to primary rx buffer */
@@ -884,9 +884,9 @@ static int ecx_waitinframe_red(ecx_portt *port, uint8 idx, osal_timert *timer, i
 int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc;
-   osal_timert timer;
+   osal_deadlinet timer;
    
-   osal_timer_start (&timer, timeout); 
+   osal_deadline_start (&timer, timeout); 
    wkc = ecx_waitinframe_red(port, idx, &timer, timeout);
    
    return wkc;
@@ -907,26 +907,26 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc = EC_NOFRAME;
-   osal_timert timer1, timer2;
+   osal_deadlinet timer1, timer2;
 
-   osal_timer_start (&timer1, timeout);
+   osal_deadline_start (&timer1, timeout);
    do 
    {
       /* tx frame on primary and if in redundant mode a dummy on secondary */
       ecx_outframe_red(port, idx);
       if (timeout < EC_TIMEOUTRET) 
       {
-         osal_timer_start (&timer2, timeout); 
+         osal_deadline_start (&timer2, timeout); 
       }
       else 
       {
          /* normally use partial timeout for rx */
-         osal_timer_start (&timer2, EC_TIMEOUTRET); 
+         osal_deadline_start (&timer2, EC_TIMEOUTRET); 
       }
       /* get frame from primary or if in redundant mode possibly from secondary */
       wkc = ecx_waitinframe_red(port, idx, &timer2, timeout);
    /* wait for answer with WKC>=0 or otherwise retry until timeout */   
-   } while ((wkc <= EC_NOFRAME) && !osal_timer_is_expired (&timer1));
+   } while ((wkc <= EC_NOFRAME) && !osal_deadline_is_expired (&timer1));
 
    
    return wkc;
@@ -145,6 +145,39 @@ uint16 ecx_adddatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, boole
    return prevlength + EC_HEADERSIZE - EC_ELENGTHSIZE - ETH_HEADERSIZE;
 }
 
+/** Prepare a frame that is already built for one more datagram.
+ * Sets the datagram follows flag on the last datagram in the frame, the next
+ * datagram can then be added with ecx_adddatagram() and more = FALSE. Used to
+ * add datagrams to a frame built by other functions, like the process data
+ * frames.
+ *
+ * @param[in] port        = port context struct
+ * @param[in] idx         = index of frame in TX buffers
+ */
+void ecx_appenddatagram(ecx_portt *port, uint8 idx)
+{
+   uint8 *frameP;
+   ec_comt *datagramP;
+   int pos;
+   uint16 dlength;
+
+   frameP = (uint8 *)&(port->txbuf[idx]);
+   pos = ETH_HEADERSIZE;
+   datagramP = (ec_comt *)&frameP[pos];
+   dlength = etohs(datagramP->dlength);
+   while (dlength & EC_DATAGRAMFOLLOWS)
+   {
+      pos += EC_HEADERSIZE - EC_ELENGTHSIZE + (dlength & 0x07ff) + EC_WKCSIZE;
+      if (pos >= port->txbuflength[idx])
+      {
+         return;
+      }
+      datagramP = (ec_comt *)&frameP[pos];
+      dlength = etohs(datagramP->dlength);
+   }
+   datagramP->dlength = htoes(dlength | EC_DATAGRAMFOLLOWS);
+}
+
 /** BRW "broadcast write" primitive. Blocking.
  *
  * @param[in] port        = port context struct
@@ -535,6 +568,96 @@ int ecx_LRWDC(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, uint16
    return wkc;
 }
 
+/** Multiple datagram transfer. Blocking.
+ *
+ * All datagrams in the list are packed in as few frames as possible. Each frame
+ * is sent and confirmed in turn. After completion each list entry holds its own
+ * workcounter and, for reading commands, the data returned by the slave. This
+ * replaces a series of single FPRD/FPWR/APWR transfers to many slaves by one
+ * frame roundtrip per EC_MAXMDATAGRAM datagrams.
+ *
+ * @param[in] port        = port context struct
+ * @param[in,out] dgram   = list of datagrams, wkc is returned per entry
+ * @param[in]  n          = number of datagrams in list
+ * @param[in]  timeout    = timeout in us per frame, standard is EC_TIMEOUTRET
+ * @return Sum of workcounters or EC_NOFRAME if one of the frames was lost
+ */
+int ecx_multidatagram(ecx_portt *port, ec_mdatagramt *dgram, int n, int timeout)
+{
+   uint8 idx;
+   int first, cnt, i, wkc, fwkc, framesize;
+   boolean lost;
+   uint16 datapos[EC_MAXMDATAGRAM];
+   ec_mdatagramt *dp;
+
+   wkc = 0;
+   lost = FALSE;
+   first = 0;
+   while (first < n)
+   {
+      /* find number of datagrams that fit in one frame */
+      framesize = ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + dgram[first].length;
+      cnt = 1;
+      while (((first + cnt) < n) && (cnt < EC_MAXMDATAGRAM) &&
+             ((framesize + EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + dgram[first + cnt].length) <=
+              (ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + EC_MAXLRWDATA)))
+      {
+         framesize += EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + dgram[first + cnt].length;
+         cnt++;
+      }
+      idx = ecx_getindex(port);
+      dp = &dgram[first];
+      ecx_setupdatagram(port, &(port->txbuf[idx]), dp->com, idx, dp->ADP, dp->ADO, dp->length, dp->data);
+      datapos[0] = EC_HEADERSIZE;
+      for (i = 1; i < cnt; i++)
+      {
+         dp = &dgram[first + i];
+         datapos[i] = ecx_adddatagram(port, &(port->txbuf[idx]), dp->com, idx, (i < (cnt - 1)),
+                                      dp->ADP, dp->ADO, dp->length, dp->data);
+      }
+      fwkc = ecx_srconfirm(port, idx, timeout);
+      for (i = 0; i < cnt; i++)
+      {
+         dp = &dgram[first + i];
+         if (fwkc > EC_NOFRAME)
+         {
+            dp->wkc = port->rxbuf[idx][datapos[i] + dp->length] +
+                      ((int)port->rxbuf[idx][datapos[i] + dp->length + 1] << 8);
+            wkc += dp->wkc;
+            switch (dp->com)
+            {
+               case EC_CMD_NOP:
+                  /* Fall-through */
+               case EC_CMD_APWR:
+                  /* Fall-through */
+               case EC_CMD_FPWR:
+                  /* Fall-through */
+               case EC_CMD_BWR:
+                  /* Fall-through */
+               case EC_CMD_LWR:
+                  /* nothing to return */
+                  break;
+               default:
+                  if (dp->data && dp->length)
+                  {
+                     memcpy(dp->data, &(port->rxbuf[idx][datapos[i]]), dp->length);
+                  }
+                  break;
+            }
+         }
+         else
+         {
+            dp->wkc = EC_NOFRAME;
+            lost = TRUE;
+         }
+      }
+      ecx_setbufstat(port, idx, EC_BUF_EMPTY);
+      first += cnt;
+   }
+
+   return lost ? EC_NOFRAME : wkc;
+}
+
 #ifdef EC_VER1
 int ec_setupdatagram(void *frame, uint8 com, uint8 idx, uint16 ADP, uint16 ADO, uint16 length, void *data)
 {
@@ -546,6 +669,11 @@ uint16 ec_adddatagram (void *frame, uint8 com, uint8 idx, boolean more, uint16 A
    return ecx_adddatagram (&ecx_port, frame, com, idx, more, ADP, ADO, length, data);
 }
 
+void ec_appenddatagram(uint8 idx)
+{
+   ecx_appenddatagram(&ecx_port, idx);
+}
+
 int ec_BWR(uint16 ADP, uint16 ADO, uint16 length, void *data, int timeout)
 {
    return ecx_BWR (&ecx_port, ADP, ADO, length, data, timeout);
@@ -634,4 +762,9 @@ int ec_LRWDC(uint32 LogAdr, uint16 length, void *data, uint16 DCrs, int64 *DCtim
 {
    return ecx_LRWDC(&ecx_port, LogAdr, length, data, DCrs, DCtime, timeout);
 }
+
+int ec_multidatagram(ec_mdatagramt *dgram, int n, int timeout)
+{
+   return ecx_multidatagram(&ecx_port, dgram, n, timeout);
+}
 #endif
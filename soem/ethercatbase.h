@@ -16,8 +16,29 @@ extern "C"
 {
 #endif
 
+/** max. number of datagrams packed in one frame by ecx_multidatagram */
+#define EC_MAXMDATAGRAM    128
+
+/** datagram descriptor for ecx_multidatagram */
+typedef struct ec_mdatagram
+{
+   /** command, EC_CMD_xxx */
+   uint8            com;
+   /** Address Position */
+   uint16           ADP;
+   /** Address Offset */
+   uint16           ADO;
+   /** length of data */
+   uint16           length;
+   /** databuffer to write from or read into, may be NULL for reads */
+   void             *data;
+   /** returned workcounter of this datagram or EC_NOFRAME */
+   int              wkc;
+} ec_mdatagramt;
+
 int ecx_setupdatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, uint16 ADP, uint16 ADO, uint16 length, void *data);
 uint16 ecx_adddatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, boolean more, uint16 ADP, uint16 ADO, uint16 length, void *data);
+void ecx_appenddatagram(ecx_portt *port, uint8 idx);
 int ecx_BWR(ecx_portt *port, uint16 ADP,uint16 ADO,uint16 length,void *data,int timeout);
 int ecx_BRD(ecx_portt *port, uint16 ADP,uint16 ADO,uint16 length,void *data,int timeout);
 int ecx_APRD(ecx_portt *port, uint16 ADP, uint16 ADO, uint16 length, void *data, int timeout);
@@ -34,10 +55,12 @@ int ecx_LRW(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, int timeo
 int ecx_LRD(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, int timeout);
 int ecx_LWR(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, int timeout);
 int ecx_LRWDC(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, uint16 DCrs, int64 *DCtime, int timeout);
+int ecx_multidatagram(ecx_portt *port, ec_mdatagramt *dgram, int n, int timeout);
 
 #ifdef EC_VER1
 int ec_setupdatagram(void *frame, uint8 com, uint8 idx, uint16 ADP, uint16 ADO, uint16 length, void *data);
 uint16 ec_adddatagram(void *frame, uint8 com, uint8 idx, boolean more, uint16 ADP, uint16 ADO, uint16 length, void *data);
+void ec_appenddatagram(uint8 idx);
 int ec_BWR(uint16 ADP,uint16 ADO,uint16 length,void *data,int timeout);
 int ec_BRD(uint16 ADP,uint16 ADO,uint16 length,void *data,int timeout);
 int ec_APRD(uint16 ADP, uint16 ADO, uint16 length, void *data, int timeout);
@@ -54,6 +77,7 @@ int ec_LRW(uint32 LogAdr, uint16 length, void *data, int timeout);
 int ec_LRD(uint32 LogAdr, uint16 length, void *data, int timeout);
 int ec_LWR(uint32 LogAdr, uint16 length, void *data, int timeout);
 int ec_LRWDC(uint32 LogAdr, uint16 length, void *data, uint16 DCrs, int64 *DCtime, int timeout);
+int ec_multidatagram(ec_mdatagramt *dgram, int n, int timeout);
 #endif
 
 #ifdef __cplusplus
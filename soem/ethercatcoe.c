@@ -126,16 +126,20 @@ int ecx_SDOread(ecx_contextt *context, uint16 slave, uint16 index, uint8 subinde
    int32 SDOlen;
    uint8 *bp;
    uint8 *hp;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt, toggle;
    boolean NotLast;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSDOp = (ec_SDOt *)&MbxIn;
-   SDOp = (ec_SDOt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aSDOp = (ec_SDOt *)MbxIn;
+   SDOp = (ec_SDOt *)MbxOut;
    SDOp->MbxHeader.length = htoes(0x000a);
    SDOp->MbxHeader.address = htoes(0x0000);
    SDOp->MbxHeader.priority = 0x00;
@@ -160,13 +164,13 @@ int ecx_SDOread(ecx_contextt *context, uint16 slave, uint16 index, uint8 subinde
    SDOp->SubIndex = subindex;
    SDOp->ldata[0] = 0;
    /* send CoE request to slave */
-   wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
    if (wkc > 0) /* succeeded to place mailbox in slave ? */
    {
       /* clean mailboxbuffer */
-      ec_clearmbx(&MbxIn);
+      MbxIn = ecx_mbxin(context, slave);
       /* read slave response */
-      wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+      wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
       if (wkc > 0) /* succeeded to read slave response ? */
       {
          /* slave response should be CoE, SDO response and the correct index */
@@ -212,7 +216,7 @@ int ecx_SDOread(ecx_contextt *context, uint16 slave, uint16 index, uint8 subinde
                      toggle= 0x00;
                      while (NotLast) /* segmented transfer */
                      {
-                        SDOp = (ec_SDOt *)&MbxOut;
+                        SDOp = (ec_SDOt *)MbxOut;
                         SDOp->MbxHeader.length = htoes(0x000a);
                         SDOp->MbxHeader.address = htoes(0x0000);
                         SDOp->MbxHeader.priority = 0x00;
@@ -225,13 +229,13 @@ int ecx_SDOread(ecx_contextt *context, uint16 slave, uint16 index, uint8 subinde
                         SDOp->SubIndex = subindex;
                         SDOp->ldata[0] = 0;
                         /* send segmented upload request to slave */
-                        wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+                        wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
                         /* is mailbox transferred to slave ? */
                         if (wkc > 0)
                         {
-                           ec_clearmbx(&MbxIn);
+                           MbxIn = ecx_mbxin(context, slave);
                            /* read slave response */
-                           wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+                           wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
                            /* has slave responded ? */
                            if (wkc > 0)
                            {
@@ -332,17 +336,21 @@ int ecx_SDOwrite(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubInd
 {
    ec_SDOt *SDOp, *aSDOp;
    int wkc, maxdata, framedatasize;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt, toggle;
    boolean  NotLast;
    const uint8 *hp;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, Slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, Slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSDOp = (ec_SDOt *)&MbxIn;
-   SDOp = (ec_SDOt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, Slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, Slave);
+   aSDOp = (ec_SDOt *)MbxIn;
+   SDOp = (ec_SDOt *)MbxOut;
    maxdata = context->slavelist[Slave].mbx_l - 0x10; /* data section=mailbox size - 6 mbx - 2 CoE - 8 sdo req */
    /* if small data use expedited transfer */
    if ((psize <= 4) && !CA)
@@ -362,12 +370,12 @@ int ecx_SDOwrite(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubInd
       /* copy parameter data to mailbox */
       memcpy(&SDOp->ldata[0], hp, psize);
       /* send mailbox SDO download request to slave */
-      wkc = ecx_mbxsend(context, Slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+      wkc = ecx_mbxsend(context, Slave, MbxOut, EC_TIMEOUTTXM);
       if (wkc > 0)
       {
-         ec_clearmbx(&MbxIn);
+         MbxIn = ecx_mbxin(context, Slave);
          /* read slave response */
-         wkc = ecx_mbxreceive(context, Slave, (ec_mbxbuft *)&MbxIn, Timeout);
+         wkc = ecx_mbxreceive(context, Slave, MbxIn, Timeout);
          if (wkc > 0)
          {
             /* response should be CoE, SDO response, correct index and subindex */
@@ -432,12 +440,12 @@ int ecx_SDOwrite(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubInd
       hp += framedatasize;
       psize -= framedatasize;
       /* send mailbox SDO download request to slave */
-      wkc = ecx_mbxsend(context, Slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+      wkc = ecx_mbxsend(context, Slave, MbxOut, EC_TIMEOUTTXM);
       if (wkc > 0)
       {
-         ec_clearmbx(&MbxIn);
+         MbxIn = ecx_mbxin(context, Slave);
          /* read slave response */
-         wkc = ecx_mbxreceive(context, Slave, (ec_mbxbuft *)&MbxIn, Timeout);
+         wkc = ecx_mbxreceive(context, Slave, MbxIn, Timeout);
          if (wkc > 0)
          {
             /* response should be CoE, SDO response, correct index and subindex */
@@ -452,7 +460,7 @@ int ecx_SDOwrite(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubInd
                /* repeat while segments left */
                while (NotLast)
                {
-                  SDOp = (ec_SDOt *)&MbxOut;
+                  SDOp = (ec_SDOt *)MbxOut;
                   framedatasize = psize;
                   NotLast = FALSE;
                   SDOp->Command = 0x01; /* last segment */
@@ -485,12 +493,12 @@ int ecx_SDOwrite(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubInd
                   hp += framedatasize;
                   psize -= framedatasize;
                   /* send SDO download request */
-                  wkc = ecx_mbxsend(context, Slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+                  wkc = ecx_mbxsend(context, Slave, MbxOut, EC_TIMEOUTTXM);
                   if (wkc > 0)
                   {
-                     ec_clearmbx(&MbxIn);
+                     MbxIn = ecx_mbxin(context, Slave);
                      /* read slave response */
-                     wkc = ecx_mbxreceive(context, Slave, (ec_mbxbuft *)&MbxIn, Timeout);
+                     wkc = ecx_mbxreceive(context, Slave, MbxIn, Timeout);
                      if (wkc > 0)
                      {
                         if (((aSDOp->MbxHeader.mbxtype & 0x0f) == ECT_MBXT_COE) &&
@@ -552,14 +560,18 @@ int ecx_RxPDO(ecx_contextt *context, uint16 Slave, uint16 RxPDOnumber, int psize
 {
    ec_SDOt *SDOp;
    int wkc, maxdata, framedatasize;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, Slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, Slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   SDOp = (ec_SDOt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, Slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, Slave);
+   SDOp = (ec_SDOt *)MbxOut;
    maxdata = context->slavelist[Slave].mbx_l - 0x08; /* data section=mailbox size - 6 mbx - 2 CoE */
    framedatasize = psize;
    if (framedatasize > maxdata)
@@ -577,7 +589,7 @@ int ecx_RxPDO(ecx_contextt *context, uint16 Slave, uint16 RxPDOnumber, int psize
    /* copy PDO data to mailbox */
    memcpy(&SDOp->Command, p, framedatasize);
    /* send mailbox RxPDO request to slave */
-   wkc = ecx_mbxsend(context, Slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, Slave, MbxOut, EC_TIMEOUTTXM);
 
    return wkc;
 }
@@ -598,16 +610,20 @@ int ecx_TxPDO(ecx_contextt *context, uint16 slave, uint16 TxPDOnumber , int *psi
 {
    ec_SDOt *SDOp, *aSDOp;
    int wkc;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
    uint16 framedatasize;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSDOp = (ec_SDOt *)&MbxIn;
-   SDOp = (ec_SDOt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aSDOp = (ec_SDOt *)MbxIn;
+   SDOp = (ec_SDOt *)MbxOut;
    SDOp->MbxHeader.length = htoes(0x02);
    SDOp->MbxHeader.address = htoes(0x0000);
    SDOp->MbxHeader.priority = 0x00;
@@ -616,13 +632,13 @@ int ecx_TxPDO(ecx_contextt *context, uint16 slave, uint16 TxPDOnumber , int *psi
    context->slavelist[slave].mbx_cnt = cnt;
    SDOp->MbxHeader.mbxtype = ECT_MBXT_COE + MBX_HDR_SET_CNT(cnt); /* CoE */
    SDOp->CANOpen = htoes((TxPDOnumber & 0x01ff) + (ECT_COES_TXPDO_RR << 12)); /* number 9bits service upper 4 bits */
-   wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
    if (wkc > 0)
    {
       /* clean mailboxbuffer */
-      ec_clearmbx(&MbxIn);
+      MbxIn = ecx_mbxin(context, slave);
       /* read slave response */
-      wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+      wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
       if (wkc > 0) /* succeeded to read slave response ? */
       {
          /* slave response should be CoE, TxPDO */
@@ -988,31 +1004,32 @@ int ecx_readPDOmapCA(ecx_contextt *context, uint16 Slave, int Thread_n, uint32 *
    return retVal;
 }
 
-/** CoE read Object Description List.
- *
- * @param[in]  context  = context struct
- * @param[in]  Slave    = Slave number.
- * @param[out] pODlist  = resulting Object Description list.
- * @return Workcounter of slave response.
- */
-int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
+/* read object description list, abortcode is set when the slave answered
+ * with an SDO information error */
+static int ecx_readODlist_abort(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist,
+   int32 *abortcode)
 {
    ec_SDOservicet *SDOp, *aSDOp;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    int wkc;
    uint16 x, n, i, sp, offset;
    boolean stop;
    uint8 cnt;
    boolean First;
 
+   *abortcode = 0;
    pODlist->Slave = Slave;
    pODlist->Entries = 0;
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, Slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* clear pending out mailbox in slave if available. Timeout is set to 0 */
-   wkc = ecx_mbxreceive(context, Slave, &MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSDOp = (ec_SDOservicet*)&MbxIn;
-   SDOp = (ec_SDOservicet*)&MbxOut;
+   wkc = ecx_mbxreceive(context, Slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, Slave);
+   aSDOp = (ec_SDOservicet*)MbxIn;
+   SDOp = (ec_SDOservicet*)MbxOut;
    SDOp->MbxHeader.length = htoes(0x0008);
    SDOp->MbxHeader.address = htoes(0x0000);
    SDOp->MbxHeader.priority = 0x00;
@@ -1026,7 +1043,7 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
    SDOp->Fragments = 0; /* fragments left */
    SDOp->wdata[0] = htoes(0x01); /* all objects */
    /* send get object description list request to slave */
-   wkc = ecx_mbxsend(context, Slave, &MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, Slave, MbxOut, EC_TIMEOUTTXM);
    /* mailbox placed in slave ? */
    if (wkc > 0)
    {
@@ -1037,9 +1054,9 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
       do
       {
          stop = TRUE; /* assume this is last iteration */
-         ec_clearmbx(&MbxIn);
+         MbxIn = ecx_mbxin(context, Slave);
          /* read slave response */
-         wkc = ecx_mbxreceive(context, Slave, &MbxIn, EC_TIMEOUTRXM);
+         wkc = ecx_mbxreceive(context, Slave, MbxIn, EC_TIMEOUTRXM);
          /* got response ? */
          if (wkc > 0)
          {
@@ -1089,7 +1106,8 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
             {
                if ((aSDOp->Opcode &  0x7f) == ECT_SDOINFO_ERROR) /* SDO info error received */
                {
-                  ecx_SDOinfoerror(context, Slave, 0, 0, etohl(aSDOp->ldata[0]));
+                  *abortcode = etohl(aSDOp->ldata[0]);
+                  ecx_SDOinfoerror(context, Slave, 0, 0, *abortcode);
                   stop = TRUE;
                }
                else
@@ -1107,6 +1125,62 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
    return wkc;
 }
 
+/** CoE read Object Description List.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  Slave    = Slave number.
+ * @param[out] pODlist  = resulting Object Description list.
+ * @return Workcounter of slave response.
+ */
+int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist)
+{
+   int32 abortcode;
+
+   return ecx_readODlist_abort(context, Slave, pODlist, &abortcode);
+}
+
+/* store get object description response in ODlist */
+static void ecx_ODdescription_parse(ec_SDOservicet *aSDOp, uint16 Item, ec_ODlistt *pODlist)
+{
+   uint16 n;
+
+   n = (etohs(aSDOp->MbxHeader.length) - 12); /* length of string(name of object) */
+   if (n > EC_MAXNAME)
+   {
+      n = EC_MAXNAME; /* max chars */
+   }
+   pODlist->DataType[Item] = etohs(aSDOp->wdata[1]);
+   pODlist->ObjectCode[Item] = aSDOp->bdata[5];
+   pODlist->MaxSub[Item] = aSDOp->bdata[4];
+
+   memcpy(pODlist->Name[Item], &aSDOp->bdata[6], n);
+   pODlist->Name[Item][n] = 0x00; /* String terminator */
+}
+
+/* store get object entry description response */
+static void ecx_OE_parse(ec_SDOservicet *aSDOp, uint8 *ValueInfo, uint16 *DataType,
+   uint16 *BitLength, uint16 *ObjAccess, char *Name)
+{
+   int16 n;
+
+   n = (etohs(aSDOp->MbxHeader.length) - 16); /* length of string(name of object) */
+   if (n > EC_MAXNAME)
+   {
+      n = EC_MAXNAME; /* max string length */
+   }
+   if (n < 0 )
+   {
+      n = 0;
+   }
+   *ValueInfo = aSDOp->bdata[3];
+   *DataType = etohs(aSDOp->wdata[2]);
+   *BitLength = etohs(aSDOp->wdata[3]);
+   *ObjAccess = etohs(aSDOp->wdata[4]);
+
+   memcpy(Name, &aSDOp->wdata[5], n);
+   Name[n] = 0x00; /* string terminator */
+}
+
 /** CoE read Object Description. Adds textual description to object indexes.
  *
  * @param[in]  context       = context struct
@@ -1118,8 +1192,8 @@ int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlis
 {
    ec_SDOservicet *SDOp, *aSDOp;
    int wkc;
-   uint16  n, Slave;
-   ec_mbxbuft MbxIn, MbxOut;
+   uint16  Slave;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
 
    Slave = pODlist->Slave;
@@ -1127,12 +1201,16 @@ int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlis
    pODlist->ObjectCode[Item] = 0;
    pODlist->MaxSub[Item] = 0;
    pODlist->Name[Item][0] = 0;
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, Slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* clear pending out mailbox in slave if available. Timeout is set to 0 */
-   wkc = ecx_mbxreceive(context, Slave, &MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSDOp = (ec_SDOservicet*)&MbxIn;
-   SDOp = (ec_SDOservicet*)&MbxOut;
+   wkc = ecx_mbxreceive(context, Slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, Slave);
+   aSDOp = (ec_SDOservicet*)MbxIn;
+   SDOp = (ec_SDOservicet*)MbxOut;
    SDOp->MbxHeader.length = htoes(0x0008);
    SDOp->MbxHeader.address = htoes(0x0000);
    SDOp->MbxHeader.priority = 0x00;
@@ -1146,30 +1224,20 @@ int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlis
    SDOp->Fragments = 0; /* fragments left */
    SDOp->wdata[0] = htoes(pODlist->Index[Item]); /* Data of Index */
    /* send get object description request to slave */
-   wkc = ecx_mbxsend(context, Slave, &MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, Slave, MbxOut, EC_TIMEOUTTXM);
    /* mailbox placed in slave ? */
    if (wkc > 0)
    {
-      ec_clearmbx(&MbxIn);
+      MbxIn = ecx_mbxin(context, Slave);
       /* read slave response */
-      wkc = ecx_mbxreceive(context, Slave, &MbxIn, EC_TIMEOUTRXM);
+      wkc = ecx_mbxreceive(context, Slave, MbxIn, EC_TIMEOUTRXM);
       /* got response ? */
       if (wkc > 0)
       {
          if (((aSDOp->MbxHeader.mbxtype & 0x0f) == ECT_MBXT_COE) &&
              ((aSDOp->Opcode & 0x7f) == ECT_GET_OD_RES))
          {
-            n = (etohs(aSDOp->MbxHeader.length) - 12); /* length of string(name of object) */
-            if (n > EC_MAXNAME)
-            {
-               n = EC_MAXNAME; /* max chars */
-            }
-            pODlist->DataType[Item] = etohs(aSDOp->wdata[1]);
-            pODlist->ObjectCode[Item] = aSDOp->bdata[5];
-            pODlist->MaxSub[Item] = aSDOp->bdata[4];
-
-            strncpy(pODlist->Name[Item] , (char *)&aSDOp->bdata[6], n);
-            pODlist->Name[Item][n] = 0x00; /* String terminator */
+            ecx_ODdescription_parse(aSDOp, Item, pODlist);
          }
          /* got unexpected response from slave */
          else
@@ -1205,19 +1273,22 @@ int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt
    ec_SDOservicet *SDOp, *aSDOp;
    int wkc;
    uint16 Index, Slave;
-   int16 n;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
 
    wkc = 0;
    Slave = pODlist->Slave;
    Index = pODlist->Index[Item];
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, Slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* clear pending out mailbox in slave if available. Timeout is set to 0 */
-   wkc = ecx_mbxreceive(context, Slave, &MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSDOp = (ec_SDOservicet*)&MbxIn;
-   SDOp = (ec_SDOservicet*)&MbxOut;
+   wkc = ecx_mbxreceive(context, Slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, Slave);
+   aSDOp = (ec_SDOservicet*)MbxIn;
+   SDOp = (ec_SDOservicet*)MbxOut;
    SDOp->MbxHeader.length = htoes(0x000a);
    SDOp->MbxHeader.address = htoes(0x0000);
    SDOp->MbxHeader.priority = 0x00;
@@ -1233,13 +1304,13 @@ int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt
    SDOp->bdata[2] = SubI;       /* SubIndex */
    SDOp->bdata[3] = 1 + 2 + 4; /* get access rights, object category, PDO */
    /* send get object entry description request to slave */
-   wkc = ecx_mbxsend(context, Slave, &MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, Slave, MbxOut, EC_TIMEOUTTXM);
    /* mailbox placed in slave ? */
    if (wkc > 0)
    {
-      ec_clearmbx(&MbxIn);
+      MbxIn = ecx_mbxin(context, Slave);
       /* read slave response */
-      wkc = ecx_mbxreceive(context, Slave, &MbxIn, EC_TIMEOUTRXM);
+      wkc = ecx_mbxreceive(context, Slave, MbxIn, EC_TIMEOUTRXM);
       /* got response ? */
       if (wkc > 0)
       {
@@ -1247,22 +1318,8 @@ int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt
              ((aSDOp->Opcode &  0x7f) == ECT_GET_OE_RES))
          {
             pOElist->Entries++;
-            n = (etohs(aSDOp->MbxHeader.length) - 16); /* length of string(name of object) */
-            if (n > EC_MAXNAME)
-            {
-               n = EC_MAXNAME; /* max string length */
-            }
-            if (n < 0 )
-            {
-               n = 0;
-            }
-            pOElist->ValueInfo[SubI] = aSDOp->bdata[3];
-            pOElist->DataType[SubI] = etohs(aSDOp->wdata[2]);
-            pOElist->BitLength[SubI] = etohs(aSDOp->wdata[3]);
-            pOElist->ObjAccess[SubI] = etohs(aSDOp->wdata[4]);
-
-            strncpy(pOElist->Name[SubI] , (char *)&aSDOp->wdata[5], n);
-            pOElist->Name[SubI][n] = 0x00; /* string terminator */
+            ecx_OE_parse(aSDOp, &(pOElist->ValueInfo[SubI]), &(pOElist->DataType[SubI]),
+               &(pOElist->BitLength[SubI]), &(pOElist->ObjAccess[SubI]), pOElist->Name[SubI]);
          }
          /* got unexpected response from slave */
          else
@@ -1310,131 +1367,1490 @@ int ecx_readOE(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist, ec_OElis
    return wkc;
 }
 
-#ifdef EC_VER1
-/** Report SDO error.
- *
- * @param[in]  Slave      = Slave number
- * @param[in]  Index      = Index that generated error
- * @param[in]  SubIdx     = Subindex that generated error
- * @param[in]  AbortCode  = Abortcode, see EtherCAT documentation for list
- * @see ecx_SDOerror
- */
-void ec_SDOerror(uint16 Slave, uint16 Index, uint8 SubIdx, int32 AbortCode)
+/** max. number of SDO information requests outstanding in ecx_SDOinfo_pipeline() */
+#define EC_SDOINFO_PIPELINE  2
+
+/* build SDO information request for object description (ECT_GET_OD_REQ) or
+ * object entry description (ECT_GET_OE_REQ) */
+static void ecx_SDOinfo_request(ecx_contextt *context, uint16 Slave, ec_SDOservicet *SDOp,
+   uint8 opcode, uint16 Index, uint8 SubI)
 {
-   ecx_SDOerror(&ecx_context, Slave, Index, SubIdx, AbortCode);
+   uint8 cnt;
+
+   SDOp->MbxHeader.length = htoes((opcode == ECT_GET_OE_REQ) ? 0x000a : 0x0008);
+   SDOp->MbxHeader.address = htoes(0x0000);
+   SDOp->MbxHeader.priority = 0x00;
+   /* Get new mailbox counter value */
+   cnt = ec_nextmbxcnt(context->slavelist[Slave].mbx_cnt);
+   context->slavelist[Slave].mbx_cnt = cnt;
+   SDOp->MbxHeader.mbxtype = ECT_MBXT_COE + MBX_HDR_SET_CNT(cnt); /* CoE */
+   SDOp->CANOpen = htoes(0x000 + (ECT_COES_SDOINFO << 12)); /* number 9bits service upper 4 bits */
+   SDOp->Opcode = opcode;
+   SDOp->Reserved = 0;
+   SDOp->Fragments = 0; /* fragments left */
+   SDOp->wdata[0] = htoes(Index);
+   if (opcode == ECT_GET_OE_REQ)
+   {
+      SDOp->bdata[2] = SubI;      /* SubIndex */
+      SDOp->bdata[3] = 1 + 2 + 4; /* get access rights, object category, PDO */
+   }
 }
 
-/** CoE SDO read, blocking. Single subindex or Complete Access.
- *
- * Only a "normal" upload request is issued. If the requested parameter is <= 4bytes
- * then a "expedited" response is returned, otherwise a "normal" response. If a "normal"
- * response is larger than the mailbox size then the response is segmented. The function
- * will combine all segments and copy them to the parameter buffer.
- *
- * @param[in]  slave      = Slave number
- * @param[in]  index      = Index to read
- * @param[in]  subindex   = Subindex to read, must be 0 or 1 if CA is used.
- * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes read.
- * @param[in,out] psize   = Size in bytes of parameter buffer, returns bytes read from SDO.
- * @param[out] p          = Pointer to parameter buffer
- * @param[in]  timeout    = Timeout in us, standard is EC_TIMEOUTRXM
- * @return Workcounter from last slave response
- * @see ecx_SDOread
- */
-int ec_SDOread(uint16 slave, uint16 index, uint8 subindex,
-               boolean CA, int *psize, void *p, int timeout)
+/* Read object descriptions (opcode ECT_GET_OD_REQ) of all objects in ODlist,
+ * or object entry descriptions (ECT_GET_OE_REQ) of all subindexes of all
+ * objects into OE, with up to EC_SDOINFO_PIPELINE requests outstanding. Each
+ * round is one frame that writes the next request to the slave receive
+ * mailbox and reads the slave send mailbox, so no SM status polling is needed.
+ * SDO information errors are stored in OE, or per object in ODabort if not
+ * NULL. Returns number of requests answered with a description or an error. */
+static int ecx_SDOinfo_pipeline(ecx_contextt *context, uint8 opcode,
+   ec_ODlistt *pODlist, ec_OEcacheentryt *OE, int32 *ODabort)
 {
-   return ecx_SDOread(&ecx_context, slave, index, subindex, CA, psize, p, timeout);
+   ec_mdatagramt dg[2];
+   ec_SDOservicet *SDOp, *aSDOp;
+   ec_slavet *slavep;
+   ec_mbxbuft *MbxIn, *MbxOut;
+   ec_OEcacheentryt *e;
+   osal_timert timer;
+   uint16 Slave, Item, index;
+   uint16 reqitem[EC_SDOINFO_PIPELINE];
+   uint8 reqsub[EC_SDOINFO_PIPELINE];
+   uint32 reqk[EC_SDOINFO_PIPELINE];
+   uint32 total, sent, done, k;
+   int nd, wr, rd, found, skip, j, match;
+   int32 abortcode;
+   uint8 SubI, resop;
+   boolean built;
+
+   Slave = pODlist->Slave;
+   slavep = &(context->slavelist[Slave]);
+   total = 0;
+   for (Item = 0; Item < pODlist->Entries; Item++)
+   {
+      total += (opcode == ECT_GET_OE_REQ) ? (uint32)pODlist->MaxSub[Item] + 1 : 1;
+      if (opcode == ECT_GET_OD_REQ)
+      {
+         pODlist->DataType[Item] = 0;
+         pODlist->ObjectCode[Item] = 0;
+         pODlist->MaxSub[Item] = 0;
+         pODlist->Name[Item][0] = 0;
+         if (ODabort)
+         {
+            ODabort[Item] = 0;
+         }
+      }
+   }
+   if (opcode == ECT_GET_OE_REQ)
+   {
+      memset(OE, 0, total * sizeof(ec_OEcacheentryt));
+   }
+   resop = opcode + 1;
+   MbxIn = ecx_mbxin(context, Slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
+   /* clear pending out mailbox in slave if available. Timeout is set to 0 */
+   (void)ecx_mbxreceive(context, Slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, Slave);
+   SDOp = (ec_SDOservicet *)MbxOut;
+   aSDOp = (ec_SDOservicet *)MbxIn;
+   sent = done = found = 0;
+   skip = 0;
+   Item = 0;
+   SubI = 0;
+   built = FALSE;
+   osal_timer_start(&timer, EC_TIMEOUTRXM);
+   while ((done < total) && (osal_timer_is_expired(&timer) == FALSE))
+   {
+      nd = 0;
+      wr = rd = -1;
+      if (!built && (sent < total) && ((sent - done) < EC_SDOINFO_PIPELINE))
+      {
+         memset(MbxOut, 0, slavep->mbx_l);
+         ecx_SDOinfo_request(context, Slave, SDOp, opcode, pODlist->Index[Item], SubI);
+         reqitem[sent % EC_SDOINFO_PIPELINE] = Item;
+         reqsub[sent % EC_SDOINFO_PIPELINE] = SubI;
+         reqk[sent % EC_SDOINFO_PIPELINE] = sent;
+         built = TRUE;
+      }
+      if (built)
+      {
+         dg[nd].com = EC_CMD_FPWR;
+         dg[nd].ADP = slavep->configadr;
+         dg[nd].ADO = slavep->mbx_wo;
+         dg[nd].length = slavep->mbx_l;
+         dg[nd].data = MbxOut;
+         wr = nd++;
+      }
+      if ((sent > done) || skip)
+      {
+         memset(MbxIn, 0, slavep->mbx_rl);
+         dg[nd].com = EC_CMD_FPRD;
+         dg[nd].ADP = slavep->configadr;
+         dg[nd].ADO = slavep->mbx_ro;
+         dg[nd].length = slavep->mbx_rl;
+         dg[nd].data = MbxIn;
+         rd = nd++;
+      }
+      (void)ecx_multidatagram(context->port, dg, nd, EC_TIMEOUTRET3);
+      /* request accepted by slave, next one */
+      if ((wr >= 0) && (dg[wr].wkc == 1))
+      {
+         built = FALSE;
+         sent++;
+         if ((opcode == ECT_GET_OE_REQ) && (SubI < pODlist->MaxSub[Item]))
+         {
+            SubI++;
+         }
+         else
+         {
+            Item++;
+            SubI = 0;
+         }
+      }
+      if ((rd < 0) || (dg[rd].wkc != 1))
+      {
+         osal_usleep(EC_LOCALDELAY);
+         continue;
+      }
+      if (((aSDOp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_COE) ||
+          ((etohs(aSDOp->CANOpen) >> 12) != ECT_COES_SDOINFO))
+      {
+         (void)ecx_mbxhandlemsg(context, Slave, MbxIn);
+         continue;
+      }
+      osal_timer_start(&timer, EC_TIMEOUTRXM);
+      /* continuation of fragmented response, names are cut at EC_MAXNAME */
+      if (skip)
+      {
+         skip--;
+         continue;
+      }
+      if (done == sent)
+      {
+         continue;
+      }
+      if ((aSDOp->Opcode & 0x7f) == ECT_SDOINFO_ERROR)
+      {
+         j = done % EC_SDOINFO_PIPELINE;
+         abortcode = etohl(aSDOp->ldata[0]);
+         ecx_SDOinfoerror(context, Slave, pODlist->Index[reqitem[j]], reqsub[j], abortcode);
+         if (opcode == ECT_GET_OE_REQ)
+         {
+            OE[reqk[j]].Valid = EC_ODCACHE_ERROR;
+            OE[reqk[j]].AbortCode = abortcode;
+         }
+         else if (ODabort)
+         {
+            ODabort[reqitem[j]] = abortcode;
+         }
+         done++;
+         found++;
+         continue;
+      }
+      if ((aSDOp->Opcode & 0x7f) != resop)
+      {
+         ecx_packeterror(context, Slave, pODlist->Index[reqitem[done % EC_SDOINFO_PIPELINE]], 0, 1);
+         continue;
+      }
+      skip = aSDOp->Fragments;
+      index = etohs(aSDOp->wdata[0]);
+      /* responses come in request order, skip requests the slave did not answer */
+      match = -1;
+      for (k = done; (k < sent) && (match < 0); k++)
+      {
+         j = k % EC_SDOINFO_PIPELINE;
+         if ((pODlist->Index[reqitem[j]] == index) &&
+             ((opcode == ECT_GET_OD_REQ) || (aSDOp->bdata[2] == reqsub[j])))
+         {
+            match = j;
+            done = k + 1;
+         }
+      }
+      if (match < 0)
+      {
+         ecx_packeterror(context, Slave, index, 0, 1); /* Unexpected frame returned */
+         continue;
+      }
+      if (opcode == ECT_GET_OD_REQ)
+      {
+         ecx_ODdescription_parse(aSDOp, reqitem[match], pODlist);
+      }
+      else
+      {
+         e = &OE[reqk[match]];
+         ecx_OE_parse(aSDOp, &(e->ValueInfo), &(e->DataType), &(e->BitLength),
+            &(e->ObjAccess), e->Name);
+         e->Valid = EC_ODCACHE_VALID;
+      }
+      found++;
+   }
+
+   return found;
 }
 
-/** CoE SDO write, blocking. Single subindex or Complete Access.
- *
- * A "normal" download request is issued, unless we have
- * small data, then a "expedited" transfer is used. If the parameter is larger than
- * the mailbox size then the download is segmented. The function will split the
- * parameter data in segments and send them to the slave one by one.
+/** Initialise an empty object dictionary cache.
  *
- * @param[in]  Slave      = Slave number
- * @param[in]  Index      = Index to write
- * @param[in]  SubIndex   = Subindex to write, must be 0 or 1 if CA is used.
- * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes written.
- * @param[in]  psize      = Size in bytes of parameter buffer.
- * @param[out] p          = Pointer to parameter buffer
- * @param[in]  Timeout    = Timeout in us, standard is EC_TIMEOUTRXM
- * @return Workcounter from last slave response
- * @see ecx_SDOwrite
+ * @param[out] cache      = object dictionary cache
  */
-int ec_SDOwrite(uint16 Slave, uint16 Index, uint8 SubIndex,
-                boolean CA, int psize, const void *p, int Timeout)
+void ec_ODcache_init(ec_ODcachet *cache)
 {
-   return ecx_SDOwrite(&ecx_context, Slave, Index, SubIndex, CA, psize, p, Timeout);
+   memset(cache, 0, sizeof(*cache));
+   cache->magic = EC_ODCACHE_MAGIC;
+   cache->version = EC_ODCACHE_VERSION;
+   cache->devicesize = sizeof(ec_ODcachedevicet);
+   cache->entrysize = sizeof(ec_OEcacheentryt);
 }
 
-/** CoE RxPDO write, blocking.
- *
- * A RxPDO download request is issued.
- *
- * @param[in]  Slave         = Slave number
- * @param[in]  RxPDOnumber   = Related RxPDO number
- * @param[in]  psize         = Size in bytes of PDO buffer.
- * @param[out] p             = Pointer to PDO buffer
- * @return Workcounter from last slave response
- * @see ecx_RxPDO
- */
-int ec_RxPDO(uint16 Slave, uint16 RxPDOnumber, int psize, const void *p)
+/* header of cache matches this build and the counts are in range */
+static boolean ecx_ODcache_header(const ec_ODcachet *cache)
 {
-   return ecx_RxPDO(&ecx_context, Slave, RxPDOnumber, psize, p);
+   return ((cache->magic == EC_ODCACHE_MAGIC) && (cache->version == EC_ODCACHE_VERSION) &&
+           (cache->devicesize == sizeof(ec_ODcachedevicet)) &&
+           (cache->entrysize == sizeof(ec_OEcacheentryt)) &&
+           (cache->devices <= EC_MAXODCACHE) && (cache->OEentries <= EC_MAXODCACHEOE));
 }
 
-/** CoE TxPDO read remote request, blocking.
- *
- * A TxPDO download request is issued.
+/* cache can be used, a zero filled cache is taken as an empty one */
+static boolean ecx_ODcache_usable(ec_ODcachet *cache)
+{
+   if ((cache->magic == 0) && (cache->devices == 0) && (cache->OEentries == 0))
+   {
+      ec_ODcache_init(cache);
+   }
+   return ecx_ODcache_header(cache);
+}
+
+/* object list and entry range of a cached device are inside the cache */
+static boolean ecx_ODcache_devcheck(const ec_ODcachet *cache, const ec_ODcachedevicet *dev)
+{
+   uint32 end;
+   int i;
+
+   if ((dev->ODlist.Entries > EC_MAXODLIST) || (dev->OEfirst > cache->OEentries))
+   {
+      return FALSE;
+   }
+   if (dev->ODlistabort)
+   {
+      return TRUE; /* no entries stored */
+   }
+   end = dev->OEfirst;
+   for (i = 0; i < dev->ODlist.Entries; i++)
+   {
+      end += (uint32)dev->ODlist.MaxSub[i] + 1;
+   }
+   return (end <= cache->OEentries);
+}
+
+/** Check an object dictionary cache, f.e. after loading it from a file.
+ * The header has to match this build and every cached object list and
+ * entry range has to be inside the cache.
  *
- * @param[in]  slave         = Slave number
- * @param[in]  TxPDOnumber   = Related TxPDO number
- * @param[in,out] psize      = Size in bytes of PDO buffer, returns bytes read from PDO.
- * @param[out] p             = Pointer to PDO buffer
- * @param[in]  timeout       = Timeout in us, standard is EC_TIMEOUTRXM
- * @return Workcounter from last slave response
- * @see ecx_TxPDO
+ * @param[in]  cache      = object dictionary cache
+ * @return TRUE if the cache can be used
  */
-int ec_TxPDO(uint16 slave, uint16 TxPDOnumber , int *psize, void *p, int timeout)
+boolean ec_ODcache_check(const ec_ODcachet *cache)
 {
-   return ecx_TxPDO(&ecx_context, slave, TxPDOnumber, psize, p, timeout);
+   int i;
+
+   if (!ecx_ODcache_header(cache))
+   {
+      return FALSE;
+   }
+   for (i = 0; i < cache->devices; i++)
+   {
+      if (!ecx_ODcache_devcheck(cache, &(cache->device[i])))
+      {
+         return FALSE;
+      }
+   }
+   return TRUE;
 }
 
-/** Read PDO assign structure
- * @param[in]  Slave         = Slave number
- * @param[in]  PDOassign     = PDO assign object
- * @return total bitlength of PDO assign
- */
-uint32 ec_readPDOassign(uint16 Slave, uint16 PDOassign)
+/* find device type of slave in object dictionary cache, -1 if not cached or
+ * if its entry is out of range */
+static int ecx_ODcache_find(ecx_contextt *context, ec_ODcachet *cache, uint16 Slave)
 {
-   return ecx_readPDOassign(&ecx_context, Slave, PDOassign);
+   ec_slavet *slavep;
+   int i;
+
+   slavep = &(context->slavelist[Slave]);
+   for (i = 0; i < cache->devices; i++)
+   {
+      if ((cache->device[i].eep_man == slavep->eep_man) &&
+          (cache->device[i].eep_id == slavep->eep_id) &&
+          (cache->device[i].eep_rev == slavep->eep_rev))
+      {
+         return ecx_ODcache_devcheck(cache, &(cache->device[i])) ? i : -1;
+      }
+   }
+   return -1;
 }
 
-/** Read PDO assign structure in Complete Access mode
- * @param[in]  Slave         = Slave number
- * @param[in]  PDOassign     = PDO assign object
- * @param[in]  Thread_n      = Calling thread index
- * @return total bitlength of PDO assign
- * @see ecx_readPDOmap
- */
-uint32 ec_readPDOassignCA(uint16 Slave, uint16 PDOassign, int Thread_n)
+/* store identity of slave in cache device entry */
+static void ecx_ODcache_identity(ecx_contextt *context, ec_ODcachedevicet *dev, uint16 Slave)
 {
-   return ecx_readPDOassignCA(&ecx_context, Slave, Thread_n, PDOassign);
+   ec_slavet *slavep;
+
+   slavep = &(context->slavelist[Slave]);
+   dev->eep_man = slavep->eep_man;
+   dev->eep_id = slavep->eep_id;
+   dev->eep_rev = slavep->eep_rev;
 }
 
-/** CoE read PDO mapping.
+/** CoE read Object Dictionary list with object descriptions, cached.
  *
- * CANopen has standard indexes defined for PDO mapping. This function
- * tries to read them and collect a full input and output mapping size
- * of designated slave.
+ * Object dictionaries are cached per device type, keyed by vendor, product code
+ * and revision from the EEPROM. If the device type of the slave is cached the
+ * list is copied from the cache without mailbox traffic. Otherwise the list is
+ * read with ecx_readODlist() and the object descriptions and all object entry
+ * descriptions are read with pipelined SDO information requests and stored in
+ * the cache if there is room. Replaces ecx_readODlist() followed by
+ * ecx_readODdescription() for every object.
  *
- * For details, see #ecx_readPDOmap
+ * SDO information errors returned by the slave for the list or for single
+ * descriptions are cached as well. They are reported to the error list again
+ * on a cache hit, as if the slave was asked. Timeouts are not cached.
  *
- * @param[in] Slave    = Slave number
- * @param[out] Osize   = Size in bits of output mapping (rxPDO) found
+ * @param[in]  context    = context struct
+ * @param[in,out] cache   = object dictionary cache, see ec_ODcache_init(),
+ *                          NULL = read without cache
+ * @param[in]  Slave      = Slave number.
+ * @param[out] pODlist    = resulting Object Description list with descriptions.
+ * @return 1 if taken from cache, 0 if the cached list read failed, otherwise
+ * workcounter of ecx_readODlist().
+ */
+int ecx_readODlist_cached(ecx_contextt *context, ec_ODcachet *cache, uint16 Slave, ec_ODlistt *pODlist)
+{
+   ec_ODcachedevicet *dev;
+   uint32 needed;
+   int32 abortcode;
+   int i, wkc;
+
+   dev = NULL;
+   if (cache && !ecx_ODcache_usable(cache))
+   {
+      cache = NULL;
+   }
+   if (cache)
+   {
+      i = ecx_ODcache_find(context, cache, Slave);
+      if (i >= 0)
+      {
+         dev = &(cache->device[i]);
+         memcpy(pODlist, &(dev->ODlist), sizeof(ec_ODlistt));
+         pODlist->Slave = Slave;
+         if (dev->ODlistabort)
+         {
+            ecx_SDOinfoerror(context, Slave, 0, 0, dev->ODlistabort);
+            return 0;
+         }
+         for (i = 0; i < pODlist->Entries; i++)
+         {
+            if (dev->ODabort[i])
+            {
+               ecx_SDOinfoerror(context, Slave, pODlist->Index[i], 0, dev->ODabort[i]);
+            }
+         }
+         return 1;
+      }
+      if (cache->devices < EC_MAXODCACHE)
+      {
+         dev = &(cache->device[cache->devices]);
+      }
+   }
+   wkc = ecx_readODlist_abort(context, Slave, pODlist, &abortcode);
+   if (wkc <= 0)
+   {
+      /* slave does not support the list, do not ask the same device type again */
+      if (dev && abortcode)
+      {
+         ecx_ODcache_identity(context, dev, Slave);
+         dev->OEfirst = cache->OEentries;
+         dev->ODlistabort = abortcode;
+         memcpy(&(dev->ODlist), pODlist, sizeof(ec_ODlistt));
+         cache->devices++;
+      }
+      return wkc;
+   }
+   if (ecx_SDOinfo_pipeline(context, ECT_GET_OD_REQ, pODlist, NULL,
+          dev ? dev->ODabort : NULL) < pODlist->Entries)
+   {
+      return wkc; /* incomplete list is not cached */
+   }
+   if (dev)
+   {
+      needed = 0;
+      for (i = 0; i < pODlist->Entries; i++)
+      {
+         needed += (uint32)pODlist->MaxSub[i] + 1;
+      }
+      if ((cache->OEentries + needed) <= EC_MAXODCACHEOE)
+      {
+         (void)ecx_SDOinfo_pipeline(context, ECT_GET_OE_REQ, pODlist, &(cache->OE[cache->OEentries]), NULL);
+         ecx_ODcache_identity(context, dev, Slave);
+         dev->OEfirst = cache->OEentries;
+         dev->ODlistabort = 0;
+         memcpy(&(dev->ODlist), pODlist, sizeof(ec_ODlistt));
+         cache->OEentries += needed;
+         cache->devices++;
+      }
+   }
+
+   return wkc;
+}
+
+/** CoE read SDO service object entry, cached.
+ *
+ * Entries of a device type cached by ecx_readODlist_cached() are copied from
+ * the cache, other entries are read with ecx_readOEsingle(). Cached SDO
+ * information errors are reported to the error list without mailbox traffic.
+ *
+ * @param[in]  context       = context struct
+ * @param[in]  cache         = object dictionary cache, NULL = read without cache
+ * @param[in]  Item          = Item in ODlist.
+ * @param[in]  pODlist       = Object description list for reference.
+ * @param[out] pOElist       = resulting object entry structure.
+ * @return 1 if taken from cache, 0 if the last subindex has a cached error,
+ * otherwise workcounter of slave response.
+ */
+int ecx_readOE_cached(ecx_contextt *context, ec_ODcachet *cache, uint16 Item,
+   ec_ODlistt *pODlist, ec_OElistt *pOElist)
+{
+   ec_ODcachedevicet *dev;
+   ec_OEcacheentryt *e;
+   uint32 first;
+   int i, wkc;
+   uint16 SubI;
+
+   i = (cache && ecx_ODcache_usable(cache)) ? ecx_ODcache_find(context, cache, pODlist->Slave) : -1;
+   if ((i < 0) || cache->device[i].ODlistabort || (Item >= cache->device[i].ODlist.Entries) ||
+       (cache->device[i].ODlist.Index[Item] != pODlist->Index[Item]))
+   {
+      return ecx_readOE(context, Item, pODlist, pOElist);
+   }
+   dev = &(cache->device[i]);
+   first = dev->OEfirst;
+   for (i = 0; i < Item; i++)
+   {
+      first += (uint32)dev->ODlist.MaxSub[i] + 1;
+   }
+   wkc = 1;
+   pOElist->Entries = 0;
+   for (SubI = 0; SubI <= dev->ODlist.MaxSub[Item]; SubI++)
+   {
+      e = &(cache->OE[first + SubI]);
+      if (e->Valid == EC_ODCACHE_VALID)
+      {
+         pOElist->Entries++;
+         pOElist->ValueInfo[SubI] = e->ValueInfo;
+         pOElist->DataType[SubI] = e->DataType;
+         pOElist->BitLength[SubI] = e->BitLength;
+         pOElist->ObjAccess[SubI] = e->ObjAccess;
+         memcpy(pOElist->Name[SubI], e->Name, sizeof(e->Name));
+         wkc = 1;
+      }
+      else if (e->Valid == EC_ODCACHE_ERROR)
+      {
+         /* same result as ecx_readOEsingle() for a slave error */
+         ecx_SDOinfoerror(context, pODlist->Slave, pODlist->Index[Item], (uint8)SubI, e->AbortCode);
+         wkc = 0;
+      }
+      else
+      {
+         wkc = ecx_readOEsingle(context, Item, (uint8)SubI, pODlist, pOElist);
+      }
+   }
+
+   return wkc;
+}
+
+/** Build a CoE SDO request that fits in one mailbox.
+ *
+ * Read requests are normal upload requests, write requests are expedited
+ * for up to 4 bytes and normal downloads otherwise. Segmented transfers are
+ * not built here.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[out] SDOp       = mailbox to build the request in, cleared by caller
+ * @param[in]  index      = Index
+ * @param[in]  subindex   = Subindex, must be 0 or 1 if CA is used
+ * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access
+ * @param[in]  write      = FALSE = upload (read), TRUE = download (write)
+ * @param[in]  psize      = Size in bytes of parameter data to write
+ * @param[in]  p          = Parameter data to write
+ * @param[in]  cnt        = Mailbox counter value
+ * @return 1 if request is built, 0 if the data does not fit in one mailbox
+ */
+static int ecx_SDOrequest(ecx_contextt *context, uint16 slave, ec_SDOt *SDOp,
+   uint16 index, uint8 subindex, boolean CA, boolean write, int psize,
+   const void *p, uint8 cnt)
+{
+   int maxdata;
+
+   maxdata = context->slavelist[slave].mbx_l - 0x10; /* data section=mailbox size - 6 mbx - 2 CoE - 8 sdo req */
+   SDOp->MbxHeader.length = htoes(0x000a);
+   SDOp->MbxHeader.address = htoes(0x0000);
+   SDOp->MbxHeader.priority = 0x00;
+   SDOp->MbxHeader.mbxtype = ECT_MBXT_COE + MBX_HDR_SET_CNT(cnt); /* CoE */
+   SDOp->CANOpen = htoes(0x000 + (ECT_COES_SDOREQ << 12)); /* number 9bits service upper 4 bits (SDO request) */
+   SDOp->Index = htoes(index);
+   if (CA && (subindex > 1))
+   {
+      subindex = 1;
+   }
+   SDOp->SubIndex = subindex;
+   SDOp->ldata[0] = 0;
+   if (!write)
+   {
+      SDOp->Command = CA ? ECT_SDO_UP_REQ_CA : ECT_SDO_UP_REQ;
+   }
+   else if ((psize <= 4) && !CA)
+   {
+      SDOp->Command = ECT_SDO_DOWN_EXP | (((4 - psize) << 2) & 0x0c); /* expedited SDO download transfer */
+      memcpy(&SDOp->ldata[0], p, psize);
+   }
+   else
+   {
+      if (psize > maxdata)
+      {
+         return 0;
+      }
+      SDOp->MbxHeader.length = htoes((uint16)(0x0a + psize));
+      SDOp->Command = CA ? ECT_SDO_DOWN_INIT_CA : ECT_SDO_DOWN_INIT;
+      SDOp->ldata[0] = htoel(psize);
+      memcpy(&SDOp->ldata[1], p, psize);
+   }
+   return 1;
+}
+
+/** Check a CoE SDO response read from the slave mailbox.
+ *
+ * Mailbox errors, emergencies and messages of other protocols are handled
+ * with ecx_mbxhandlemsg(). Aborts and errors are pushed on the error list.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[in]  aSDOp      = mailbox read from slave
+ * @param[in]  index      = Index of request
+ * @param[in]  subindex   = Subindex of request
+ * @param[in]  write      = FALSE = upload (read), TRUE = download (write)
+ * @param[in,out] psize   = Size in bytes of parameter buffer, returns bytes read
+ * @param[out] p          = Parameter buffer for read data
+ * @param[out] abortcode  = SDO abort code, 0 if not aborted
+ * @return 1 on success, 0 on abort or error, -1 if the mailbox is no
+ * response to this request, -2 if the response is segmented
+ */
+static int ecx_SDOresponse(ecx_contextt *context, uint16 slave, ec_SDOt *aSDOp,
+   uint16 index, uint8 subindex, boolean write, int *psize, void *p, int32 *abortcode)
+{
+   uint16 bytesize, framedatasize;
+   int32 SDOlen;
+
+   *abortcode = 0;
+   if (ecx_mbxhandlemsg(context, slave, (ec_mbxbuft *)aSDOp))
+   {
+      /* mailbox error ends the request, emergencies are only reported */
+      return ((aSDOp->MbxHeader.mbxtype & 0x0f) == 0x00) ? 0 : -1;
+   }
+   if (((aSDOp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_COE) ||
+       (etohs(aSDOp->Index) != index))
+   {
+      return -1;
+   }
+   if (aSDOp->Command == ECT_SDO_ABORT) /* SDO abort frame received */
+   {
+      *abortcode = etohl(aSDOp->ldata[0]);
+      ecx_SDOerror(context, slave, index, subindex, *abortcode);
+      return 0;
+   }
+   if ((etohs(aSDOp->CANOpen) >> 12) != ECT_COES_SDORES)
+   {
+      return -1;
+   }
+   if (write)
+   {
+      return 1;
+   }
+   if ((aSDOp->Command & 0x02) > 0)
+   {
+      /* expedited frame response */
+      bytesize = 4 - ((aSDOp->Command >> 2) & 0x03);
+      if (*psize < bytesize)
+      {
+         ecx_packeterror(context, slave, index, subindex, 3); /*  data container too small for type */
+         return 0;
+      }
+      memcpy(p, &aSDOp->ldata[0], bytesize);
+      *psize = bytesize;
+      return 1;
+   }
+   /* normal frame response */
+   SDOlen = etohl(aSDOp->ldata[0]);
+   framedatasize = (etohs(aSDOp->MbxHeader.length) - 10);
+   if (SDOlen > *psize)
+   {
+      ecx_packeterror(context, slave, index, subindex, 3); /*  data container too small for type */
+      return 0;
+   }
+   if (framedatasize < SDOlen)
+   {
+      /* segmented response, only single mailbox transfers are handled here */
+      return -2;
+   }
+   memcpy(p, &aSDOp->ldata[1], SDOlen);
+   *psize = SDOlen;
+   return 1;
+}
+
+/* request i is the oldest one for its slave and no other request is active */
+static boolean ecx_SDOasync_isfirst(ec_SDOasynct *engine, int i)
+{
+   ec_SDOasyncreqt *req, *oreq;
+   uint32 ostate;
+   int j;
+
+   req = &(engine->req[i]);
+   for (j = 0; j < EC_MAXSDOASYNC; j++)
+   {
+      oreq = &(engine->req[j]);
+      /* fields of a slot are only valid once it is published */
+      ostate = osal_atomic_load(&(oreq->state));
+      if ((j == i) || (ostate < EC_SDOASYNC_QUEUED) || (ostate >= EC_SDOASYNC_DONE) ||
+          (oreq->slave != req->slave))
+      {
+         continue;
+      }
+      if ((ostate >= EC_SDOASYNC_SEND) || ((int32)(oreq->seq - req->seq) < 0))
+      {
+         return FALSE;
+      }
+   }
+   return TRUE;
+}
+
+/* finish request, report through callback and release slot if callback is set */
+static void ecx_SDOasync_finish(ecx_contextt *context, int i, int result)
+{
+   ec_SDOasyncreqt *req;
+
+   req = &(context->SDOasync->req[i]);
+   req->result = result;
+   req->txidx = -1;
+   if (result == EC_TIMEOUT)
+   {
+      ecx_packeterror(context, req->slave, req->index, req->subindex, 1);
+   }
+   if (!req->write && (result != 1))
+   {
+      req->psize = 0;
+   }
+   osal_atomic_store(&(req->state), EC_SDOASYNC_DONE);
+   if (req->callback)
+   {
+      req->callback(context, i, result, req->psize, req->abortcode);
+      osal_atomic_store(&(req->state), EC_SDOASYNC_FREE);
+   }
+}
+
+/* handle mailbox read from slave for request i, a message that is no
+ * response to it sets the request back to wait for the next one */
+static void ecx_SDOasync_response(ecx_contextt *context, int i, ec_SDOt *aSDOp)
+{
+   ec_SDOasyncreqt *req;
+   int rval;
+
+   req = &(context->SDOasync->req[i]);
+   rval = ecx_SDOresponse(context, req->slave, aSDOp, req->index, req->subindex,
+      req->write, &(req->psize), req->p, &(req->abortcode));
+   if (rval == -1)
+   {
+      osal_atomic_store(&(req->state), EC_SDOASYNC_WAIT); /* not our response, wait for next */
+   }
+   else if (rval == -2)
+   {
+      /* segmented transfer is not supported by the engine */
+      ecx_packeterror(context, req->slave, req->index, req->subindex, 1); /* Unexpected frame returned */
+      ecx_SDOasync_finish(context, i, EC_ERROR);
+   }
+   else
+   {
+      ecx_SDOasync_finish(context, i, (rval > 0) ? 1 : EC_ERROR);
+   }
+}
+
+static int ecx_SDOasync_submit(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+   boolean CA, boolean write, int psize, void *p, int timeout, ec_SDOasynccbt callback)
+{
+   ec_SDOasynct *engine;
+   ec_SDOasyncreqt *req;
+   uint32 seq;
+   int i;
+
+   engine = context->SDOasync;
+   if ((engine == NULL) || (slave < 1) || (slave > *(context->slavecount)) ||
+       !(context->slavelist[slave].mbx_proto & ECT_MBXPROT_COE) ||
+       (context->slavelist[slave].mbx_l == 0) || (context->slavelist[slave].mbx_l > EC_MAXMBX) ||
+       (context->slavelist[slave].mbx_rl == 0) || (context->slavelist[slave].mbx_rl > EC_MAXMBX))
+   {
+      return -1;
+   }
+   /* request must fit in one mailbox */
+   if (write && (CA || (psize > 4)) && (psize > (context->slavelist[slave].mbx_l - 0x10)))
+   {
+      return -1;
+   }
+   for (i = 0; i < EC_MAXSDOASYNC; i++)
+   {
+      req = &(engine->req[i]);
+      /* claim slot, it is ignored by the cyclic task until published */
+      if (osal_atomic_cas(&(req->state), EC_SDOASYNC_FREE, EC_SDOASYNC_CLAIMED))
+      {
+         req->slave = slave;
+         req->index = index;
+         req->subindex = subindex;
+         req->CA = CA;
+         req->write = write;
+         req->p = p;
+         req->psize = psize;
+         req->timeout = timeout;
+         do
+         {
+            seq = osal_atomic_load(&(engine->seq));
+         } while (!osal_atomic_cas(&(engine->seq), seq, seq + 1));
+         req->seq = seq;
+         req->txidx = -1;
+         req->result = 0;
+         req->abortcode = 0;
+         req->callback = callback;
+         /* publish request, all fields above are visible to the cyclic task */
+         osal_atomic_store(&(req->state), EC_SDOASYNC_QUEUED);
+         return i;
+      }
+   }
+   return -1;
+}
+
+/** Submit asynchronous CoE SDO read. Single subindex or Complete Access.
+ *
+ * The request is advanced by the process data send and receive functions,
+ * no extra frames are used. Requests to one slave are handled in submission
+ * order, requests to different slaves in parallel. The response must fit in
+ * one mailbox, segmented uploads are not supported. Do not mix with blocking
+ * mailbox functions for the same slave while requests are pending.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[in]  index      = Index to read
+ * @param[in]  subindex   = Subindex to read, must be 0 or 1 if CA is used.
+ * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes read.
+ * @param[in]  psize      = Size in bytes of parameter buffer.
+ * @param[out] p          = Pointer to parameter buffer, must stay valid until finished
+ * @param[in]  timeout    = Timeout in us from start of transfer, standard is EC_TIMEOUTRXM
+ * @param[in]  callback   = Completion callback, NULL = use ecx_SDOasync_poll()
+ * @return handle of request, -1 if no slot is free or the slave has no CoE
+ */
+int ecx_SDOasync_read(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                      boolean CA, int psize, void *p, int timeout, ec_SDOasynccbt callback)
+{
+   return ecx_SDOasync_submit(context, slave, index, subindex, CA, FALSE, psize, p,
+      timeout, callback);
+}
+
+/** Submit asynchronous CoE SDO write. Single subindex or Complete Access.
+ *
+ * See ecx_SDOasync_read(). The parameter data must fit in one mailbox,
+ * segmented downloads are not supported.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[in]  index      = Index to write
+ * @param[in]  subindex   = Subindex to write, must be 0 or 1 if CA is used.
+ * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes written.
+ * @param[in]  psize      = Size in bytes of parameter buffer.
+ * @param[in]  p          = Pointer to parameter buffer, must stay valid until finished
+ * @param[in]  timeout    = Timeout in us from start of transfer, standard is EC_TIMEOUTRXM
+ * @param[in]  callback   = Completion callback, NULL = use ecx_SDOasync_poll()
+ * @return handle of request, -1 if no slot is free or the data does not fit
+ */
+int ecx_SDOasync_write(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                       boolean CA, int psize, const void *p, int timeout, ec_SDOasynccbt callback)
+{
+   return ecx_SDOasync_submit(context, slave, index, subindex, CA, TRUE, psize, (void *)p,
+      timeout, callback);
+}
+
+/** Poll asynchronous SDO request submitted without callback.
+ * A finished request is released by this call.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  handle     = handle returned by submit
+ * @param[out] psize      = bytes read, may be NULL
+ * @param[out] abortcode  = SDO abort code, may be NULL
+ * @return 0 while busy, 1 on success, EC_ERROR on abort or error, EC_TIMEOUT
+ */
+int ecx_SDOasync_poll(ecx_contextt *context, int handle, int *psize, int32 *abortcode)
+{
+   ec_SDOasyncreqt *req;
+   uint32 state;
+   int result;
+
+   if ((context->SDOasync == NULL) || (handle < 0) || (handle >= EC_MAXSDOASYNC))
+   {
+      return EC_ERROR;
+   }
+   req = &(context->SDOasync->req[handle]);
+   state = osal_atomic_load(&(req->state));
+   if ((state == EC_SDOASYNC_FREE) || (state == EC_SDOASYNC_CLAIMED))
+   {
+      return EC_ERROR;
+   }
+   if (state != EC_SDOASYNC_DONE)
+   {
+      return 0;
+   }
+   if (psize)
+   {
+      *psize = req->psize;
+   }
+   if (abortcode)
+   {
+      *abortcode = req->abortcode;
+   }
+   result = req->result;
+   osal_atomic_store(&(req->state), EC_SDOASYNC_FREE);
+   return result;
+}
+
+/** Add mailbox datagrams of active asynchronous SDO requests to a frame.
+ * Called by the process data send function for each frame, before transmit.
+ * Each active request adds one datagram while the frame has room.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  idx        = index of frame being built
+ */
+void ecx_SDOasync_tx(ecx_contextt *context, uint8 idx)
+{
+   ec_SDOasynct *engine;
+   ec_SDOasyncreqt *req;
+   ec_slavet *slavep;
+   ecx_portt *port;
+   int i, k;
+   uint32 state;
+   uint8 com;
+   uint16 ADO, length, smstat;
+   void *data;
+
+   engine = context->SDOasync;
+   if (engine == NULL)
+   {
+      return;
+   }
+   port = context->port;
+   for (k = 0; k < EC_MAXSDOASYNC; k++)
+   {
+      i = (engine->next + k) % EC_MAXSDOASYNC;
+      req = &(engine->req[i]);
+      /* acquire, pairs with the release store of submit */
+      state = osal_atomic_load(&(req->state));
+      if ((state == EC_SDOASYNC_QUEUED) && ecx_SDOasync_isfirst(engine, i))
+      {
+         req->cnt = ec_nextmbxcnt(context->slavelist[req->slave].mbx_cnt);
+         context->slavelist[req->slave].mbx_cnt = req->cnt;
+         osal_timer_start(&(req->timer), req->timeout);
+         state = EC_SDOASYNC_SEND;
+         osal_atomic_store(&(req->state), state);
+      }
+      if ((state < EC_SDOASYNC_SEND) || (state >= EC_SDOASYNC_DONE) || (req->txidx >= 0))
+      {
+         continue;
+      }
+      if (osal_timer_is_expired(&(req->timer)))
+      {
+         ecx_SDOasync_finish(context, i, EC_TIMEOUT);
+         continue;
+      }
+      /* the EoE gateway may have read the response already */
+      if ((state >= EC_SDOASYNC_WAIT) && (state <= EC_SDOASYNC_REPEAT) &&
+          ecx_mbxunpark(context, req->slave, &(engine->mbx)))
+      {
+         ecx_SDOasync_response(context, i, (ec_SDOt *)&(engine->mbx));
+         continue;
+      }
+      slavep = &(context->slavelist[req->slave]);
+      data = NULL;
+      switch (state)
+      {
+         case EC_SDOASYNC_SEND:
+            /* write request, slave does not accept it while its mailbox is full */
+            com = EC_CMD_FPWR;
+            ADO = slavep->mbx_wo;
+            length = slavep->mbx_l;
+            break;
+         case EC_SDOASYNC_WAIT:
+            /* poll mailbox full flag, keep activate register for a repeat */
+            com = EC_CMD_FPRD;
+            ADO = ECT_REG_SM1STAT;
+            length = sizeof(smstat);
+            break;
+         case EC_SDOASYNC_READ:
+            com = EC_CMD_FPRD;
+            ADO = slavep->mbx_ro;
+            length = slavep->mbx_rl;
+            break;
+         case EC_SDOASYNC_REPEAT:
+            /* toggle repeat request, slave puts last response back in mailbox */
+            smstat = htoes(req->smstat ^ 0x0200);
+            com = EC_CMD_FPWR;
+            ADO = ECT_REG_SM1STAT;
+            length = sizeof(smstat);
+            data = &smstat;
+            break;
+         default:
+            /* poll repeat acknowledge */
+            com = EC_CMD_FPRD;
+            ADO = ECT_REG_SM1CONTR;
+            length = 1;
+            break;
+      }
+      if ((port->txbuflength[idx] + EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + length) >
+          (int)(ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + EC_MAXLRWDATA))
+      {
+         continue; /* no room, try smaller datagrams */
+      }
+      if (state == EC_SDOASYNC_SEND)
+      {
+         memset(&(engine->mbx), 0, length);
+         (void)ecx_SDOrequest(context, req->slave, (ec_SDOt *)&(engine->mbx), req->index,
+            req->subindex, req->CA, req->write, req->psize, req->p, req->cnt);
+         data = &(engine->mbx);
+      }
+      ecx_appenddatagram(port, idx);
+      req->txoffset = ecx_adddatagram(port, &(port->txbuf[idx]), com, idx, FALSE,
+         slavep->configadr, ADO, length, data);
+      req->txlength = length;
+      req->txidx = idx;
+   }
+   engine->next = (engine->next + 1) % EC_MAXSDOASYNC;
+}
+
+/** Process mailbox datagrams of asynchronous SDO requests in a received frame.
+ * Called by the process data receive function for each frame, before the
+ * frame buffer is released.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  idx        = index of received frame
+ * @param[in]  wkc        = result of frame receive, EC_NOFRAME if lost
+ */
+void ecx_SDOasync_rx(ecx_contextt *context, uint8 idx, int wkc)
+{
+   ec_SDOasynct *engine;
+   ec_SDOasyncreqt *req;
+   uint8 *rxp;
+   uint32 state;
+   int i, dwkc;
+
+   engine = context->SDOasync;
+   if (engine == NULL)
+   {
+      return;
+   }
+   for (i = 0; i < EC_MAXSDOASYNC; i++)
+   {
+      req = &(engine->req[i]);
+      /* acquire, pairs with the release stores of tx and submit */
+      state = osal_atomic_load(&(req->state));
+      if ((req->txidx != idx) || (state < EC_SDOASYNC_SEND) || (state >= EC_SDOASYNC_DONE))
+      {
+         continue;
+      }
+      req->txidx = -1;
+      dwkc = 0;
+      rxp = NULL;
+      if (wkc > EC_NOFRAME)
+      {
+         rxp = &(context->port->rxbuf[idx][req->txoffset]);
+         dwkc = rxp[req->txlength] + ((int)rxp[req->txlength + 1] << 8);
+      }
+      if (dwkc != 1)
+      {
+         /* a lost response may already be removed from the slave mailbox,
+            request a repeat instead of waiting for the timeout. Other steps
+            are simply repeated. */
+         if (state == EC_SDOASYNC_READ)
+         {
+            osal_atomic_store(&(req->state), EC_SDOASYNC_REPEAT);
+         }
+         continue;
+      }
+      switch (state)
+      {
+         case EC_SDOASYNC_SEND:
+            osal_atomic_store(&(req->state), EC_SDOASYNC_WAIT);
+            break;
+         case EC_SDOASYNC_WAIT:
+            req->smstat = rxp[0] + ((uint16)rxp[1] << 8);
+            if (rxp[0] & 0x08) /* mailbox full */
+            {
+               osal_atomic_store(&(req->state), EC_SDOASYNC_READ);
+            }
+            break;
+         case EC_SDOASYNC_REPEAT:
+            req->smstat ^= 0x0200;
+            osal_atomic_store(&(req->state), EC_SDOASYNC_REPEATACK);
+            break;
+         case EC_SDOASYNC_REPEATACK:
+            if ((rxp[0] & 0x02) == (HI_BYTE(req->smstat) & 0x02))
+            {
+               osal_atomic_store(&(req->state), EC_SDOASYNC_WAIT); /* response is back in mailbox */
+            }
+            break;
+         default:
+            ecx_SDOasync_response(context, i, (ec_SDOt *)rxp);
+            break;
+      }
+   }
+}
+
+/** marker for batch entries that are not finished yet */
+#define EC_SDOBATCH_PENDING   (-100)
+
+/** transfer steps of a batch entry within one round */
+enum
+{
+   EC_SDOBATCH_SEND = 1,
+   EC_SDOBATCH_WAIT,
+   EC_SDOBATCH_READ,
+   EC_SDOBATCH_DONE,
+   EC_SDOBATCH_BLOCKING
+};
+
+/* read SM1 status of all entries in step which, entries with a full send
+ * mailbox move to step READ. Returns TRUE if any mailbox is full. */
+static boolean ecx_SDObatch_poll(ecx_contextt *context, ec_SDObatcht *list,
+   const int *sel, uint8 *step, int m, uint8 which)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   uint8 stat[EC_MAXMDATAGRAM];
+   int ent[EC_MAXMDATAGRAM];
+   int k, nd;
+   boolean full = FALSE;
+
+   nd = 0;
+   for (k = 0; k < m; k++)
+   {
+      if (step[k] == which)
+      {
+         stat[nd] = 0;
+         dg[nd].com = EC_CMD_FPRD;
+         dg[nd].ADP = context->slavelist[list[sel[k]].slave].configadr;
+         dg[nd].ADO = ECT_REG_SM1STAT;
+         dg[nd].length = sizeof(stat[nd]);
+         dg[nd].data = &stat[nd];
+         ent[nd++] = k;
+      }
+   }
+   if (nd == 0)
+   {
+      return FALSE;
+   }
+   (void)ecx_multidatagram(context->port, dg, nd, EC_TIMEOUTRET);
+   for (k = 0; k < nd; k++)
+   {
+      if ((dg[k].wkc == 1) && (stat[k] & 0x08))
+      {
+         step[ent[k]] = EC_SDOBATCH_READ;
+         full = TRUE;
+      }
+   }
+   return full;
+}
+
+/* write request mailboxes (step SEND) or read response mailboxes (step READ)
+ * of all entries, as many per frame as fit. Responses are checked when parse
+ * is set, otherwise they are only passed to ecx_mbxhandlemsg(). */
+static void ecx_SDObatch_mbx(ecx_contextt *context, ec_SDObatcht *list,
+   const int *sel, uint8 *step, int m, uint8 which, boolean parse)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   uint8 buf[EC_MAXLRWDATA];
+   int ent[EC_MAXMDATAGRAM];
+   ec_slavet *slavep;
+   ec_SDObatcht *e;
+   int k, d, nd, used, rval;
+   uint16 length;
+
+   k = 0;
+   while (k < m)
+   {
+      nd = 0;
+      used = 0;
+      for (; k < m; k++)
+      {
+         if (step[k] != which)
+         {
+            continue;
+         }
+         e = &list[sel[k]];
+         slavep = &(context->slavelist[e->slave]);
+         length = (which == EC_SDOBATCH_SEND) ? slavep->mbx_l : slavep->mbx_rl;
+         if ((nd > 0) && ((used + length + EC_HEADERSIZE + EC_WKCSIZE) > EC_MAXLRWDATA))
+         {
+            break; /* frame is full */
+         }
+         if (which == EC_SDOBATCH_SEND)
+         {
+            memset(&buf[used], 0, length);
+            slavep->mbx_cnt = ec_nextmbxcnt(slavep->mbx_cnt);
+            (void)ecx_SDOrequest(context, e->slave, (ec_SDOt *)&buf[used], e->index,
+               e->subindex, e->CA, e->write, e->psize, e->p, slavep->mbx_cnt);
+            dg[nd].com = EC_CMD_FPWR;
+            dg[nd].ADO = slavep->mbx_wo;
+         }
+         else
+         {
+            dg[nd].com = EC_CMD_FPRD;
+            dg[nd].ADO = slavep->mbx_ro;
+         }
+         dg[nd].ADP = slavep->configadr;
+         dg[nd].length = length;
+         dg[nd].data = &buf[used];
+         ent[nd++] = k;
+         used += length + EC_HEADERSIZE + EC_WKCSIZE;
+      }
+      if (nd == 0)
+      {
+         break;
+      }
+      (void)ecx_multidatagram(context->port, dg, nd, EC_TIMEOUTRET3);
+      for (d = 0; d < nd; d++)
+      {
+         e = &list[sel[ent[d]]];
+         if (which == EC_SDOBATCH_SEND)
+         {
+            /* slave does not accept the request while its mailbox is full, retry */
+            if (dg[d].wkc == 1)
+            {
+               step[ent[d]] = EC_SDOBATCH_WAIT;
+            }
+         }
+         else if (dg[d].wkc != 1)
+         {
+            step[ent[d]] = parse ? EC_SDOBATCH_WAIT : EC_SDOBATCH_SEND;
+         }
+         else if (!parse)
+         {
+            /* old message in send mailbox, discard */
+            (void)ecx_mbxhandlemsg(context, e->slave, (ec_mbxbuft *)dg[d].data);
+            step[ent[d]] = EC_SDOBATCH_SEND;
+         }
+         else
+         {
+            rval = ecx_SDOresponse(context, e->slave, (ec_SDOt *)dg[d].data, e->index,
+               e->subindex, e->write, &(e->psize), e->p, &(e->abortcode));
+            if (rval == -1)
+            {
+               step[ent[d]] = EC_SDOBATCH_WAIT; /* not our response, wait for next */
+            }
+            else if (rval == -2)
+            {
+               step[ent[d]] = EC_SDOBATCH_BLOCKING; /* segmented, redo with blocking read */
+            }
+            else
+            {
+               e->wkc = rval;
+               step[ent[d]] = EC_SDOBATCH_DONE;
+            }
+         }
+      }
+   }
+}
+
+/* run one round, at most one entry per slave */
+static void ecx_SDObatch_round(ecx_contextt *context, ec_SDObatcht *list,
+   const int *sel, int m, int timeout)
+{
+   uint8 step[EC_MAXMDATAGRAM];
+   ec_SDObatcht *e;
+   osal_timert timer;
+   int k, busy;
+
+   for (k = 0; k < m; k++)
+   {
+      e = &list[sel[k]];
+      step[k] = EC_SDOBATCH_SEND;
+      /* only transfers that fit in one mailbox are batched */
+      if (e->write && (e->CA || (e->psize > 4)) &&
+          (e->psize > (context->slavelist[e->slave].mbx_l - 0x10)))
+      {
+         step[k] = EC_SDOBATCH_BLOCKING;
+      }
+   }
+   /* empty send mailboxes of slaves, like the blocking SDO functions do */
+   if (ecx_SDObatch_poll(context, list, sel, step, m, EC_SDOBATCH_SEND))
+   {
+      ecx_SDObatch_mbx(context, list, sel, step, m, EC_SDOBATCH_READ, FALSE);
+   }
+   osal_timer_start(&timer, timeout);
+   do
+   {
+      ecx_SDObatch_mbx(context, list, sel, step, m, EC_SDOBATCH_SEND, TRUE);
+      if (ecx_SDObatch_poll(context, list, sel, step, m, EC_SDOBATCH_WAIT))
+      {
+         ecx_SDObatch_mbx(context, list, sel, step, m, EC_SDOBATCH_READ, TRUE);
+      }
+      busy = 0;
+      for (k = 0; k < m; k++)
+      {
+         if ((step[k] >= EC_SDOBATCH_SEND) && (step[k] <= EC_SDOBATCH_READ))
+         {
+            busy++;
+         }
+      }
+      if (busy && (timeout > EC_LOCALDELAY))
+      {
+         osal_usleep(EC_LOCALDELAY);
+      }
+   }
+   while (busy && (osal_timer_is_expired(&timer) == FALSE));
+
+   for (k = 0; k < m; k++)
+   {
+      e = &list[sel[k]];
+      switch (step[k])
+      {
+         case EC_SDOBATCH_SEND:
+            e->wkc = 0; /* request not accepted by slave */
+            break;
+         case EC_SDOBATCH_WAIT:
+         case EC_SDOBATCH_READ:
+            e->wkc = EC_TIMEOUT;
+            break;
+         case EC_SDOBATCH_BLOCKING:
+            if (e->write)
+            {
+               e->wkc = ecx_SDOwrite(context, e->slave, e->index, e->subindex, e->CA,
+                  e->psize, e->p, timeout);
+            }
+            else
+            {
+               e->wkc = ecx_SDOread(context, e->slave, e->index, e->subindex, e->CA,
+                  &(e->psize), e->p, timeout);
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+/** CoE SDO transfers to many slaves at once, blocking.
+ *
+ * Transfers to different slaves run concurrently: the request mailboxes of
+ * all slaves are written with FPWR datagrams packed in as few frames as
+ * possible, the SM1 status of all slaves is polled in one frame and the
+ * responses are read the same way. Transfers to the same slave are done in
+ * list order, one per round. Transfers that do not fit in one mailbox fall
+ * back to ecx_SDOread() and ecx_SDOwrite().
+ *
+ * @param[in]  context    = context struct
+ * @param[in,out] list    = transfers, wkc, psize of reads and abortcode are
+ *                          set per entry
+ * @param[in]  n          = number of entries in list
+ * @param[in]  timeout    = Timeout in us per round, standard is EC_TIMEOUTRXM
+ * @return number of successful transfers
+ */
+int ecx_SDObatch(ecx_contextt *context, ec_SDObatcht *list, int n, int timeout)
+{
+   int sel[EC_MAXMDATAGRAM];
+   int i, j, m, success;
+   ec_slavet *slavep;
+
+   for (i = 0; i < n; i++)
+   {
+      list[i].abortcode = 0;
+      list[i].wkc = EC_SDOBATCH_PENDING;
+      if ((list[i].slave < 1) || (list[i].slave > *(context->slavecount)))
+      {
+         list[i].wkc = 0;
+         continue;
+      }
+      slavep = &(context->slavelist[list[i].slave]);
+      if (!(slavep->mbx_proto & ECT_MBXPROT_COE) ||
+          (slavep->mbx_l == 0) || (slavep->mbx_l > EC_MAXMBX) ||
+          (slavep->mbx_rl == 0) || (slavep->mbx_rl > EC_MAXMBX))
+      {
+         list[i].wkc = 0;
+      }
+   }
+   do
+   {
+      /* first pending entry of each slave */
+      m = 0;
+      for (i = 0; (i < n) && (m < EC_MAXMDATAGRAM); i++)
+      {
+         if (list[i].wkc != EC_SDOBATCH_PENDING)
+         {
+            continue;
+         }
+         for (j = 0; j < i; j++)
+         {
+            if ((list[j].wkc == EC_SDOBATCH_PENDING) && (list[j].slave == list[i].slave))
+            {
+               break;
+            }
+         }
+         if (j == i)
+         {
+            sel[m++] = i;
+         }
+      }
+      if (m > 0)
+      {
+         ecx_SDObatch_round(context, list, sel, m, timeout);
+      }
+   }
+   while (m > 0);
+
+   success = 0;
+   for (i = 0; i < n; i++)
+   {
+      if (list[i].wkc > 0)
+      {
+         success++;
+      }
+   }
+   return success;
+}
+
+#ifdef EC_VER1
+/** Report SDO error.
+ *
+ * @param[in]  Slave      = Slave number
+ * @param[in]  Index      = Index that generated error
+ * @param[in]  SubIdx     = Subindex that generated error
+ * @param[in]  AbortCode  = Abortcode, see EtherCAT documentation for list
+ * @see ecx_SDOerror
+ */
+void ec_SDOerror(uint16 Slave, uint16 Index, uint8 SubIdx, int32 AbortCode)
+{
+   ecx_SDOerror(&ecx_context, Slave, Index, SubIdx, AbortCode);
+}
+
+/** CoE SDO read, blocking. Single subindex or Complete Access.
+ *
+ * Only a "normal" upload request is issued. If the requested parameter is <= 4bytes
+ * then a "expedited" response is returned, otherwise a "normal" response. If a "normal"
+ * response is larger than the mailbox size then the response is segmented. The function
+ * will combine all segments and copy them to the parameter buffer.
+ *
+ * @param[in]  slave      = Slave number
+ * @param[in]  index      = Index to read
+ * @param[in]  subindex   = Subindex to read, must be 0 or 1 if CA is used.
+ * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes read.
+ * @param[in,out] psize   = Size in bytes of parameter buffer, returns bytes read from SDO.
+ * @param[out] p          = Pointer to parameter buffer
+ * @param[in]  timeout    = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ * @see ecx_SDOread
+ */
+int ec_SDOread(uint16 slave, uint16 index, uint8 subindex,
+               boolean CA, int *psize, void *p, int timeout)
+{
+   return ecx_SDOread(&ecx_context, slave, index, subindex, CA, psize, p, timeout);
+}
+
+/** CoE SDO write, blocking. Single subindex or Complete Access.
+ *
+ * A "normal" download request is issued, unless we have
+ * small data, then a "expedited" transfer is used. If the parameter is larger than
+ * the mailbox size then the download is segmented. The function will split the
+ * parameter data in segments and send them to the slave one by one.
+ *
+ * @param[in]  Slave      = Slave number
+ * @param[in]  Index      = Index to write
+ * @param[in]  SubIndex   = Subindex to write, must be 0 or 1 if CA is used.
+ * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes written.
+ * @param[in]  psize      = Size in bytes of parameter buffer.
+ * @param[out] p          = Pointer to parameter buffer
+ * @param[in]  Timeout    = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ * @see ecx_SDOwrite
+ */
+int ec_SDOwrite(uint16 Slave, uint16 Index, uint8 SubIndex,
+                boolean CA, int psize, const void *p, int Timeout)
+{
+   return ecx_SDOwrite(&ecx_context, Slave, Index, SubIndex, CA, psize, p, Timeout);
+}
+
+/** CoE RxPDO write, blocking.
+ *
+ * A RxPDO download request is issued.
+ *
+ * @param[in]  Slave         = Slave number
+ * @param[in]  RxPDOnumber   = Related RxPDO number
+ * @param[in]  psize         = Size in bytes of PDO buffer.
+ * @param[out] p             = Pointer to PDO buffer
+ * @return Workcounter from last slave response
+ * @see ecx_RxPDO
+ */
+int ec_RxPDO(uint16 Slave, uint16 RxPDOnumber, int psize, const void *p)
+{
+   return ecx_RxPDO(&ecx_context, Slave, RxPDOnumber, psize, p);
+}
+
+/** CoE TxPDO read remote request, blocking.
+ *
+ * A TxPDO download request is issued.
+ *
+ * @param[in]  slave         = Slave number
+ * @param[in]  TxPDOnumber   = Related TxPDO number
+ * @param[in,out] psize      = Size in bytes of PDO buffer, returns bytes read from PDO.
+ * @param[out] p             = Pointer to PDO buffer
+ * @param[in]  timeout       = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ * @see ecx_TxPDO
+ */
+int ec_TxPDO(uint16 slave, uint16 TxPDOnumber , int *psize, void *p, int timeout)
+{
+   return ecx_TxPDO(&ecx_context, slave, TxPDOnumber, psize, p, timeout);
+}
+
+/** Read PDO assign structure
+ * @param[in]  Slave         = Slave number
+ * @param[in]  PDOassign     = PDO assign object
+ * @return total bitlength of PDO assign
+ */
+uint32 ec_readPDOassign(uint16 Slave, uint16 PDOassign)
+{
+   return ecx_readPDOassign(&ecx_context, Slave, PDOassign);
+}
+
+/** Read PDO assign structure in Complete Access mode
+ * @param[in]  Slave         = Slave number
+ * @param[in]  PDOassign     = PDO assign object
+ * @param[in]  Thread_n      = Calling thread index
+ * @return total bitlength of PDO assign
+ * @see ecx_readPDOmap
+ */
+uint32 ec_readPDOassignCA(uint16 Slave, uint16 PDOassign, int Thread_n)
+{
+   return ecx_readPDOassignCA(&ecx_context, Slave, Thread_n, PDOassign);
+}
+
+/** CoE read PDO mapping.
+ *
+ * CANopen has standard indexes defined for PDO mapping. This function
+ * tries to read them and collect a full input and output mapping size
+ * of designated slave.
+ *
+ * For details, see #ecx_readPDOmap
+ *
+ * @param[in] Slave    = Slave number
+ * @param[out] Osize   = Size in bits of output mapping (rxPDO) found
  * @param[out] Isize   = Size in bits of input mapping (txPDO) found
  * @return >0 if mapping succesful.
  */
@@ -1502,4 +2918,96 @@ int ec_readOE(uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist)
 {
    return ecx_readOE(&ecx_context, Item, pODlist, pOElist);
 }
+
+/** Submit asynchronous CoE SDO read.
+ *
+ * @param[in]  slave      = Slave number
+ * @param[in]  index      = Index to read
+ * @param[in]  subindex   = Subindex to read, must be 0 or 1 if CA is used.
+ * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes read.
+ * @param[in]  psize      = Size in bytes of parameter buffer.
+ * @param[out] p          = Pointer to parameter buffer, must stay valid until finished
+ * @param[in]  timeout    = Timeout in us from start of transfer, standard is EC_TIMEOUTRXM
+ * @param[in]  callback   = Completion callback, NULL = use ec_SDOasync_poll()
+ * @return handle of request, -1 if no slot is free or the slave has no CoE
+ * @see ecx_SDOasync_read
+ */
+int ec_SDOasync_read(uint16 slave, uint16 index, uint8 subindex, boolean CA,
+                     int psize, void *p, int timeout, ec_SDOasynccbt callback)
+{
+   return ecx_SDOasync_read(&ecx_context, slave, index, subindex, CA, psize, p, timeout, callback);
+}
+
+/** Submit asynchronous CoE SDO write.
+ *
+ * @param[in]  slave      = Slave number
+ * @param[in]  index      = Index to write
+ * @param[in]  subindex   = Subindex to write, must be 0 or 1 if CA is used.
+ * @param[in]  CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes written.
+ * @param[in]  psize      = Size in bytes of parameter buffer.
+ * @param[in]  p          = Pointer to parameter buffer, must stay valid until finished
+ * @param[in]  timeout    = Timeout in us from start of transfer, standard is EC_TIMEOUTRXM
+ * @param[in]  callback   = Completion callback, NULL = use ec_SDOasync_poll()
+ * @return handle of request, -1 if no slot is free or the data does not fit
+ * @see ecx_SDOasync_write
+ */
+int ec_SDOasync_write(uint16 slave, uint16 index, uint8 subindex, boolean CA,
+                      int psize, const void *p, int timeout, ec_SDOasynccbt callback)
+{
+   return ecx_SDOasync_write(&ecx_context, slave, index, subindex, CA, psize, p, timeout, callback);
+}
+
+/** Poll asynchronous SDO request submitted without callback.
+ *
+ * @param[in]  handle     = handle returned by submit
+ * @param[out] psize      = bytes read, may be NULL
+ * @param[out] abortcode  = SDO abort code, may be NULL
+ * @return 0 while busy, 1 on success, EC_ERROR on abort or error, EC_TIMEOUT
+ * @see ecx_SDOasync_poll
+ */
+int ec_SDOasync_poll(int handle, int *psize, int32 *abortcode)
+{
+   return ecx_SDOasync_poll(&ecx_context, handle, psize, abortcode);
+}
+
+/** CoE SDO transfers to many slaves at once, blocking.
+ *
+ * @param[in,out] list    = transfers, wkc, psize of reads and abortcode are
+ *                          set per entry
+ * @param[in]  n          = number of entries in list
+ * @param[in]  timeout    = Timeout in us per round, standard is EC_TIMEOUTRXM
+ * @return number of successful transfers
+ * @see ecx_SDObatch
+ */
+int ec_SDObatch(ec_SDObatcht *list, int n, int timeout)
+{
+   return ecx_SDObatch(&ecx_context, list, n, timeout);
+}
+
+/** CoE read Object Dictionary list with object descriptions, cached.
+ *
+ * @param[in,out] cache   = object dictionary cache, NULL = read without cache
+ * @param[in]  Slave      = Slave number.
+ * @param[out] pODlist    = resulting Object Description list with descriptions.
+ * @return 1 if taken from cache, otherwise workcounter of ecx_readODlist().
+ * @see ecx_readODlist_cached
+ */
+int ec_readODlist_cached(ec_ODcachet *cache, uint16 Slave, ec_ODlistt *pODlist)
+{
+   return ecx_readODlist_cached(&ecx_context, cache, Slave, pODlist);
+}
+
+/** CoE read SDO service object entry, cached.
+ *
+ * @param[in]  cache         = object dictionary cache, NULL = read without cache
+ * @param[in]  Item          = Item in ODlist.
+ * @param[in]  pODlist       = Object description list for reference.
+ * @param[out] pOElist       = resulting object entry structure.
+ * @return 1 if taken from cache, otherwise workcounter of slave response.
+ * @see ecx_readOE_cached
+ */
+int ec_readOE_cached(ec_ODcachet *cache, uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist)
+{
+   return ecx_readOE_cached(&ecx_context, cache, Item, pODlist, pOElist);
+}
 #endif
@@ -58,6 +58,184 @@ typedef struct
    char   Name[EC_MAXOELIST][EC_MAXNAME+1];
 } ec_OElistt;
 
+/** max. number of pending asynchronous SDO requests */
+#define EC_MAXSDOASYNC 64
+
+/** state of asynchronous SDO request */
+typedef enum
+{
+   /** slot is unused */
+   EC_SDOASYNC_FREE = 0,
+   /** slot claimed by submit, request is being filled in */
+   EC_SDOASYNC_CLAIMED,
+   /** waiting for earlier requests to the same slave */
+   EC_SDOASYNC_QUEUED,
+   /** write request to slave receive mailbox */
+   EC_SDOASYNC_SEND,
+   /** poll slave send mailbox status */
+   EC_SDOASYNC_WAIT,
+   /** read response from slave send mailbox */
+   EC_SDOASYNC_READ,
+   /** response lost, toggle repeat request of slave send mailbox */
+   EC_SDOASYNC_REPEAT,
+   /** wait for repeat acknowledge of slave */
+   EC_SDOASYNC_REPEATACK,
+   /** finished, result available */
+   EC_SDOASYNC_DONE
+} ec_SDOasyncstatet;
+
+/** completion callback of asynchronous SDO request, called from the thread
+ * that receives the process data. The request slot is released after return.
+ * result is 1 on success, EC_ERROR on abort or protocol error and EC_TIMEOUT
+ * on timeout. size is the number of bytes read. */
+typedef void (*ec_SDOasynccbt)(ecx_contextt *context, int handle, int result,
+   int size, int32 abortcode);
+
+/** asynchronous SDO request */
+typedef struct
+{
+   /** request state ec_SDOasyncstatet, the slot is claimed by compare and
+    * swap and the request is published by a release store of this field */
+   uint32  state;
+   uint16  slave;
+   uint16  index;
+   uint8   subindex;
+   boolean CA;
+   boolean write;
+   /** mailbox counter of request */
+   uint8   cnt;
+   /** last read SM1 status and activate register, host order */
+   uint16  smstat;
+   /** parameter buffer */
+   uint8   *p;
+   /** size of parameter buffer, bytes read when a read is finished */
+   int     psize;
+   /** timeout in us, started when the request becomes active */
+   int     timeout;
+   osal_timert timer;
+   /** submission order */
+   uint32  seq;
+   /** frame index the request is transmitted in, -1 = none */
+   int     txidx;
+   /** offset of datagram data in received frame */
+   uint16  txoffset;
+   /** datagram data length */
+   uint16  txlength;
+   /** 1 = success, EC_ERROR or EC_TIMEOUT */
+   int     result;
+   /** SDO abort code if aborted by slave */
+   int32   abortcode;
+   /** completion callback, NULL = result is fetched with ecx_SDOasync_poll */
+   ec_SDOasynccbt callback;
+} ec_SDOasyncreqt;
+
+/** asynchronous SDO engine. Requests are advanced by datagrams added to the
+ * process data frames, one mailbox step per request and cycle. Requests to
+ * the same slave are handled in submission order, requests to different
+ * slaves in parallel. Only expedited and normal transfers that fit in one
+ * mailbox are supported. */
+struct ec_SDOasync
+{
+   ec_SDOasyncreqt req[EC_MAXSDOASYNC];
+   /** submission counter */
+   uint32  seq;
+   /** first request to serve in next frame, rotates for fairness */
+   int     next;
+   /** mailbox build buffer */
+   ec_mbxbuft mbx;
+};
+
+/** one transfer of ecx_SDObatch() */
+typedef struct
+{
+   /** slave number */
+   uint16  slave;
+   /** index to read or write */
+   uint16  index;
+   /** subindex, must be 0 or 1 if CA is used */
+   uint8   subindex;
+   /** FALSE = single subindex. TRUE = Complete Access */
+   boolean CA;
+   /** FALSE = read, TRUE = write */
+   boolean write;
+   /** size in bytes of parameter buffer, returns bytes read */
+   int     psize;
+   /** parameter buffer */
+   void    *p;
+   /** result, >0 success, 0 abort or error, EC_TIMEOUT */
+   int     wkc;
+   /** SDO abort code if aborted by slave */
+   int32   abortcode;
+} ec_SDObatcht;
+
+/** max. number of device types in object dictionary cache */
+#define EC_MAXODCACHE    8
+/** max. number of object entries in object dictionary cache, all devices */
+#define EC_MAXODCACHEOE  8192
+
+/** cached object entry description was read */
+#define EC_ODCACHE_VALID 1
+/** slave answered the object entry description with an SDO information error */
+#define EC_ODCACHE_ERROR 2
+
+/** cached object entry description */
+typedef struct
+{
+   /** EC_ODCACHE_VALID, EC_ODCACHE_ERROR or 0 if not read */
+   uint8  Valid;
+   uint8  ValueInfo;
+   uint16 DataType;
+   uint16 BitLength;
+   uint16 ObjAccess;
+   char   Name[EC_MAXNAME+1];
+   /** SDO information abort code if Valid is EC_ODCACHE_ERROR */
+   int32  AbortCode;
+} ec_OEcacheentryt;
+
+/** cached object dictionary of one device type */
+typedef struct
+{
+   /** device identity from EEPROM */
+   uint32     eep_man;
+   uint32     eep_id;
+   uint32     eep_rev;
+   /** first entry in OE, object i has MaxSub[i] + 1 entries */
+   uint32     OEfirst;
+   /** SDO information abort code of the object list, 0 = list was read */
+   int32      ODlistabort;
+   /** SDO information abort code per object description, 0 = read */
+   int32      ODabort[EC_MAXODLIST];
+   /** object list with descriptions, Slave is not used */
+   ec_ODlistt ODlist;
+} ec_ODcachedevicet;
+
+/** magic number of an object dictionary cache, "ODCA" */
+#define EC_ODCACHE_MAGIC   0x4143444f
+/** layout version of an object dictionary cache */
+#define EC_ODCACHE_VERSION 1
+
+/** object dictionary cache keyed by vendor, product code and revision.
+ * Contains no pointers, so it can be saved to and loaded from a file as is.
+ * Initialise with ec_ODcache_init(), check a loaded cache with
+ * ec_ODcache_check(). */
+typedef struct
+{
+   /** EC_ODCACHE_MAGIC */
+   uint32            magic;
+   /** EC_ODCACHE_VERSION */
+   uint32            version;
+   /** sizeof(ec_ODcachedevicet) */
+   uint32            devicesize;
+   /** sizeof(ec_OEcacheentryt) */
+   uint32            entrysize;
+   /** number of cached device types */
+   uint16            devices;
+   /** number of used entries in OE */
+   uint32            OEentries;
+   ec_ODcachedevicet device[EC_MAXODCACHE];
+   ec_OEcacheentryt  OE[EC_MAXODCACHEOE];
+} ec_ODcachet;
+
 #ifdef EC_VER1
 void ec_SDOerror(uint16 Slave, uint16 Index, uint8 SubIdx, int32 AbortCode);
 int ec_SDOread(uint16 slave, uint16 index, uint8 subindex,
@@ -72,6 +250,14 @@ int ec_readODlist(uint16 Slave, ec_ODlistt *pODlist);
 int ec_readODdescription(uint16 Item, ec_ODlistt *pODlist);
 int ec_readOEsingle(uint16 Item, uint8 SubI, ec_ODlistt *pODlist, ec_OElistt *pOElist);
 int ec_readOE(uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist);
+int ec_SDOasync_read(uint16 slave, uint16 index, uint8 subindex, boolean CA,
+                     int psize, void *p, int timeout, ec_SDOasynccbt callback);
+int ec_SDOasync_write(uint16 slave, uint16 index, uint8 subindex, boolean CA,
+                      int psize, const void *p, int timeout, ec_SDOasynccbt callback);
+int ec_SDOasync_poll(int handle, int *psize, int32 *abortcode);
+int ec_SDObatch(ec_SDObatcht *list, int n, int timeout);
+int ec_readODlist_cached(ec_ODcachet *cache, uint16 Slave, ec_ODlistt *pODlist);
+int ec_readOE_cached(ec_ODcachet *cache, uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist);
 #endif
 
 void ecx_SDOerror(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubIdx, int32 AbortCode);
@@ -87,6 +273,19 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist);
 int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist);
 int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt *pODlist, ec_OElistt *pOElist);
 int ecx_readOE(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist);
+int ecx_SDOasync_read(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                      boolean CA, int psize, void *p, int timeout, ec_SDOasynccbt callback);
+int ecx_SDOasync_write(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                       boolean CA, int psize, const void *p, int timeout, ec_SDOasynccbt callback);
+int ecx_SDOasync_poll(ecx_contextt *context, int handle, int *psize, int32 *abortcode);
+void ecx_SDOasync_tx(ecx_contextt *context, uint8 idx);
+void ecx_SDOasync_rx(ecx_contextt *context, uint8 idx, int wkc);
+int ecx_SDObatch(ecx_contextt *context, ec_SDObatcht *list, int n, int timeout);
+void ec_ODcache_init(ec_ODcachet *cache);
+boolean ec_ODcache_check(const ec_ODcachet *cache);
+int ecx_readODlist_cached(ecx_contextt *context, ec_ODcachet *cache, uint16 Slave, ec_ODlistt *pODlist);
+int ecx_readOE_cached(ecx_contextt *context, ec_ODcachet *cache, uint16 Item,
+   ec_ODlistt *pODlist, ec_OElistt *pOElist);
 
 #ifdef __cplusplus
 }
@@ -20,20 +20,32 @@
 #include "ethercatmain.h"
 #include "ethercatcoe.h"
 #include "ethercatsoe.h"
+#include "ethercatdc.h"
+#include "ethercateoe.h"
 #include "ethercatconfig.h"
 
 
+/** initial value of FNV-1a hash */
+#define EC_FNV1A_SEED      0x811c9dc5
+
+#if EC_MAX_MAPT > 1
+/** mapping worker pool, exists for the duration of one mapping pass */
 typedef struct
 {
-   int thread_n;
-   int running;
    ecx_contextt *context;
-   uint16 slave;
+   uint8 group;
+   /** work queue, next slave to map */
+   uint16 nextslave;
+   /** protects nextslave */
+   void *mutex;
+} ecx_mappoolt;
+
+/** mapping worker */
+typedef struct
+{
+   int thread_n;
+   ecx_mappoolt *pool;
 } ecx_mapt_t;
-
-ecx_mapt_t ecx_mapt[EC_MAX_MAPT];
-#if EC_MAX_MAPT > 1
-OSAL_THREAD_HANDLE ecx_threadh[EC_MAX_MAPT];
 #endif
 
 #ifdef EC_VER1
@@ -638,7 +650,242 @@ static int ecx_lookup_mapping(ecx_contextt *context, uint16 slave, uint32 *Osize
    return 0;
 }
 
-static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
+/* FNV-1a hash, continues from hash so several buffers can be combined */
+static uint32 ecx_hash_fnv1a(uint32 hash, const uint8 *p, int size)
+{
+   while (size-- > 0)
+   {
+      hash ^= *p++;
+      hash *= 0x01000193;
+   }
+   return hash;
+}
+
+static void ecx_PDOcache_lock(void *mutex)
+{
+#if EC_MAX_MAPT > 1
+   if (mutex)
+   {
+      osal_mutex_lock(mutex);
+   }
+#else
+   (void)mutex;
+#endif
+}
+
+static void ecx_PDOcache_unlock(void *mutex)
+{
+#if EC_MAX_MAPT > 1
+   if (mutex)
+   {
+      osal_mutex_unlock(mutex);
+   }
+#else
+   (void)mutex;
+#endif
+}
+
+/** Read the PDO assign objects of all process data SM's and hash their content.
+ * This is the cheap confirm read for a cached mapping, the PDO objects
+ * themselves are not read.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = slave number
+ * @param[in]  thread_n   = calling thread index
+ * @param[in]  SMtype     = SM types to use, only type 3 and 4 have PDO assign
+ * @param[out] hash       = hash over SM number, PDO count and PDO indexes
+ * @return 1 if all assign objects could be read
+ */
+static int ecx_PDOassign_hash(ecx_contextt *context, uint16 slave, int thread_n,
+   const uint8 *SMtype, uint32 *hash)
+{
+   ec_PDOassignt *PDOassign;
+   uint16 rdat;
+   uint8 iSM, idxloop;
+   int wkc, rdl;
+
+   PDOassign = &(context->PDOassign[thread_n]);
+   *hash = EC_FNV1A_SEED;
+   for (iSM = 2 ; iSM < EC_MAXSM ; iSM++)
+   {
+      if ((SMtype[iSM] != 3) && (SMtype[iSM] != 4))
+      {
+         continue;
+      }
+      wkc = 0;
+      PDOassign->n = 0;
+      if (context->slavelist[slave].CoEdetails & ECT_COEDET_SDOCA)
+      {
+         /* all subindexes in one read */
+         rdl = sizeof(ec_PDOassignt);
+         wkc = ecx_SDOread(context, slave, ECT_SDO_PDOASSIGN + iSM, 0x00, TRUE, &rdl,
+            PDOassign, EC_TIMEOUTRXM);
+      }
+      if (wkc <= 0)
+      {
+         rdl = sizeof(rdat); rdat = 0;
+         wkc = ecx_SDOread(context, slave, ECT_SDO_PDOASSIGN + iSM, 0x00, FALSE, &rdl,
+            &rdat, EC_TIMEOUTRXM);
+         PDOassign->n = (uint8)etohs(rdat);
+         for (idxloop = 1; (wkc > 0) && (idxloop <= PDOassign->n); idxloop++)
+         {
+            rdl = sizeof(rdat); rdat = 0;
+            wkc = ecx_SDOread(context, slave, ECT_SDO_PDOASSIGN + iSM, idxloop, FALSE, &rdl,
+               &rdat, EC_TIMEOUTRXM);
+            PDOassign->index[idxloop - 1] = rdat;
+         }
+      }
+      if (wkc <= 0)
+      {
+         return 0;
+      }
+      *hash = ecx_hash_fnv1a(*hash, &iSM, sizeof(iSM));
+      *hash = ecx_hash_fnv1a(*hash, &(PDOassign->n), sizeof(PDOassign->n));
+      *hash = ecx_hash_fnv1a(*hash, (uint8 *)PDOassign->index,
+         PDOassign->n * (int)sizeof(PDOassign->index[0]));
+   }
+   return 1;
+}
+
+/** Find CoE mapping of slave in PDO mapping cache and apply it.
+ *
+ * An entry with the same vendor, product and revision must exist and the
+ * content of the PDO assign objects of the slave must match the entry.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = slave number
+ * @param[in]  thread_n   = calling thread index
+ * @param[in]  mutex      = mapping pool mutex, NULL if mapping runs serially
+ * @param[out] Osize      = size in bits of output mapping
+ * @param[out] Isize      = size in bits of input mapping
+ * @return 1 if mapping was found in cache
+ */
+static int ecx_PDOcache_lookup(ecx_contextt *context, uint16 slave, int thread_n,
+   void *mutex, uint32 *Osize, uint32 *Isize)
+{
+   ec_PDOcachet *cache;
+   ec_slavet *slavep;
+   ec_PDOcacheentryt entry;
+   uint32 hash;
+   int i, found;
+   uint8 iSM;
+
+   cache = context->PDOcache;
+   slavep = &(context->slavelist[slave]);
+   /* the SM types are needed to know which assign objects to confirm */
+   found = -1;
+   ecx_PDOcache_lock(mutex);
+   for (i = 0; (i < cache->entries) && (i < EC_MAXPDOCACHE); i++)
+   {
+      if ((cache->entry[i].eep_man == slavep->eep_man) &&
+          (cache->entry[i].eep_id == slavep->eep_id) &&
+          (cache->entry[i].eep_rev == slavep->eep_rev))
+      {
+         entry = cache->entry[i];
+         found = i;
+         break;
+      }
+   }
+   ecx_PDOcache_unlock(mutex);
+   if ((found < 0) || !ecx_PDOassign_hash(context, slave, thread_n, entry.SMtype, &hash))
+   {
+      return 0;
+   }
+   found = -1;
+   ecx_PDOcache_lock(mutex);
+   for (i = 0; (i < cache->entries) && (i < EC_MAXPDOCACHE); i++)
+   {
+      if ((cache->entry[i].eep_man == slavep->eep_man) &&
+          (cache->entry[i].eep_id == slavep->eep_id) &&
+          (cache->entry[i].eep_rev == slavep->eep_rev) &&
+          (cache->entry[i].assignhash == hash))
+      {
+         entry = cache->entry[i];
+         found = i;
+         break;
+      }
+   }
+   ecx_PDOcache_unlock(mutex);
+   if (found < 0)
+   {
+      return 0;
+   }
+   for (iSM = 2 ; iSM < EC_MAXSM ; iSM++)
+   {
+      slavep->SMtype[iSM] = entry.SMtype[iSM];
+      /* check if SM is unused -> clear enable flag */
+      if (entry.SMtype[iSM] == 0)
+      {
+         slavep->SM[iSM].SMflags = htoel(etohl(slavep->SM[iSM].SMflags) & EC_SMENABLEMASK);
+      }
+      if (entry.SMlength[iSM])
+      {
+         slavep->SM[iSM].SMlength = htoes(entry.SMlength[iSM]);
+      }
+   }
+   *Osize = entry.Osize;
+   *Isize = entry.Isize;
+   EC_PRINT("  CoE mapping from cache entry %d\n", found);
+   return 1;
+}
+
+/** Add CoE mapping of slave to PDO mapping cache.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = slave number, mapping already read via CoE
+ * @param[in]  thread_n   = calling thread index
+ * @param[in]  mutex      = mapping pool mutex, NULL if mapping runs serially
+ * @param[in]  Osize      = size in bits of output mapping
+ * @param[in]  Isize      = size in bits of input mapping
+ */
+static void ecx_PDOcache_add(ecx_contextt *context, uint16 slave, int thread_n,
+   void *mutex, uint32 Osize, uint32 Isize)
+{
+   ec_PDOcachet *cache;
+   ec_slavet *slavep;
+   ec_PDOcacheentryt entry;
+   int i;
+   uint8 iSM;
+
+   cache = context->PDOcache;
+   slavep = &(context->slavelist[slave]);
+   memset(&entry, 0, sizeof(entry));
+   entry.eep_man = slavep->eep_man;
+   entry.eep_id = slavep->eep_id;
+   entry.eep_rev = slavep->eep_rev;
+   entry.Osize = Osize;
+   entry.Isize = Isize;
+   for (iSM = 2 ; iSM < EC_MAXSM ; iSM++)
+   {
+      entry.SMtype[iSM] = slavep->SMtype[iSM];
+      if ((entry.SMtype[iSM] == 3) || (entry.SMtype[iSM] == 4))
+      {
+         entry.SMlength[iSM] = etohs(slavep->SM[iSM].SMlength);
+      }
+   }
+   if (!ecx_PDOassign_hash(context, slave, thread_n, entry.SMtype, &(entry.assignhash)))
+   {
+      return;
+   }
+   ecx_PDOcache_lock(mutex);
+   for (i = 0; i < cache->entries; i++)
+   {
+      if ((cache->entry[i].eep_man == entry.eep_man) &&
+          (cache->entry[i].eep_id == entry.eep_id) &&
+          (cache->entry[i].eep_rev == entry.eep_rev) &&
+          (cache->entry[i].assignhash == entry.assignhash))
+      {
+         break;
+      }
+   }
+   if ((i == cache->entries) && (cache->entries < EC_MAXPDOCACHE))
+   {
+      cache->entry[cache->entries++] = entry;
+   }
+   ecx_PDOcache_unlock(mutex);
+}
+
+static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n, void *mutex)
 {
    uint32 Isize, Osize;
    int rval;
@@ -665,15 +912,28 @@ static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
       if (context->slavelist[slave].mbx_proto & ECT_MBXPROT_COE) /* has CoE */
       {
          rval = 0;
-         if (context->slavelist[slave].CoEdetails & ECT_COEDET_SDOCA) /* has Complete Access */
+         if (context->PDOcache)
+         {
+            /* same slave type with same PDO assignment mapped before */
+            rval = ecx_PDOcache_lookup(context, slave, thread_n, mutex, &Osize, &Isize);
+         }
+         if (!rval && (context->slavelist[slave].CoEdetails & ECT_COEDET_SDOCA)) /* has Complete Access */
          {
             /* read PDO mapping via CoE and use Complete Access */
             rval = ecx_readPDOmapCA(context, slave, thread_n, &Osize, &Isize);
+            if (rval && context->PDOcache)
+            {
+               ecx_PDOcache_add(context, slave, thread_n, mutex, Osize, Isize);
+            }
          }
          if (!rval) /* CA not available or not succeeded */
          {
             /* read PDO mapping via CoE */
             rval = ecx_readPDOmap(context, slave, &Osize, &Isize);
+            if (rval && context->PDOcache)
+            {
+               ecx_PDOcache_add(context, slave, thread_n, mutex, Osize, Isize);
+            }
          }
          EC_PRINT("  CoE Osize:%u Isize:%u\n", Osize, Isize);
       }
@@ -803,85 +1063,148 @@ static int ecx_map_sm(ecx_contextt *context, uint16 slave)
 }
 
 #if EC_MAX_MAPT > 1
-OSAL_THREAD_FUNC ecx_mapper_thread(void *param)
+/** Get next slave from mapping work queue.
+ *
+ * @param[in]  pool       = mapping worker pool
+ * @return slave number, 0 if queue is empty
+ */
+static uint16 ecx_mapper_next(ecx_mappoolt *pool)
 {
-   ecx_mapt_t *maptp;
-   maptp = param;
-   ecx_map_coe_soe(maptp->context, maptp->slave, maptp->thread_n);
-   maptp->running = 0;
-}
+   uint16 slave;
 
-static int ecx_find_mapt(void)
-{
-   int p;
-   p = 0;
-   while((p < EC_MAX_MAPT) && ecx_mapt[p].running)
+   osal_mutex_lock(pool->mutex);
+   slave = pool->nextslave;
+   while ((slave <= *(pool->context->slavecount)) &&
+          pool->group && (pool->group != pool->context->slavelist[slave].group))
    {
-      p++;
+      slave++;
    }
-   if(p < EC_MAX_MAPT)
+   if (slave <= *(pool->context->slavecount))
    {
-      return p;
+      pool->nextslave = slave + 1;
    }
    else
    {
-      return -1;
+      pool->nextslave = slave;
+      slave = 0;
    }
+   osal_mutex_unlock(pool->mutex);
+
+   return slave;
 }
-#endif
 
-static int ecx_get_threadcount(void)
+/** Mapping worker, takes slaves from the work queue until it is empty.
+ * Each worker uses its own SMcommtype, PDOassign and PDOdesc entry.
+ */
+OSAL_THREAD_FUNC ecx_mapper_thread(void *param)
 {
-   int thrc, thrn;
-   thrc = 0;
-   for(thrn = 0 ; thrn < EC_MAX_MAPT ; thrn++)
+   ecx_mapt_t *maptp;
+   uint16 slave;
+
+   maptp = param;
+   while ((slave = ecx_mapper_next(maptp->pool)) > 0)
    {
-      thrc += ecx_mapt[thrn].running;
+      ecx_map_coe_soe(maptp->pool->context, slave, maptp->thread_n, maptp->pool->mutex);
    }
-   return thrc;
 }
+#endif
 
-static void ecx_config_find_mappings(ecx_contextt *context, uint8 group)
+/** Get number of mapping workers to use for a group.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  group      = group to map, 0 = all groups
+ * @return number of workers, at least 1
+ */
+static int ecx_get_threadcount(ecx_contextt *context, uint8 group)
 {
-   int thrn, thrc;
+   int thrc, slavec;
    uint16 slave;
 
-   for (thrn = 0; thrn < EC_MAX_MAPT; thrn++)
+   thrc = context->maptworkers;
+   if (thrc < 1)
+   {
+      thrc = 1;
+   }
+   if (thrc > EC_MAX_MAPT)
    {
-      ecx_mapt[thrn].running = 0;
+      thrc = EC_MAX_MAPT;
    }
-   /* find CoE and SoE mapping of slaves in multiple threads */
+   /* no more workers than slaves to map */
+   slavec = 0;
    for (slave = 1; slave <= *(context->slavecount); slave++)
    {
       if (!group || (group == context->slavelist[slave].group))
       {
+         slavec++;
+      }
+   }
+   if (thrc > slavec)
+   {
+      thrc = slavec;
+   }
+   return (thrc > 0) ? thrc : 1;
+}
+
+static void ecx_config_find_mappings(ecx_contextt *context, uint8 group)
+{
+   int thrc;
+   uint16 slave;
 #if EC_MAX_MAPT > 1
-            /* multi-threaded version */
-            while ((thrn = ecx_find_mapt()) < 0)
-            {
-               osal_usleep(1000);
-            }
-            ecx_mapt[thrn].context = context;
-            ecx_mapt[thrn].slave = slave;
-            ecx_mapt[thrn].thread_n = thrn;
-            ecx_mapt[thrn].running = 1;
-            osal_thread_create(&(ecx_threadh[thrn]), 128000,
-               &ecx_mapper_thread, &(ecx_mapt[thrn]));
-#else
-            /* serialised version */
-            ecx_map_coe_soe(context, slave, 0);
+   int thrn;
+   ecx_mappoolt pool;
+   ecx_mapt_t mapt[EC_MAX_MAPT];
+   OSAL_THREAD_HANDLE threadh[EC_MAX_MAPT];
+   boolean started[EC_MAX_MAPT];
 #endif
+
+   thrc = ecx_get_threadcount(context, group);
+#if EC_MAX_MAPT > 1
+   pool.mutex = NULL;
+   if (thrc > 1)
+   {
+      pool.mutex = osal_mutex_create();
+   }
+   if (pool.mutex)
+   {
+      /* find CoE and SoE mapping of slaves in a pool of workers, the calling
+       * thread is worker 0 so only thrc - 1 threads are created */
+      pool.context = context;
+      pool.group = group;
+      pool.nextslave = 1;
+      for (thrn = 0; thrn < thrc; thrn++)
+      {
+         mapt[thrn].pool = &pool;
+         mapt[thrn].thread_n = thrn;
+         started[thrn] = FALSE;
+         if (thrn > 0)
+         {
+            started[thrn] = (boolean)osal_thread_create(&(threadh[thrn]), 64000,
+               &ecx_mapper_thread, &(mapt[thrn]));
+         }
+      }
+      ecx_mapper_thread(&(mapt[0]));
+      /* wait for all workers to finish */
+      for (thrn = 1; thrn < thrc; thrn++)
+      {
+         if (started[thrn])
+         {
+            osal_thread_join(&(threadh[thrn]));
+         }
       }
+      osal_mutex_destroy(pool.mutex);
    }
-   /* wait for all threads to finish */
-   do
+   else
+#endif
    {
-      thrc = ecx_get_threadcount();
-      if (thrc)
+      /* serialised version */
+      for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         osal_usleep(1000);
+         if (!group || (group == context->slavelist[slave].group))
+         {
+            ecx_map_coe_soe(context, slave, 0, NULL);
+         }
       }
-   } while (thrc);
+   }
    /* find SII mapping of slave and program SM */
    for (slave = 1; slave <= *(context->slavecount); slave++)
    {
@@ -1177,7 +1500,7 @@ static void ecx_config_create_output_mappings(ecx_contextt *context, void *pIOma
 
 static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group, boolean forceByteAlignment)
 {
-   uint16 slave, configadr;
+   uint16 slave;
    uint8 BitPos;
    uint32 LogAddr = 0;
    uint32 oLogAddr = 0;
@@ -1201,8 +1524,6 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
       /* do output mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
-
          if (!group || (group == context->slavelist[slave].group))
          {
             /* create output mapping */
@@ -1272,7 +1593,6 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
       /* do input mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
          if (!group || (group == context->slavelist[slave].group))
          {
             /* create input mapping */
@@ -1309,16 +1629,6 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
             }
 
             ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */
-            /* User may override automatic state change */
-            if (context->manualstatechange == 0)
-            {
-               /* request safe_op for slave */
-               ecx_FPWRw(context->port,
-                  configadr,
-                  ECT_REG_ALCTL,
-                  htoes(EC_STATE_SAFE_OP),
-                  EC_TIMEOUTRET3); /* set safeop status */
-            }
             if (context->slavelist[slave].blockLRW)
             {
                context->grouplist[group].blockLRW++;
@@ -1359,6 +1669,13 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
             context->slavelist[0].Obytes; /* store input bytes in master record */
       }
 
+      /* User may override automatic state change */
+      if (context->manualstatechange == 0)
+      {
+         /* request safe_op for all slaves of group at once */
+         ecx_writestate_group(context, group, EC_STATE_SAFE_OP);
+      }
+
       EC_PRINT("IOmapSize %d\n", LogAddr - context->grouplist[group].logstartaddr);
 
       return (LogAddr - context->grouplist[group].logstartaddr);
@@ -1405,7 +1722,7 @@ int ecx_config_map_group_aligned(ecx_contextt *context, void *pIOmap, uint8 grou
  */
 int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
 {
-   uint16 slave, configadr;
+   uint16 slave;
    uint8 BitPos;
    uint32 mLogAddr = 0;
    uint32 siLogAddr = 0;
@@ -1432,7 +1749,6 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
       /* do IO mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
          siLogAddr = soLogAddr = mLogAddr;
 
          if (!group || (group == context->slavelist[slave].group))
@@ -1481,16 +1797,6 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
             }
 
             ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */
-            /* User may override automatic state change */
-            if (context->manualstatechange == 0)
-            {
-               /* request safe_op for slave */
-               ecx_FPWRw(context->port,
-                  configadr,
-                  ECT_REG_ALCTL,
-                  htoes(EC_STATE_SAFE_OP),
-                  EC_TIMEOUTRET3);
-            }
             if (context->slavelist[slave].blockLRW)
             {
                context->grouplist[group].blockLRW++;
@@ -1531,6 +1837,13 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
          context->slavelist[0].Ibytes = siLogAddr - context->grouplist[group].logstartaddr;
       }
 
+      /* User may override automatic state change */
+      if (context->manualstatechange == 0)
+      {
+         /* request safe_op for all slaves of group at once */
+         ecx_writestate_group(context, group, EC_STATE_SAFE_OP);
+      }
+
       EC_PRINT("IOmapSize %d\n", context->grouplist[group].Obytes + context->grouplist[group].Ibytes);
 
       return (context->grouplist[group].Obytes + context->grouplist[group].Ibytes);
@@ -1662,6 +1975,962 @@ int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout)
    return state;
 }
 
+/** magic number of a configuration snapshot, "ECSN" */
+#define EC_SNAPSHOT_MAGIC     0x4e534345
+/** layout version of a configuration snapshot */
+#define EC_SNAPSHOT_VERSION   2
+/** IOmap offset used for unmapped process data pointers */
+#define EC_SNAPSHOT_NOMAP     0xffffffff
+
+/** configuration snapshot header */
+PACKED_BEGIN
+typedef struct PACKED
+{
+   uint32  magic;
+   uint16  version;
+   uint16  slavecount;
+   uint16  groupcount;
+   uint16  slavesize;
+   uint16  groupsize;
+   uint16  reserved;
+   uint32  checksum;
+} ec_snapheadert;
+PACKED_END
+
+/** configuration snapshot slave record, pointers stored as IOmap offset */
+PACKED_BEGIN
+typedef struct PACKED
+{
+   uint16  configadr;
+   uint16  aliasadr;
+   uint32  eep_man;
+   uint32  eep_id;
+   uint32  eep_rev;
+   uint16  Itype;
+   uint16  Dtype;
+   uint16  Obits;
+   uint32  Obytes;
+   uint32  outputs;
+   uint8   Ostartbit;
+   uint16  Ibits;
+   uint32  Ibytes;
+   uint32  inputs;
+   uint8   Istartbit;
+   ec_smt  SM[EC_MAXSM];
+   uint8   SMtype[EC_MAXSM];
+   ec_fmmut FMMU[EC_MAXFMMU];
+   uint8   FMMUfunc[EC_MAXFMMU];
+   uint16  mbx_l;
+   uint16  mbx_wo;
+   uint16  mbx_rl;
+   uint16  mbx_ro;
+   uint16  mbx_proto;
+   uint8   hasdc;
+   uint8   ptype;
+   uint8   topology;
+   uint8   activeports;
+   uint8   consumedports;
+   uint16  parent;
+   uint8   parentport;
+   uint8   entryport;
+   int32   DCrtA;
+   int32   DCrtB;
+   int32   DCrtC;
+   int32   DCrtD;
+   int32   pdelay;
+   uint16  DCnext;
+   uint16  DCprevious;
+   uint16  configindex;
+   uint8   eep_8byte;
+   uint8   eep_pdi;
+   uint8   CoEdetails;
+   uint8   FoEdetails;
+   uint8   EoEdetails;
+   uint8   SoEdetails;
+   int16   Ebuscurrent;
+   uint8   blockLRW;
+   uint8   group;
+   uint8   FMMUunused;
+   char    name[EC_MAXNAME + 1];
+} ec_snapslavet;
+PACKED_END
+
+/** configuration snapshot group record, pointers stored as IOmap offset */
+PACKED_BEGIN
+typedef struct PACKED
+{
+   uint32  logstartaddr;
+   uint32  Obytes;
+   uint32  outputs;
+   uint32  Ibytes;
+   uint32  inputs;
+   uint8   hasdc;
+   uint16  DCnext;
+   int16   Ebuscurrent;
+   uint8   blockLRW;
+   uint16  nsegments;
+   uint16  Isegment;
+   uint16  Ioffset;
+   uint16  outputsWKC;
+   uint16  inputsWKC;
+   uint8   docheckstate;
+   uint32  IOsegment[EC_MAXIOSEGMENTS];
+} ec_snapgroupt;
+PACKED_END
+
+static uint32 ecx_snapshot_offset(const void *pIOmap, const uint8 *p)
+{
+   if (p == NULL)
+   {
+      return EC_SNAPSHOT_NOMAP;
+   }
+   return (uint32)(p - (const uint8 *)pIOmap);
+}
+
+static uint8 *ecx_snapshot_pointer(void *pIOmap, uint32 offset)
+{
+   if (offset == EC_SNAPSHOT_NOMAP)
+   {
+      return NULL;
+   }
+   return (uint8 *)pIOmap + offset;
+}
+
+/* FNV-1a hash over snapshot payload, guards against truncated or corrupted files */
+static uint32 ecx_snapshot_checksum(const uint8 *p, int size)
+{
+   return ecx_hash_fnv1a(EC_FNV1A_SEED, p, size);
+}
+
+/** Save configuration snapshot.
+ *
+ * Serialises the result of ecx_config_init(), ecx_config_map_group() and
+ * ecx_configdc() : slave list including SM/FMMU programming, PDO sizes,
+ * IOmap layout, DC topology and delays, and group segments. The snapshot can
+ * be stored by the application and used at next start with
+ * ecx_config_snapshot_load() and ecx_config_restore() to skip all SII and
+ * CoE/SoE discovery. All groups must be mapped into the same IOmap.
+ * The snapshot is in host byte order and is not portable between platforms.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  pIOmap     = pointer to IOmap used in ecx_config_map_group()
+ * @param[out] buf        = buffer for snapshot, NULL to query needed size
+ * @param[in]  size       = size of buffer in bytes
+ * @return size of snapshot in bytes, 0 if buffer is too small
+ */
+int ecx_config_snapshot_save(ecx_contextt *context, const void *pIOmap, void *buf, int size)
+{
+   ec_snapheadert hdr;
+   ec_snapslavet ss;
+   ec_snapgroupt sg;
+   ec_slavet *sp;
+   ec_groupt *gp;
+   uint8 *bp;
+   int slave, group, needed;
+
+   needed = (int)(sizeof(hdr) + (sizeof(ss) * (*(context->slavecount) + 1)) +
+                  (sizeof(sg) * context->maxgroup));
+   if (buf == NULL)
+   {
+      return needed;
+   }
+   if (size < needed)
+   {
+      return 0;
+   }
+   bp = (uint8 *)buf + sizeof(hdr);
+   for (slave = 0; slave <= *(context->slavecount); slave++)
+   {
+      sp = &(context->slavelist[slave]);
+      memset(&ss, 0, sizeof(ss));
+      ss.configadr = sp->configadr;
+      ss.aliasadr = sp->aliasadr;
+      ss.eep_man = sp->eep_man;
+      ss.eep_id = sp->eep_id;
+      ss.eep_rev = sp->eep_rev;
+      ss.Itype = sp->Itype;
+      ss.Dtype = sp->Dtype;
+      ss.Obits = sp->Obits;
+      ss.Obytes = sp->Obytes;
+      ss.outputs = ecx_snapshot_offset(pIOmap, sp->outputs);
+      ss.Ostartbit = sp->Ostartbit;
+      ss.Ibits = sp->Ibits;
+      ss.Ibytes = sp->Ibytes;
+      ss.inputs = ecx_snapshot_offset(pIOmap, sp->inputs);
+      ss.Istartbit = sp->Istartbit;
+      memcpy(ss.SM, sp->SM, sizeof(ss.SM));
+      memcpy(ss.SMtype, sp->SMtype, sizeof(ss.SMtype));
+      memcpy(ss.FMMU, sp->FMMU, sizeof(ss.FMMU));
+      ss.FMMUfunc[0] = sp->FMMU0func;
+      ss.FMMUfunc[1] = sp->FMMU1func;
+      ss.FMMUfunc[2] = sp->FMMU2func;
+      ss.FMMUfunc[3] = sp->FMMU3func;
+      ss.mbx_l = sp->mbx_l;
+      ss.mbx_wo = sp->mbx_wo;
+      ss.mbx_rl = sp->mbx_rl;
+      ss.mbx_ro = sp->mbx_ro;
+      ss.mbx_proto = sp->mbx_proto;
+      ss.hasdc = sp->hasdc;
+      ss.ptype = sp->ptype;
+      ss.topology = sp->topology;
+      ss.activeports = sp->activeports;
+      ss.consumedports = sp->consumedports;
+      ss.parent = sp->parent;
+      ss.parentport = sp->parentport;
+      ss.entryport = sp->entryport;
+      ss.DCrtA = sp->DCrtA;
+      ss.DCrtB = sp->DCrtB;
+      ss.DCrtC = sp->DCrtC;
+      ss.DCrtD = sp->DCrtD;
+      ss.pdelay = sp->pdelay;
+      ss.DCnext = sp->DCnext;
+      ss.DCprevious = sp->DCprevious;
+      ss.configindex = sp->configindex;
+      ss.eep_8byte = sp->eep_8byte;
+      ss.eep_pdi = sp->eep_pdi;
+      ss.CoEdetails = sp->CoEdetails;
+      ss.FoEdetails = sp->FoEdetails;
+      ss.EoEdetails = sp->EoEdetails;
+      ss.SoEdetails = sp->SoEdetails;
+      ss.Ebuscurrent = sp->Ebuscurrent;
+      ss.blockLRW = sp->blockLRW;
+      ss.group = sp->group;
+      ss.FMMUunused = sp->FMMUunused;
+      memcpy(ss.name, sp->name, sizeof(ss.name));
+      memcpy(bp, &ss, sizeof(ss));
+      bp += sizeof(ss);
+   }
+   for (group = 0; group < context->maxgroup; group++)
+   {
+      gp = &(context->grouplist[group]);
+      memset(&sg, 0, sizeof(sg));
+      sg.logstartaddr = gp->logstartaddr;
+      sg.Obytes = gp->Obytes;
+      sg.outputs = ecx_snapshot_offset(pIOmap, gp->outputs);
+      sg.Ibytes = gp->Ibytes;
+      sg.inputs = ecx_snapshot_offset(pIOmap, gp->inputs);
+      sg.hasdc = gp->hasdc;
+      sg.DCnext = gp->DCnext;
+      sg.Ebuscurrent = gp->Ebuscurrent;
+      sg.blockLRW = gp->blockLRW;
+      sg.nsegments = gp->nsegments;
+      sg.Isegment = gp->Isegment;
+      sg.Ioffset = gp->Ioffset;
+      sg.outputsWKC = gp->outputsWKC;
+      sg.inputsWKC = gp->inputsWKC;
+      sg.docheckstate = gp->docheckstate;
+      memcpy(sg.IOsegment, gp->IOsegment, sizeof(sg.IOsegment));
+      memcpy(bp, &sg, sizeof(sg));
+      bp += sizeof(sg);
+   }
+   memset(&hdr, 0, sizeof(hdr));
+   hdr.magic = EC_SNAPSHOT_MAGIC;
+   hdr.version = EC_SNAPSHOT_VERSION;
+   hdr.slavecount = (uint16)*(context->slavecount);
+   hdr.groupcount = (uint16)context->maxgroup;
+   hdr.slavesize = sizeof(ss);
+   hdr.groupsize = sizeof(sg);
+   hdr.checksum = ecx_snapshot_checksum((uint8 *)buf + sizeof(hdr), needed - (int)sizeof(hdr));
+   memcpy(buf, &hdr, sizeof(hdr));
+
+   return needed;
+}
+
+/** Load configuration snapshot into context.
+ *
+ * Only the slave and group lists are filled, there is no network traffic.
+ * After loading the application can register PO2SOconfig hooks and must call
+ * ecx_config_restore() to verify and program the network.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  pIOmap     = pointer to IOmap, slave and group pointers are rebased to it
+ * @param[in]  buf        = buffer with snapshot from ecx_config_snapshot_save()
+ * @param[in]  size       = size of snapshot in bytes
+ * @return number of slaves in snapshot, 0 if snapshot is invalid
+ */
+int ecx_config_snapshot_load(ecx_contextt *context, void *pIOmap, const void *buf, int size)
+{
+   ec_snapheadert hdr;
+   ec_snapslavet ss;
+   ec_snapgroupt sg;
+   ec_slavet *sp;
+   ec_groupt *gp;
+   const uint8 *bp;
+   int slave, group, needed;
+
+   if ((buf == NULL) || (size < (int)sizeof(hdr)))
+   {
+      return 0;
+   }
+   memcpy(&hdr, buf, sizeof(hdr));
+   if ((hdr.magic != EC_SNAPSHOT_MAGIC) || (hdr.version != EC_SNAPSHOT_VERSION) ||
+       (hdr.slavesize != sizeof(ss)) || (hdr.groupsize != sizeof(sg)) ||
+       (hdr.slavecount >= context->maxslave) || (hdr.groupcount > context->maxgroup))
+   {
+      return 0;
+   }
+   needed = (int)(sizeof(hdr) + (sizeof(ss) * (hdr.slavecount + 1)) + (sizeof(sg) * hdr.groupcount));
+   if ((size < needed) ||
+       (hdr.checksum != ecx_snapshot_checksum((const uint8 *)buf + sizeof(hdr), needed - (int)sizeof(hdr))))
+   {
+      return 0;
+   }
+   ecx_init_context(context);
+   bp = (const uint8 *)buf + sizeof(hdr);
+   for (slave = 0; slave <= hdr.slavecount; slave++)
+   {
+      memcpy(&ss, bp, sizeof(ss));
+      bp += sizeof(ss);
+      sp = &(context->slavelist[slave]);
+      sp->configadr = ss.configadr;
+      sp->aliasadr = ss.aliasadr;
+      sp->eep_man = ss.eep_man;
+      sp->eep_id = ss.eep_id;
+      sp->eep_rev = ss.eep_rev;
+      sp->Itype = ss.Itype;
+      sp->Dtype = ss.Dtype;
+      sp->Obits = ss.Obits;
+      sp->Obytes = ss.Obytes;
+      sp->outputs = ecx_snapshot_pointer(pIOmap, ss.outputs);
+      sp->Ostartbit = ss.Ostartbit;
+      sp->Ibits = ss.Ibits;
+      sp->Ibytes = ss.Ibytes;
+      sp->inputs = ecx_snapshot_pointer(pIOmap, ss.inputs);
+      sp->Istartbit = ss.Istartbit;
+      memcpy(sp->SM, ss.SM, sizeof(ss.SM));
+      memcpy(sp->SMtype, ss.SMtype, sizeof(ss.SMtype));
+      memcpy(sp->FMMU, ss.FMMU, sizeof(ss.FMMU));
+      sp->FMMU0func = ss.FMMUfunc[0];
+      sp->FMMU1func = ss.FMMUfunc[1];
+      sp->FMMU2func = ss.FMMUfunc[2];
+      sp->FMMU3func = ss.FMMUfunc[3];
+      sp->mbx_l = ss.mbx_l;
+      sp->mbx_wo = ss.mbx_wo;
+      sp->mbx_rl = ss.mbx_rl;
+      sp->mbx_ro = ss.mbx_ro;
+      sp->mbx_proto = ss.mbx_proto;
+      sp->hasdc = ss.hasdc;
+      sp->ptype = ss.ptype;
+      sp->topology = ss.topology;
+      sp->activeports = ss.activeports;
+      sp->consumedports = ss.consumedports;
+      sp->parent = ss.parent;
+      sp->parentport = ss.parentport;
+      sp->entryport = ss.entryport;
+      sp->DCrtA = ss.DCrtA;
+      sp->DCrtB = ss.DCrtB;
+      sp->DCrtC = ss.DCrtC;
+      sp->DCrtD = ss.DCrtD;
+      sp->pdelay = ss.pdelay;
+      sp->DCnext = ss.DCnext;
+      sp->DCprevious = ss.DCprevious;
+      sp->configindex = ss.configindex;
+      sp->eep_8byte = ss.eep_8byte;
+      sp->eep_pdi = ss.eep_pdi;
+      sp->CoEdetails = ss.CoEdetails;
+      sp->FoEdetails = ss.FoEdetails;
+      sp->EoEdetails = ss.EoEdetails;
+      sp->SoEdetails = ss.SoEdetails;
+      sp->Ebuscurrent = ss.Ebuscurrent;
+      sp->blockLRW = ss.blockLRW;
+      sp->group = ss.group;
+      sp->FMMUunused = ss.FMMUunused;
+      memcpy(sp->name, ss.name, sizeof(ss.name));
+      sp->name[EC_MAXNAME] = 0;
+   }
+   for (group = 0; group < hdr.groupcount; group++)
+   {
+      memcpy(&sg, bp, sizeof(sg));
+      bp += sizeof(sg);
+      gp = &(context->grouplist[group]);
+      gp->logstartaddr = sg.logstartaddr;
+      gp->Obytes = sg.Obytes;
+      gp->outputs = ecx_snapshot_pointer(pIOmap, sg.outputs);
+      gp->Ibytes = sg.Ibytes;
+      gp->inputs = ecx_snapshot_pointer(pIOmap, sg.inputs);
+      gp->hasdc = sg.hasdc;
+      gp->DCnext = sg.DCnext;
+      gp->Ebuscurrent = sg.Ebuscurrent;
+      gp->blockLRW = sg.blockLRW;
+      gp->nsegments = sg.nsegments;
+      gp->Isegment = sg.Isegment;
+      gp->Ioffset = sg.Ioffset;
+      gp->outputsWKC = sg.outputsWKC;
+      gp->inputsWKC = sg.inputsWKC;
+      gp->docheckstate = sg.docheckstate;
+      memcpy(gp->IOsegment, sg.IOsegment, sizeof(sg.IOsegment));
+   }
+   *(context->slavecount) = hdr.slavecount;
+
+   return hdr.slavecount;
+}
+
+/** Read one SII word pair of a block of slaves in parallel.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  fslave     = first slave of block
+ * @param[in]  n          = number of slaves in block, max EC_MAXMDATAGRAM
+ * @param[in]  eeproma    = (WORD) Address in the EEPROM
+ * @param[out] edat       = EEPROM data per slave
+ * @return TRUE if all slaves returned data
+ */
+static boolean ecx_restore_readsii(ecx_contextt *context, uint16 fslave, int n, uint16 eeproma, uint32 *edat)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   uint16 ed[EC_MAXMDATAGRAM][5];
+   osal_timert timer;
+   boolean busy;
+   int i;
+
+   for (i = 0; i < n; i++)
+   {
+      ed[i][0] = htoes(EC_ECMD_READ);
+      ed[i][1] = htoes(eeproma);
+      ed[i][2] = 0;
+      dg[i].com = EC_CMD_FPWR;
+      dg[i].ADP = context->slavelist[fslave + i].configadr;
+      dg[i].ADO = ECT_REG_EEPCTL;
+      dg[i].length = sizeof(uint16) * 3;
+      dg[i].data = &ed[i][0];
+   }
+   if (ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET3) != n)
+   {
+      return FALSE;
+   }
+   /* poll eeprom status, address and data registers in one datagram per slave */
+   osal_timer_start(&timer, EC_TIMEOUTEEP);
+   do
+   {
+      for (i = 0; i < n; i++)
+      {
+         dg[i].com = EC_CMD_FPRD;
+         dg[i].ADO = ECT_REG_EEPSTAT;
+         dg[i].length = sizeof(ed[i]);
+      }
+      if (ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET3) != n)
+      {
+         return FALSE;
+      }
+      busy = FALSE;
+      for (i = 0; i < n; i++)
+      {
+         if (etohs(ed[i][0]) & EC_ESTAT_EMASK)
+         {
+            return FALSE;
+         }
+         if (etohs(ed[i][0]) & EC_ESTAT_BUSY)
+         {
+            busy = TRUE;
+         }
+      }
+      if (busy)
+      {
+         osal_usleep(EC_LOCALDELAY);
+      }
+   } while (busy && !osal_timer_is_expired(&timer));
+   if (busy)
+   {
+      return FALSE;
+   }
+   for (i = 0; i < n; i++)
+   {
+      /* data register follows status and address registers */
+      memcpy(&edat[i], &ed[i][3], sizeof(uint32));
+      edat[i] = etohl(edat[i]);
+   }
+   return TRUE;
+}
+
+/** Restore network configuration from a loaded snapshot.
+ *
+ * Replaces ecx_config_init(), ecx_config_map_group() and ecx_configdc() after
+ * ecx_config_snapshot_load(). The slave count is verified by BRD and the
+ * identity (alias, manufacturer, ID, revision) of all slaves is read in
+ * multi datagram frames. If the network is unchanged all node addresses,
+ * SM, FMMU and DC offsets and delays are programmed in bulk. The slaves are
+ * then requested to PRE_OP, the PO2SOconfig hooks are executed and the
+ * slaves are requested to SAFE_OP, unless manualstatechange is set.
+ * When 0 is returned the network differs from the snapshot and the
+ * application should fall back to the normal configuration functions.
+ *
+ * @param[in]  context    = context struct
+ * @return Number of slaves restored, 0 if network does not match snapshot
+ */
+int ecx_config_restore(ecx_contextt *context)
+{
+   static const uint16 siiaddr[3] = { ECT_SII_MANUF, ECT_SII_ID, ECT_SII_REV };
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   uint16 wdat[EC_MAXMDATAGRAM];
+   uint32 edat[EC_MAXMDATAGRAM];
+   uint64 dcdat[EC_MAXMDATAGRAM / 2];
+   int32 delay[EC_MAXMDATAGRAM / 2];
+   ec_slavet *sp;
+   uint16 slave, fslave, nSM, w;
+   int i, k, n, si, slavecount, wkc;
+   uint32 expect;
+   uint8 b;
+   int32 ht;
+   ec_timet mastertime;
+   uint64 mastertime64;
+
+   slavecount = *(context->slavecount);
+   if (slavecount < 1)
+   {
+      return 0;
+   }
+   EC_PRINT("ec_config_restore %d\n", slavecount);
+   b = 0x00;
+   ecx_BWR(context->port, 0x0000, ECT_REG_DLALIAS, sizeof(b), &b, EC_TIMEOUTRET3);     /* Ignore Alias register */
+   b = EC_STATE_INIT | EC_STATE_ACK;
+   ecx_BWR(context->port, 0x0000, ECT_REG_ALCTL, sizeof(b), &b, EC_TIMEOUTRET3);       /* Reset all slaves to Init */
+   ecx_BWR(context->port, 0x0000, ECT_REG_ALCTL, sizeof(b), &b, EC_TIMEOUTRET3);       /* Reset all slaves to Init */
+   wkc = ecx_BRD(context->port, 0x0000, ECT_REG_TYPE, sizeof(w), &w, EC_TIMEOUTSAFE);  /* detect number of slaves */
+   if (wkc != slavecount)
+   {
+      EC_PRINT("Snapshot has %d slaves, network has %d\n", slavecount, wkc);
+      return 0;
+   }
+   ecx_set_slaves_to_default(context);
+
+   /* address and verify slaves in blocks */
+   for (fslave = 1; fslave <= slavecount; fslave += n)
+   {
+      n = slavecount - fslave + 1;
+      if (n > EC_MAXMDATAGRAM)
+      {
+         n = EC_MAXMDATAGRAM;
+      }
+      for (i = 0; i < n; i++)
+      {
+         slave = fslave + i;
+         wdat[i] = htoes(context->slavelist[slave].configadr);
+         dg[i].com = EC_CMD_APWR;
+         dg[i].ADP = (uint16)(1 - slave);
+         dg[i].ADO = ECT_REG_STADR;
+         dg[i].length = sizeof(wdat[i]);
+         dg[i].data = &wdat[i];
+      }
+      if (ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET3) != n)
+      {
+         return 0;
+      }
+      for (i = 0; i < n; i++)
+      {
+         slave = fslave + i;
+         /* kill non ecat frames for first slave, pass all frames for following slaves */
+         wdat[i] = htoes((slave == 1) ? 1 : 0);
+         dg[i].com = EC_CMD_FPWR;
+         dg[i].ADP = context->slavelist[slave].configadr;
+         dg[i].ADO = ECT_REG_DLCTL;
+      }
+      if (ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET3) != n)
+      {
+         return 0;
+      }
+      for (i = 0; i < n; i++)
+      {
+         dg[i].com = EC_CMD_FPRD;
+         dg[i].ADO = ECT_REG_ALIAS;
+      }
+      if (ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET3) != n)
+      {
+         return 0;
+      }
+      for (i = 0; i < n; i++)
+      {
+         if (etohs(wdat[i]) != context->slavelist[fslave + i].aliasadr)
+         {
+            EC_PRINT("Slave %d alias differs from snapshot\n", fslave + i);
+            return 0;
+         }
+      }
+      for (si = 0; si < 3; si++)
+      {
+         if (!ecx_restore_readsii(context, fslave, n, siiaddr[si], edat))
+         {
+            return 0;
+         }
+         for (i = 0; i < n; i++)
+         {
+            sp = &(context->slavelist[fslave + i]);
+            expect = (si == 0) ? sp->eep_man : ((si == 1) ? sp->eep_id : sp->eep_rev);
+            if (edat[i] != expect)
+            {
+               EC_PRINT("Slave %d identity differs from snapshot\n", fslave + i);
+               return 0;
+            }
+         }
+      }
+   }
+   (void)ecx_statecheck(context, 0, EC_STATE_INIT, EC_TIMEOUTSTATE);
+
+   /* program SM and FMMU of all slaves, writing all SM in one datagram per slave */
+   for (fslave = 1; fslave <= slavecount; fslave += n)
+   {
+      n = slavecount - fslave + 1;
+      if (n > (EC_MAXMDATAGRAM / 2))
+      {
+         n = EC_MAXMDATAGRAM / 2;
+      }
+      k = 0;
+      for (i = 0; i < n; i++)
+      {
+         sp = &(context->slavelist[fslave + i]);
+         nSM = EC_MAXSM;
+         while ((nSM > 0) && !sp->SM[nSM - 1].StartAddr)
+         {
+            nSM--;
+         }
+         if (nSM)
+         {
+            dg[k].com = EC_CMD_FPWR;
+            dg[k].ADP = sp->configadr;
+            dg[k].ADO = ECT_REG_SM0;
+            dg[k].length = (uint16)(sizeof(ec_smt) * nSM);
+            dg[k].data = &(sp->SM[0]);
+            k++;
+         }
+         if (sp->FMMUunused)
+         {
+            dg[k].com = EC_CMD_FPWR;
+            dg[k].ADP = sp->configadr;
+            dg[k].ADO = ECT_REG_FMMU0;
+            dg[k].length = (uint16)(sizeof(ec_fmmut) * sp->FMMUunused);
+            dg[k].data = &(sp->FMMU[0]);
+            k++;
+         }
+      }
+      if (k && (ecx_multidatagram(context->port, dg, k, EC_TIMEOUTRET3) != k))
+      {
+         return 0;
+      }
+   }
+
+   /* DC offsets relative to master time, delays from snapshot topology */
+   if (context->slavelist[0].hasdc)
+   {
+      ht = 0;
+      ecx_BWR(context->port, 0, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);  /* latch DCrecvTimeA of all slaves */
+      mastertime = osal_current_time();
+      mastertime.sec -= 946684800UL;  /* EtherCAT uses 2000-01-01 as epoch start instead of 1970-01-01 */
+      mastertime64 = (((uint64)mastertime.sec * 1000000) + (uint64)mastertime.usec) * 1000;
+      slave = context->slavelist[0].DCnext;
+      while (slave > 0)
+      {
+         fslave = slave;
+         n = 0;
+         while ((slave > 0) && (n < (EC_MAXMDATAGRAM / 2)))
+         {
+            dg[n].com = EC_CMD_FPRD;
+            dg[n].ADP = context->slavelist[slave].configadr;
+            dg[n].ADO = ECT_REG_DCSOF;
+            dg[n].length = sizeof(dcdat[n]);
+            dg[n].data = &dcdat[n];
+            n++;
+            slave = context->slavelist[slave].DCnext;
+         }
+         if (ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET3) != n)
+         {
+            return 0;
+         }
+         slave = fslave;
+         for (i = 0; i < n; i++)
+         {
+            /* use it as offset in order to set local time around 0 + mastertime */
+            dcdat[i] = htoell(-etohll(dcdat[i]) + mastertime64);
+            dg[i].com = EC_CMD_FPWR;
+            dg[i].ADO = ECT_REG_DCSYSOFFSET;
+            delay[i] = htoel(context->slavelist[slave].pdelay);
+            dg[n + i].com = EC_CMD_FPWR;
+            dg[n + i].ADP = dg[i].ADP;
+            dg[n + i].ADO = ECT_REG_DCSYSDELAY;
+            dg[n + i].length = sizeof(delay[i]);
+            dg[n + i].data = &delay[i];
+            slave = context->slavelist[slave].DCnext;
+         }
+         if (ecx_multidatagram(context->port, dg, n * 2, EC_TIMEOUTRET3) != (n * 2))
+         {
+            return 0;
+         }
+      }
+   }
+
+   /* some slaves need eeprom available to PDI in init->preop transition,
+      with manual state change restore the eeprom owner of the snapshot */
+   b = 1;
+   for (fslave = 1; fslave <= slavecount; fslave += n)
+   {
+      n = slavecount - fslave + 1;
+      if (n > EC_MAXMDATAGRAM)
+      {
+         n = EC_MAXMDATAGRAM;
+      }
+      k = 0;
+      for (i = 0; i < n; i++)
+      {
+         sp = &(context->slavelist[fslave + i]);
+         if ((context->manualstatechange == 0) || sp->eep_pdi)
+         {
+            sp->eep_pdi = 1;
+            dg[k].com = EC_CMD_FPWR;
+            dg[k].ADP = sp->configadr;
+            dg[k].ADO = ECT_REG_EEPCFG;
+            dg[k].length = sizeof(b);
+            dg[k].data = &b;
+            k++;
+         }
+      }
+      if (k > 0)
+      {
+         ecx_multidatagram(context->port, dg, k, EC_TIMEOUTRET3);
+      }
+   }
+
+   /* User may override automatic state change */
+   if (context->manualstatechange == 0)
+   {
+      w = htoes(EC_STATE_PRE_OP | EC_STATE_ACK);
+      ecx_BWR(context->port, 0x0000, ECT_REG_ALCTL, sizeof(w), &w, EC_TIMEOUTRET3);
+      (void)ecx_statecheck(context, 0, EC_STATE_PRE_OP, EC_TIMEOUTSTATE);
+      for (slave = 1; slave <= slavecount; slave++)
+      {
+         /* execute special slave configuration hook Pre-Op to Safe-OP */
+         if (context->slavelist[slave].PO2SOconfig) /* only if registered */
+         {
+            context->slavelist[slave].PO2SOconfig(slave);
+         }
+         if (context->slavelist[slave].PO2SOconfigx) /* only if registered */
+         {
+            context->slavelist[slave].PO2SOconfigx(context, slave);
+         }
+      }
+      w = htoes(EC_STATE_SAFE_OP);
+      ecx_BWR(context->port, 0x0000, ECT_REG_ALCTL, sizeof(w), &w, EC_TIMEOUTRET3);
+   }
+
+   return slavecount;
+}
+
+/** Initialise cycle plan with defaults for a 100 Mbit/s line.
+ *
+ * @param[out] plan       = cycle plan
+ */
+void ec_cycleplan_init(ec_cycleplant *plan)
+{
+   memset(plan, 0, sizeof(*plan));
+   plan->linkspeed = 100000000;
+   plan->hostoverhead = 20000;
+   plan->slavedelay = 1000;
+}
+
+/* bytes on the wire of one frame with datalength bytes of datagrams,
+ * adds preamble, ethernet header, minimal frame size, FCS and gap */
+static uint32 ecx_cycleplan_wirebytes(uint32 datalength)
+{
+   uint32 length = ETH_HEADERSIZE + EC_ELENGTHSIZE + datalength;
+
+   if (length < 60)
+   {
+      length = 60;
+   }
+   return 8 + length + 4 + 12;
+}
+
+/* round trip delay of the segment from the port times latched by
+ * ecx_configdc(), slaves in front of the reference clock are estimated */
+static int64 ecx_cycleplan_loop(ecx_contextt *context, ec_cycleplant *plan)
+{
+   ec_slavet *ref;
+   int32 porttime[4];
+   int32 entry, loop;
+   uint16 refslave;
+   int p;
+
+   plan->measured = FALSE;
+   if (!context->slavelist[0].hasdc)
+   {
+      return (int64)*(context->slavecount) * plan->slavedelay;
+   }
+   refslave = context->slavelist[0].DCnext;
+   ref = &(context->slavelist[refslave]);
+   porttime[0] = ref->DCrtA;
+   porttime[1] = ref->DCrtB;
+   porttime[2] = ref->DCrtC;
+   porttime[3] = ref->DCrtD;
+   entry = porttime[ref->entryport & 3];
+   loop = 0;
+   for (p = 0; p < 4; p++)
+   {
+      if ((ref->activeports & (1 << p)) && ((porttime[p] - entry) > loop))
+      {
+         loop = porttime[p] - entry;
+      }
+   }
+   plan->measured = TRUE;
+   /* the reference itself and slaves in front of it are not in the port times */
+   return (int64)loop + ((int64)refslave * plan->slavedelay);
+}
+
+/* datagram bytes of a piggyback datagram with length bytes of data */
+#define EC_PLANDGSIZE(length) (EC_HEADERSIZE - EC_ELENGTHSIZE + (length) + EC_WKCSIZE)
+
+/* worst case datagram bytes per cycle of the mailbox datagrams that the
+ * asynchronous SDO engine and the EoE gateway add to the process data frames */
+static uint32 ecx_cycleplan_mbx(ecx_contextt *context)
+{
+   ec_slavet *slavep;
+   uint32 length;
+   uint16 slave, slavecount;
+   int i, requests;
+
+   length = 0;
+   slavecount = *(context->slavecount);
+   if (slavecount >= EC_MAXSLAVE)
+   {
+      slavecount = EC_MAXSLAVE - 1;
+   }
+   if (context->SDOasync)
+   {
+      /* one request per slave in flight, each with its largest mailbox datagram */
+      requests = 0;
+      for (slave = 1; (slave <= slavecount) && (requests < EC_MAXSDOASYNC); slave++)
+      {
+         slavep = &(context->slavelist[slave]);
+         if (slavep->mbx_proto & ECT_MBXPROT_COE)
+         {
+            length += EC_PLANDGSIZE((slavep->mbx_l > slavep->mbx_rl) ? slavep->mbx_l : slavep->mbx_rl);
+            requests++;
+         }
+      }
+   }
+   if (context->EOEgw)
+   {
+      /* one fragment write and one mailbox read per served slave */
+      for (i = 0; i < context->EOEgw->slaves; i++)
+      {
+         slavep = &(context->slavelist[context->EOEgw->slave[i].slave]);
+         length += EC_PLANDGSIZE(slavep->mbx_l) + EC_PLANDGSIZE(slavep->mbx_rl);
+      }
+   }
+   return length;
+}
+
+/** Estimate whether a cycle time is achievable with the mapped groups.
+ * For every group the process data frames are laid out as the send
+ * function does, from IOsegment[], nsegments, blockLRW and the DC datagram.
+ * The first frame of a DC group also carries the master clock write of
+ * ecx_dcmaster_init() and the reads of ecx_dcmon_start() when enabled.
+ * The wire time of these frames, the round trip delay of the segment and
+ * the host overhead give the exchange time of the group. The round trip
+ * delay is measured from the DC port times when ecx_configdc() ran before,
+ * otherwise it is estimated from the slave count. The mailbox datagrams of
+ * the asynchronous SDO engine and the EoE gateway go into frames of any
+ * group, their worst case is added once to mincycle.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  cycletime  = wanted cycle time in ns
+ * @param[in,out] plan    = cycle plan, see ec_cycleplan_init()
+ * @return TRUE if all groups fit in one cycle
+ */
+boolean ecx_cycleplan(ecx_contextt *context, int64 cycletime, ec_cycleplant *plan)
+{
+   ec_groupt *grp;
+   ec_plangroupt *pg;
+   uint32 length, sublength, datalength, dclength;
+   int group, maxgroup;
+   uint16 segment;
+   boolean first;
+
+   plan->looptime = ecx_cycleplan_loop(context, plan);
+   /* DC datagrams in the first frame of a DC group */
+   dclength = EC_PLANDGSIZE(sizeof(int64));
+   if (context->DCmaster)
+   {
+      dclength += EC_PLANDGSIZE(sizeof(uint32));
+   }
+   if (context->DCmon)
+   {
+      dclength += context->DCmon->perframe * EC_PLANDGSIZE(sizeof(uint32));
+   }
+   plan->mbxbytes = ecx_cycleplan_mbx(context);
+   plan->mbxtime = ((int64)plan->mbxbytes * 8 * 1000000000LL) / plan->linkspeed;
+   plan->mincycle = plan->mbxtime;
+   maxgroup = (context->maxgroup < EC_MAXGROUP) ? context->maxgroup : EC_MAXGROUP;
+   for (group = 0; group < maxgroup; group++)
+   {
+      grp = &(context->grouplist[group]);
+      pg = &(plan->group[group]);
+      memset(pg, 0, sizeof(*pg));
+      if (((grp->Obytes + grp->Ibytes) == 0) || (grp->nsegments == 0))
+      {
+         continue;
+      }
+      first = grp->hasdc;
+      if (grp->blockLRW)
+      {
+         /* LRD of inputs starting in Isegment, then LWR of outputs */
+         length = grp->Ibytes;
+         for (segment = grp->Isegment; length && (segment < grp->nsegments); segment++)
+         {
+            sublength = grp->IOsegment[segment];
+            if (segment == grp->Isegment)
+            {
+               sublength -= grp->Ioffset;
+            }
+            if (sublength > length)
+            {
+               sublength = length;
+            }
+            datalength = EC_PLANDGSIZE(sublength);
+            if (first)
+            {
+               datalength += dclength;
+               first = FALSE;
+            }
+            pg->wirebytes += ecx_cycleplan_wirebytes(datalength);
+            pg->frames++;
+            length -= sublength;
+         }
+         length = grp->Obytes;
+         for (segment = 0; length && (segment < grp->nsegments); segment++)
+         {
+            sublength = (grp->IOsegment[segment] < length) ? grp->IOsegment[segment] : length;
+            datalength = EC_PLANDGSIZE(sublength);
+            if (first)
+            {
+               datalength += dclength;
+               first = FALSE;
+            }
+            pg->wirebytes += ecx_cycleplan_wirebytes(datalength);
+            pg->frames++;
+            length -= sublength;
+         }
+      }
+      else
+      {
+         /* one LRW per segment */
+         for (segment = 0; segment < grp->nsegments; segment++)
+         {
+            datalength = EC_PLANDGSIZE(grp->IOsegment[segment]);
+            if (first)
+            {
+               datalength += dclength;
+               first = FALSE;
+            }
+            pg->wirebytes += ecx_cycleplan_wirebytes(datalength);
+            pg->frames++;
+         }
+      }
+      pg->wiretime = ((int64)pg->wirebytes * 8 * 1000000000LL) / plan->linkspeed;
+      /* frames are forwarded on the fly, the segment delay adds once */
+      pg->exchangetime = pg->wiretime + plan->looptime + plan->hostoverhead;
+      pg->margin = cycletime - pg->exchangetime;
+      plan->mincycle += pg->exchangetime;
+   }
+   plan->margin = cycletime - plan->mincycle;
+   return (plan->margin >= 0);
+}
+
 #ifdef EC_VER1
 /** Enumerate and init all slaves.
  *
@@ -1803,4 +3072,52 @@ int ec_reconfig_slave(uint16 slave, int timeout)
 {
    return ecx_reconfig_slave(&ecx_context, slave, timeout);
 }
+
+/** Save configuration snapshot.
+ *
+ * @param[in]  pIOmap     = pointer to IOmap used in ec_config_map_group()
+ * @param[out] buf        = buffer for snapshot, NULL to query needed size
+ * @param[in]  size       = size of buffer in bytes
+ * @return size of snapshot in bytes, 0 if buffer is too small
+ * @see ecx_config_snapshot_save
+ */
+int ec_config_snapshot_save(const void *pIOmap, void *buf, int size)
+{
+   return ecx_config_snapshot_save(&ecx_context, pIOmap, buf, size);
+}
+
+/** Load configuration snapshot into context.
+ *
+ * @param[in]  pIOmap     = pointer to IOmap
+ * @param[in]  buf        = buffer with snapshot
+ * @param[in]  size       = size of snapshot in bytes
+ * @return number of slaves in snapshot, 0 if snapshot is invalid
+ * @see ecx_config_snapshot_load
+ */
+int ec_config_snapshot_load(void *pIOmap, const void *buf, int size)
+{
+   return ecx_config_snapshot_load(&ecx_context, pIOmap, buf, size);
+}
+
+/** Restore network configuration from a loaded snapshot.
+ *
+ * @return Number of slaves restored, 0 if network does not match snapshot
+ * @see ecx_config_restore
+ */
+int ec_config_restore(void)
+{
+   return ecx_config_restore(&ecx_context);
+}
+
+/** Estimate whether a cycle time is achievable with the mapped groups.
+ *
+ * @param[in]  cycletime  = wanted cycle time in ns
+ * @param[in,out] plan    = cycle plan, see ec_cycleplan_init()
+ * @return TRUE if all groups fit in one cycle
+ * @see ecx_cycleplan
+ */
+boolean ec_cycleplan(int64 cycletime, ec_cycleplant *plan)
+{
+   return ecx_cycleplan(&ecx_context, cycletime, plan);
+}
 #endif
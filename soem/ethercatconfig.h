@@ -19,6 +19,48 @@ extern "C"
 #define EC_NODEOFFSET      0x1000
 #define EC_TEMPNODE        0xffff
 
+/** cycle time estimate of one group, see ecx_cycleplan() */
+typedef struct
+{
+   /** process data frames per cycle */
+   int     frames;
+   /** bytes on the wire per cycle, including preamble, FCS and gap */
+   uint32  wirebytes;
+   /** time to put the frames on the wire in ns */
+   int64   wiretime;
+   /** time from send to receive of all frames in ns */
+   int64   exchangetime;
+   /** cycle time minus exchangetime in ns, negative = not feasible */
+   int64   margin;
+} ec_plangroupt;
+
+/** cycle time feasibility plan, see ec_cycleplan_init() */
+typedef struct
+{
+   /** link speed in bit/s */
+   int64   linkspeed;
+   /** master send and receive overhead per group in ns */
+   int64   hostoverhead;
+   /** round trip delay per slave in ns, used where no DC port times exist */
+   int64   slavedelay;
+
+   /* results */
+   /** round trip delay of the segment in ns */
+   int64   looptime;
+   /** TRUE if looptime is measured from the port times of ecx_configdc() */
+   boolean measured;
+   /** estimate per group, groups without process data have no frames */
+   ec_plangroupt group[EC_MAXGROUP];
+   /** worst case datagram bytes per cycle of async SDO and EoE gateway */
+   uint32  mbxbytes;
+   /** time to put mbxbytes on the wire in ns */
+   int64   mbxtime;
+   /** sum of exchangetime of all groups plus mbxtime in ns */
+   int64   mincycle;
+   /** cycle time minus mincycle in ns */
+   int64   margin;
+} ec_cycleplant;
+
 #ifdef EC_VER1
 int ec_config_init(uint8 usetable);
 int ec_config_map(void *pIOmap);
@@ -31,6 +73,10 @@ int ec_config(uint8 usetable, void *pIOmap);
 int ec_config_overlap(uint8 usetable, void *pIOmap);
 int ec_recover_slave(uint16 slave, int timeout);
 int ec_reconfig_slave(uint16 slave, int timeout);
+int ec_config_snapshot_save(const void *pIOmap, void *buf, int size);
+int ec_config_snapshot_load(void *pIOmap, const void *buf, int size);
+int ec_config_restore(void);
+boolean ec_cycleplan(int64 cycletime, ec_cycleplant *plan);
 #endif
 
 int ecx_config_init(ecx_contextt *context, uint8 usetable);
@@ -39,6 +85,11 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
 int ecx_config_map_group_aligned(ecx_contextt *context, void *pIOmap, uint8 group);
 int ecx_recover_slave(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout);
+int ecx_config_snapshot_save(ecx_contextt *context, const void *pIOmap, void *buf, int size);
+int ecx_config_snapshot_load(ecx_contextt *context, void *pIOmap, const void *buf, int size);
+int ecx_config_restore(ecx_contextt *context);
+void ec_cycleplan_init(ec_cycleplant *plan);
+boolean ecx_cycleplan(ecx_contextt *context, int64 cycletime, ec_cycleplant *plan);
 
 #ifdef __cplusplus
 }
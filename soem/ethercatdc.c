@@ -8,6 +8,7 @@
  * Distributed Clock EtherCAT functions.
  *
  */
+#include <string.h>
 #include "oshw.h"
 #include "osal.h"
 #include "ethercattype.h"
@@ -23,6 +24,11 @@
 /** 1st sync pulse delay in ns here 100ms */
 #define SyncDelay       ((int32)100000000)
 
+/** number of DC slaves read or written per ecx_multidatagram call */
+#define DCMULTI         32
+/** size of latched DC registers, DCTIME0 up to and including DCSOF */
+#define DCLATCHSIZE     (ECT_REG_DCSYSOFFSET - ECT_REG_DCTIME0)
+
 /**
  * Set DC of slave to fire sync0 at CyclTime interval with CyclShift offset.
  *
@@ -144,6 +150,191 @@ void ecx_dcsync01(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclT
     context->slavelist[slave].DCcycle = CyclTime0;
 }
 
+
+/** number of datagrams per slave in the activation batch of ecx_dcsyncgroup() */
+#define DCSYNCDG        4
+
+/* program SYNC registers of all DC slaves of a group with one common start time */
+static int ecx_dcsyncgroup(ecx_contextt *context, uint8 group, boolean act, uint8 RA,
+                           uint32 CyclTime0, boolean sync1, uint32 CyclTime1,
+                           uint32 TrueCyclTime, int32 CyclShift)
+{
+   ec_mdatagramt dg[DCMULTI * DCSYNCDG + 1];
+   uint16 slave[DCMULTI];
+   uint16 i;
+   uint8 zero;
+   int64 t, t1;
+   int32 tc0, tc1;
+   int n, j, k, d, per, cnt;
+
+   if (!context->slavelist[0].hasdc)
+   {
+      return 0;
+   }
+   zero = 0;
+   t1 = 0;
+   cnt = 0;
+   if (!act)
+   {
+      RA = 0;
+   }
+   /* stop cyclic operation and take write access of all DC slaves, then read
+    * the system time once from the reference clock */
+   n = 0;
+   d = 0;
+   for (i = 1; i <= *(context->slavecount); i++)
+   {
+      if (context->slavelist[i].hasdc &&
+          ((group == 0) || (group == context->slavelist[i].group)))
+      {
+         dg[d].com = EC_CMD_FPWR;
+         dg[d].ADP = context->slavelist[i].configadr;
+         dg[d].ADO = ECT_REG_DCSYNCACT;
+         dg[d].length = sizeof(zero);
+         dg[d].data = &zero;
+         d++;
+         dg[d] = dg[d - 1];
+         dg[d].ADO = ECT_REG_DCCUC;
+         d++;
+         n++;
+      }
+      if ((n == DCMULTI) || (i == *(context->slavecount)))
+      {
+         if (i == *(context->slavecount))
+         {
+            dg[d].com = EC_CMD_FPRD;
+            dg[d].ADP = context->slavelist[context->slavelist[0].DCnext].configadr;
+            dg[d].ADO = ECT_REG_DCSYSTIME;
+            dg[d].length = sizeof(t1);
+            dg[d].data = &t1;
+            d++;
+         }
+         (void)ecx_multidatagram(context->port, dg, d, EC_TIMEOUTRET);
+         n = 0;
+         d = 0;
+      }
+   }
+   t1 = etohll(t1);
+   if (t1 == 0)
+   {
+      /* no DC slave in group or reference did not answer */
+      return 0;
+   }
+
+   /* common first trigger time, a whole multiple of TrueCyclTime rounded up
+    * plus the shift time, so all slaves fire at the same moment */
+   if (CyclTime0 > 0)
+   {
+      t = ((t1 + SyncDelay) / TrueCyclTime) * TrueCyclTime + TrueCyclTime + CyclShift;
+   }
+   else
+   {
+      t = t1 + SyncDelay + CyclShift;
+   }
+   t = htoell(t);
+   tc0 = htoel(CyclTime0);
+   tc1 = htoel(CyclTime1);
+
+   /* start time, cycle times and activation, slaves handle the datagrams in
+    * frame order so activation follows the register writes */
+   per = sync1 ? DCSYNCDG : (DCSYNCDG - 1);
+   n = 0;
+   d = 0;
+   for (i = 1; i <= *(context->slavecount); i++)
+   {
+      if (context->slavelist[i].hasdc &&
+          ((group == 0) || (group == context->slavelist[i].group)))
+      {
+         slave[n] = i;
+         dg[d].com = EC_CMD_FPWR;
+         dg[d].ADP = context->slavelist[i].configadr;
+         dg[d].ADO = ECT_REG_DCSTART0;
+         dg[d].length = sizeof(t);
+         dg[d].data = &t;
+         d++;
+         dg[d] = dg[d - 1];
+         dg[d].ADO = ECT_REG_DCCYCLE0;
+         dg[d].length = sizeof(tc0);
+         dg[d].data = &tc0;
+         d++;
+         if (sync1)
+         {
+            dg[d] = dg[d - 1];
+            dg[d].ADO = ECT_REG_DCCYCLE1;
+            dg[d].data = &tc1;
+            d++;
+         }
+         dg[d] = dg[d - 1];
+         dg[d].ADO = ECT_REG_DCSYNCACT;
+         dg[d].length = sizeof(RA);
+         dg[d].data = &RA;
+         d++;
+         n++;
+      }
+      if ((n == DCMULTI) || ((n > 0) && (i == *(context->slavecount))))
+      {
+         (void)ecx_multidatagram(context->port, dg, d, EC_TIMEOUTRET);
+         for (j = 0; j < n; j++)
+         {
+            k = j * per;
+            while ((k < ((j + 1) * per)) && (dg[k].wkc == 1))
+            {
+               k++;
+            }
+            if (k == ((j + 1) * per))
+            {
+               cnt++;
+            }
+            context->slavelist[slave[j]].DCactive = (uint8)act;
+            context->slavelist[slave[j]].DCshift = CyclShift;
+            context->slavelist[slave[j]].DCcycle = CyclTime0;
+         }
+         n = 0;
+         d = 0;
+      }
+   }
+   return cnt;
+}
+
+/**
+ * Set DC of all DC slaves of a group to fire sync0 at CyclTime interval with
+ * CyclShift offset. The system time is read once and all slaves get the
+ * same start time, programmed in batched frames.
+ *
+ * @param[in]  context        = context struct
+ * @param [in] group            Group number, 0 = all slaves.
+ * @param [in] act              TRUE = active, FALSE = deactivated
+ * @param [in] CyclTime         Cycltime in ns.
+ * @param [in] CyclShift        CyclShift in ns.
+ * @return number of slaves programmed
+ */
+int ecx_dcsync0_group(ecx_contextt *context, uint8 group, boolean act, uint32 CyclTime, int32 CyclShift)
+{
+   return ecx_dcsyncgroup(context, group, act, 1 + 2, CyclTime, FALSE, 0, CyclTime, CyclShift);
+}
+
+/**
+ * Set DC of all DC slaves of a group to fire sync0 and sync1 at CyclTime
+ * interval with CyclShift offset. The system time is read once and all
+ * slaves get the same start time, programmed in batched frames.
+ *
+ * @param[in]  context        = context struct
+ * @param [in] group            Group number, 0 = all slaves.
+ * @param [in] act              TRUE = active, FALSE = deactivated
+ * @param [in] CyclTime0        Cycltime SYNC0 in ns.
+ * @param [in] CyclTime1        Cycltime SYNC1 in ns, see ecx_dcsync01().
+ * @param [in] CyclShift        CyclShift in ns.
+ * @return number of slaves programmed
+ */
+int ecx_dcsync01_group(ecx_contextt *context, uint8 group, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift)
+{
+   uint32 TrueCyclTime;
+
+   /* Sync1 can be used as a multiple of Sync0, use true cycle time */
+   TrueCyclTime = (CyclTime0 > 0) ? ((CyclTime1 / CyclTime0) + 1) * CyclTime0 : 0;
+   return ecx_dcsyncgroup(context, group, act, 1 + 2 + 4, CyclTime0, TRUE, CyclTime1, TrueCyclTime, CyclShift);
+}
+
 /* latched port time of slave */
 static int32 ecx_porttime(ecx_contextt *context, uint16 slave, uint8 port)
 {
@@ -243,34 +434,94 @@ static uint8 ecx_parentport(ecx_contextt *context, uint16 parent)
    return parentport;
 }
 
+/* read latched port times and receive time of all DC slaves, DCMULTI slaves
+ * per call, and set the system time offset so local time is around mastertime */
+static void ecx_dclatchread(ecx_contextt *context, uint64 mastertime64)
+{
+   ec_mdatagramt dg[DCMULTI];
+   uint8 latch[DCMULTI][DCLATCHSIZE];
+   int64 offset[DCMULTI];
+   uint16 slca[DCMULTI];
+   uint16 i;
+   int n, j;
+   int32 ht;
+   int64 hrt;
+
+   n = 0;
+   for (i = 1; i <= *(context->slavecount); i++)
+   {
+      if (context->slavelist[i].hasdc)
+      {
+         memset(latch[n], 0, DCLATCHSIZE);
+         slca[n] = i;
+         dg[n].com = EC_CMD_FPRD;
+         dg[n].ADP = context->slavelist[i].configadr;
+         dg[n].ADO = ECT_REG_DCTIME0;
+         dg[n].length = DCLATCHSIZE;
+         dg[n].data = latch[n];
+         n++;
+      }
+      if ((n == DCMULTI) || ((n > 0) && (i == *(context->slavecount))))
+      {
+         /* DCrecvTime A..D and 64bit DCrecvTimeA of each slave in one datagram */
+         (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         for (j = 0; j < n; j++)
+         {
+            memcpy(&ht, &latch[j][ECT_REG_DCTIME0 - ECT_REG_DCTIME0], sizeof(ht));
+            context->slavelist[slca[j]].DCrtA = etohl(ht);
+            memcpy(&ht, &latch[j][ECT_REG_DCTIME1 - ECT_REG_DCTIME0], sizeof(ht));
+            context->slavelist[slca[j]].DCrtB = etohl(ht);
+            memcpy(&ht, &latch[j][ECT_REG_DCTIME2 - ECT_REG_DCTIME0], sizeof(ht));
+            context->slavelist[slca[j]].DCrtC = etohl(ht);
+            memcpy(&ht, &latch[j][ECT_REG_DCTIME3 - ECT_REG_DCTIME0], sizeof(ht));
+            context->slavelist[slca[j]].DCrtD = etohl(ht);
+            memcpy(&hrt, &latch[j][ECT_REG_DCSOF - ECT_REG_DCTIME0], sizeof(hrt));
+            /* use it as offset in order to set local time around 0 + mastertime */
+            offset[j] = htoell(-etohll(hrt) + mastertime64);
+            /* save it in the offset register */
+            dg[j].com = EC_CMD_FPWR;
+            dg[j].ADO = ECT_REG_DCSYSOFFSET;
+            dg[j].length = sizeof(offset[j]);
+            dg[j].data = &offset[j];
+         }
+         (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         n = 0;
+      }
+   }
+}
+
 /**
  * Locate DC slaves, measure propagation delays.
+ * The latched times of all slaves are read and the offsets and delays are
+ * written with multiple datagrams per frame.
  *
  * @param[in]  context        = context struct
  * @return boolean if slaves are found with DC
  */
 boolean ecx_configdc(ecx_contextt *context)
 {
-   uint16 i, slaveh, parent, child;
+   uint16 i, parent, child;
    uint16 parenthold = 0;
    uint16 prevDCslave = 0;
    int32 ht, dt1, dt2, dt3;
-   int64 hrt;
    uint8 entryport;
    int8 nlist;
    int8 plist[4];
    int32 tlist[4];
-   ec_timet mastertime;
    uint64 mastertime64;
+   ec_mdatagramt dg[DCMULTI];
+   int32 delay[DCMULTI];
+   int n;
 
    context->slavelist[0].hasdc = FALSE;
    context->grouplist[0].hasdc = FALSE;
    ht = 0;
 
    ecx_BWR(context->port, 0, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);  /* latch DCrecvTimeA of all slaves */
-   mastertime = osal_current_time();
-   mastertime.sec -= 946684800UL;  /* EtherCAT uses 2000-01-01 as epoch start instead of 1970-01-01 */
-   mastertime64 = (((uint64)mastertime.sec * 1000000) + (uint64)mastertime.usec) * 1000;
+   /* EtherCAT uses 2000-01-01 as epoch start instead of 1970-01-01 */
+   mastertime64 = osal_realtime_ns() - (946684800ULL * 1000000000ULL);
+   ecx_dclatchread(context, mastertime64);
+   n = 0;
    for (i = 1; i <= *(context->slavecount); i++)
    {
       context->slavelist[i].consumedports = context->slavelist[i].activeports;
@@ -292,21 +543,6 @@ boolean ecx_configdc(ecx_contextt *context)
          /* this branch has DC slave so remove parenthold */
          parenthold = 0;
          prevDCslave = i;
-         slaveh = context->slavelist[i].configadr;
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtA = etohl(ht);
-         /* 64bit latched DCrecvTimeA of each specific slave */
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCSOF, sizeof(hrt), &hrt, EC_TIMEOUTRET);
-         /* use it as offset in order to set local time around 0 + mastertime */
-         hrt = htoell(-etohll(hrt) + mastertime64);
-         /* save it in the offset register */
-         (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSOFFSET, sizeof(hrt), &hrt, EC_TIMEOUTRET);
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME1, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtB = etohl(ht);
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME2, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtC = etohl(ht);
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME3, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtD = etohl(ht);
 
          /* make list of active ports and their time stamps */
          nlist = 0;
@@ -403,9 +639,14 @@ boolean ecx_configdc(ecx_contextt *context)
             /* assumption : forward delay equals return delay */
             context->slavelist[i].pdelay = ((dt3 - dt1) / 2) + dt2 +
                context->slavelist[parent].pdelay;
-            ht = htoel(context->slavelist[i].pdelay);
-            /* write propagation delay*/
-            (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSDELAY, sizeof(ht), &ht, EC_TIMEOUTRET);
+            delay[n] = htoel(context->slavelist[i].pdelay);
+            /* queue write of propagation delay */
+            dg[n].com = EC_CMD_FPWR;
+            dg[n].ADP = context->slavelist[i].configadr;
+            dg[n].ADO = ECT_REG_DCSYSDELAY;
+            dg[n].length = sizeof(delay[n]);
+            dg[n].data = &delay[n];
+            n++;
          }
       }
       else
@@ -425,11 +666,903 @@ boolean ecx_configdc(ecx_contextt *context)
             parenthold = 0;
          }
       }
+      if ((n == DCMULTI) || ((n > 0) && (i == *(context->slavecount))))
+      {
+         /* write propagation delays */
+         (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         n = 0;
+      }
    }
 
    return context->slavelist[0].hasdc;
 }
 
+/** number of datagrams per frame in drift compensation burst */
+#define DCDRIFTMULTI    64
+/** number of burst frames between checks of the system time difference */
+#define DCDRIFTCHECK    10
+
+/* convert system time difference register, bit 31 is sign, bits 0..30 value */
+static int32 ecx_dcsysdiff(uint32 reg)
+{
+   int32 diff = (int32)(reg & 0x7fffffff);
+
+   return (reg & 0x80000000) ? -diff : diff;
+}
+
+/* read system time difference of all DC slaves, returns max. absolute value
+ * or -1 if a slave did not answer */
+static int32 ecx_dcmaxdiff(ecx_contextt *context)
+{
+   ec_mdatagramt dg[DCMULTI];
+   uint32 reg[DCMULTI];
+   uint16 i;
+   int32 diff, maxdiff;
+   int n, j;
+
+   maxdiff = 0;
+   n = 0;
+   for (i = 1; i <= *(context->slavecount); i++)
+   {
+      if (context->slavelist[i].hasdc)
+      {
+         reg[n] = 0;
+         dg[n].com = EC_CMD_FPRD;
+         dg[n].ADP = context->slavelist[i].configadr;
+         dg[n].ADO = ECT_REG_DCSYSDIFF;
+         dg[n].length = sizeof(reg[n]);
+         dg[n].data = &reg[n];
+         n++;
+      }
+      if ((n == DCMULTI) || ((n > 0) && (i == *(context->slavecount))))
+      {
+         (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         for (j = 0; j < n; j++)
+         {
+            if (dg[j].wkc != 1)
+            {
+               return -1;
+            }
+            diff = ecx_dcsysdiff(etohl(reg[j]));
+            if (diff < 0)
+            {
+               diff = -diff;
+            }
+            if (diff > maxdiff)
+            {
+               maxdiff = diff;
+            }
+         }
+         n = 0;
+      }
+   }
+   return maxdiff;
+}
+
+/**
+ * Static drift compensation burst after ecx_configdc().
+ * The system time of the reference clock is distributed to all DC slaves with
+ * many FRMW datagrams per frame, so the slave clocks adjust their speed before
+ * the cyclic process data starts. After every DCDRIFTCHECK frames the system
+ * time difference registers of all DC slaves are read in batched frames. The
+ * burst stops when all differences are below threshold.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  maxframes      = max. number of burst frames, e.g. 250 for
+ *                              about 15000 datagrams
+ * @param[in]  threshold      = max. allowed system time difference in ns
+ * @param[out] maxdiff        = largest absolute system time difference in ns
+ *                              after the burst, -1 if not read. NULL = not used
+ * @return TRUE if all DC slaves converged below threshold
+ */
+boolean ecx_dcdriftcomp(ecx_contextt *context, int maxframes, int32 threshold, int32 *maxdiff)
+{
+   ec_mdatagramt dg[DCDRIFTMULTI];
+   int64 systime[DCDRIFTMULTI];
+   uint16 refadr;
+   int32 diff;
+   int frames, j;
+
+   diff = -1;
+   if (!context->slavelist[0].hasdc)
+   {
+      if (maxdiff)
+      {
+         *maxdiff = diff;
+      }
+      return FALSE;
+   }
+   refadr = context->slavelist[context->slavelist[0].DCnext].configadr;
+   for (j = 0; j < DCDRIFTMULTI; j++)
+   {
+      dg[j].com = EC_CMD_FRMW;
+      dg[j].ADP = refadr;
+      dg[j].ADO = ECT_REG_DCSYSTIME;
+      dg[j].length = sizeof(systime[j]);
+      dg[j].data = &systime[j];
+   }
+   frames = 0;
+   while (frames < maxframes)
+   {
+      for (j = 0; (j < DCDRIFTCHECK) && (frames < maxframes); j++, frames++)
+      {
+         memset(systime, 0, sizeof(systime));
+         (void)ecx_multidatagram(context->port, dg, DCDRIFTMULTI, EC_TIMEOUTRET);
+      }
+      diff = ecx_dcmaxdiff(context);
+      if ((diff >= 0) && (diff < threshold))
+      {
+         break;
+      }
+   }
+   if (maxdiff)
+   {
+      *maxdiff = diff;
+   }
+   return ((diff >= 0) && (diff < threshold));
+}
+
+/** Initialise DC cycle scheduler with default controller settings.
+ *
+ * The defaults lock a 1 kHz to 8 kHz loop within about a hundred cycles. The
+ * hooks, group and tuning can be changed before ecx_dcsched_run() is called.
+ *
+ * @param[out] sched        = scheduler
+ * @param[in]  cycletime    = cycle time in ns
+ * @param[in]  shift        = wanted DC time of frame relative to DC cycle start in ns
+ */
+void ec_dcsched_init(ec_dcschedt *sched, int64 cycletime, int64 shift)
+{
+   memset(sched, 0, sizeof(*sched));
+   sched->cycletime = cycletime;
+   sched->shift = shift;
+   sched->kp = 0.1;
+   sched->ki = 0.005;
+   sched->maxcorr = cycletime / 10;
+   sched->lockwindow = 1000;
+   sched->lockcycles = 100;
+   sched->timeout = EC_TIMEOUTRET;
+   sched->run = TRUE;
+}
+
+/* PI controller, steers the master cycle start to the DC time of the last frame */
+static void ecx_dcsched_pi(ec_dcschedt *sched, int64 dctime)
+{
+   int64 delta, corr, absdelta;
+   float64 ilimit;
+
+   delta = (dctime - sched->shift) % sched->cycletime;
+   if (delta > (sched->cycletime / 2))
+   {
+      delta -= sched->cycletime;
+   }
+   else if (delta < -(sched->cycletime / 2))
+   {
+      delta += sched->cycletime;
+   }
+   sched->integral += (float64)delta;
+   /* anti windup, integral part alone may not exceed max. correction */
+   if (sched->ki > 0.0)
+   {
+      ilimit = (float64)sched->maxcorr / sched->ki;
+      if (sched->integral > ilimit)
+      {
+         sched->integral = ilimit;
+      }
+      else if (sched->integral < -ilimit)
+      {
+         sched->integral = -ilimit;
+      }
+   }
+   corr = -(int64)((sched->kp * (float64)delta) + (sched->ki * sched->integral));
+   if (corr > sched->maxcorr)
+   {
+      corr = sched->maxcorr;
+   }
+   else if (corr < -sched->maxcorr)
+   {
+      corr = -sched->maxcorr;
+   }
+   sched->delta = delta;
+   sched->correction = corr;
+   /* integral part compensates the clock drift in steady state */
+   sched->drift = (sched->ki * sched->integral * 1000000.0) / (float64)sched->cycletime;
+
+   absdelta = (delta < 0) ? -delta : delta;
+   if (absdelta <= sched->lockwindow)
+   {
+      if (sched->inwindow < sched->lockcycles)
+      {
+         sched->inwindow++;
+      }
+      else if (!sched->locked)
+      {
+         sched->locked = TRUE;
+         sched->deltamin = delta;
+         sched->deltamax = delta;
+      }
+   }
+   else
+   {
+      if (sched->locked)
+      {
+         sched->lockloss++;
+      }
+      sched->locked = FALSE;
+      sched->inwindow = 0;
+   }
+   if (sched->locked)
+   {
+      if (delta < sched->deltamin)
+      {
+         sched->deltamin = delta;
+      }
+      if (delta > sched->deltamax)
+      {
+         sched->deltamax = delta;
+      }
+   }
+}
+
+/** Run one cycle of the DC cycle scheduler.
+ *
+ * Sleeps until the next cycle start on the monotonic clock, calls the pre
+ * hook, exchanges process data of the group, calls the post hook and
+ * corrects the next cycle start with the PI controller so that the frame
+ * passes the DC reference clock at shift within the DC cycle.
+ *
+ * @param[in]  context      = context struct
+ * @param[in,out] sched     = scheduler, see ec_dcsched_init()
+ */
+void ecx_dcsched_cycle(ecx_contextt *context, ec_dcschedt *sched)
+{
+   int64 latency;
+
+   if (sched->next == 0)
+   {
+      /* first cycle starts on a cycle boundary of the monotonic clock */
+      sched->next = ((osal_monotonic_ns() / sched->cycletime) + 1) * sched->cycletime;
+   }
+   (void)osal_sleep_until_ns(sched->next);
+   latency = (int64)(osal_monotonic_ns() - sched->next);
+   if (latency > sched->latencymax)
+   {
+      sched->latencymax = latency;
+   }
+   if (latency > (sched->cycletime / 2))
+   {
+      sched->overruns++;
+   }
+   if (sched->pre)
+   {
+      sched->pre(context, sched);
+   }
+   (void)ecx_send_processdata_group(context, sched->group);
+   sched->wkc = ecx_receive_processdata_group(context, sched->group, sched->timeout);
+   if (sched->post)
+   {
+      sched->post(context, sched);
+   }
+   sched->correction = 0;
+   if (context->slavelist[0].hasdc && (sched->wkc > 0))
+   {
+      ecx_dcsched_pi(sched, *(context->DCtime));
+   }
+   sched->next += sched->cycletime + sched->correction;
+   /* skip cycles that are already over instead of running them late */
+   while ((int64)(osal_monotonic_ns() - sched->next) > sched->cycletime)
+   {
+      sched->next += sched->cycletime;
+      sched->overruns++;
+   }
+   sched->cycles++;
+}
+
+/** Run the DC cycle scheduler until sched->run is cleared.
+ *
+ * Meant to be the body of the real-time thread of the application.
+ *
+ * @param[in]  context      = context struct
+ * @param[in,out] sched     = scheduler, see ec_dcsched_init()
+ * @return number of cycles run
+ */
+int ecx_dcsched_run(ecx_contextt *context, ec_dcschedt *sched)
+{
+   while (sched->run)
+   {
+      ecx_dcsched_cycle(context, sched);
+   }
+   return (int)sched->cycles;
+}
+
+/** Initialise master clock reference with default controller settings.
+ *
+ * @param[out] dcm          = master clock reference
+ */
+void ec_dcmaster_defaults(ec_dcmastert *dcm)
+{
+   memset(dcm, 0, sizeof(*dcm));
+   dcm->kp = 0.2;
+   dcm->ki = 0.02;
+   dcm->maxcorr = 100000;
+}
+
+static uint64 ecx_dcmaster_hosttime(ec_dcmastert *dcm)
+{
+   return dcm->hosttime ? dcm->hosttime() : osal_monotonic_ns();
+}
+
+static void ecx_dcmaster_unaligned(ec_dcmastert *dcm, uint16 slave)
+{
+   if (dcm->unaligned == 0)
+   {
+      dcm->firstunaligned = slave;
+   }
+   dcm->unaligned++;
+}
+
+/**
+ * Make the host clock the DC reference of the segment.
+ * Call after ecx_configdc(). The offset between host clock and reference
+ * slave is measured and added to the system time offset 0x0920 of all DC
+ * slaves, so the segment jumps to host time while the slaves stay aligned
+ * to each other. From then on every process data frame with the DC FRMW also
+ * writes the host time to the reference slave, see ecx_dcmaster_tx(). Call
+ * again after a step of the host clock. Slaves whose offset read fails are
+ * not written and are counted in dcm->unaligned.
+ *
+ * @param[in]  context      = context struct
+ * @param[in,out] dcm       = master clock reference, see ec_dcmaster_defaults()
+ * @return TRUE if all DC slaves were aligned
+ */
+boolean ecx_dcmaster_init(ecx_contextt *context, ec_dcmastert *dcm)
+{
+   ec_mdatagramt dg[DCMULTI];
+   int64 offset[DCMULTI];
+   uint16 speed[DCMULTI];
+   uint16 slave[DCMULTI];
+   int64 le_systime, delta;
+   uint64 host;
+   uint16 i;
+   int n, m, j;
+
+   context->DCmaster = NULL;
+   dcm->unaligned = 0;
+   dcm->firstunaligned = 0;
+   if (!context->slavelist[0].hasdc)
+   {
+      return FALSE;
+   }
+   host = ecx_dcmaster_hosttime(dcm);
+   le_systime = 0;
+   if (ecx_FPRD(context->port, context->slavelist[context->slavelist[0].DCnext].configadr,
+                ECT_REG_DCSYSTIME, sizeof(le_systime), &le_systime, EC_TIMEOUTRET) != 1)
+   {
+      return FALSE;
+   }
+   delta = (int64)(host + dcm->delay) - (int64)etohll(le_systime);
+
+   n = 0;
+   for (i = 1; i <= *(context->slavecount); i++)
+   {
+      if (context->slavelist[i].hasdc)
+      {
+         slave[n] = i;
+         offset[n] = 0;
+         dg[n].com = EC_CMD_FPRD;
+         dg[n].ADP = context->slavelist[i].configadr;
+         dg[n].ADO = ECT_REG_DCSYSOFFSET;
+         dg[n].length = sizeof(offset[n]);
+         dg[n].data = &offset[n];
+         n++;
+      }
+      if ((n == DCMULTI) || ((n > 0) && (i == *(context->slavecount))))
+      {
+         /* read offsets and write them back shifted by delta, slaves with
+            unknown offset are skipped */
+         (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         m = 0;
+         for (j = 0; j < n; j++)
+         {
+            if (dg[j].wkc != 1)
+            {
+               ecx_dcmaster_unaligned(dcm, slave[j]);
+               continue;
+            }
+            slave[m] = slave[j];
+            offset[m] = htoell(etohll(offset[j]) + delta);
+            dg[m] = dg[j];
+            dg[m].com = EC_CMD_FPWR;
+            dg[m].data = &offset[m];
+            m++;
+         }
+         n = m;
+         if (n > 0)
+         {
+            (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         }
+         for (j = 0; j < n; j++)
+         {
+            if (dg[j].wkc != 1)
+            {
+               ecx_dcmaster_unaligned(dcm, slave[j]);
+            }
+         }
+         /* restart time control loops after the offset change */
+         if (dcm->speedstart && (n > 0))
+         {
+            for (j = 0; j < n; j++)
+            {
+               speed[j] = htoes(dcm->speedstart);
+               dg[j].ADP = context->slavelist[slave[j]].configadr;
+               dg[j].ADO = ECT_REG_DCSPEEDCNT;
+               dg[j].length = sizeof(speed[j]);
+               dg[j].data = &speed[j];
+            }
+            (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         }
+         n = 0;
+      }
+   }
+
+   dcm->cycles = 0;
+   dcm->lost = 0;
+   dcm->error = 0;
+   dcm->errormin = 0;
+   dcm->errormax = 0;
+   dcm->correction = 0;
+   dcm->integral = 0.0;
+   dcm->pending = FALSE;
+   context->DCmaster = dcm;
+   return (dcm->unaligned == 0);
+}
+
+/**
+ * Stop writing the host time, the first DC slave is the free running
+ * reference again.
+ *
+ * @param[in]  context      = context struct
+ */
+void ecx_dcmaster_stop(ecx_contextt *context)
+{
+   context->DCmaster = NULL;
+}
+
+/** Add the system time write of the master clock reference to a frame.
+ * Called by the process data send function after the DC FRMW was added.
+ *
+ * @param[in]  context      = context struct
+ * @param[in]  idx          = index of frame being built
+ * @param[in]  group        = group of the frame
+ */
+void ecx_dcmaster_tx(ecx_contextt *context, uint8 idx, uint8 group)
+{
+   ec_dcmastert *dcm = context->DCmaster;
+   ecx_portt *port;
+
+   if (dcm == NULL)
+   {
+      return;
+   }
+   port = context->port;
+   if ((port->txbuflength[idx] + EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + (int)sizeof(dcm->txvalue)) >
+       (int)(ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + EC_MAXLRWDATA))
+   {
+      return;
+   }
+   dcm->target = ecx_dcmaster_hosttime(dcm) + dcm->delay;
+   /* lower 32 bits are enough, the ESC compares with its local copy */
+   dcm->txvalue = htoel((uint32)(dcm->target - dcm->correction));
+   ecx_appenddatagram(port, idx);
+   dcm->offset = ecx_adddatagram(port, &(port->txbuf[idx]), EC_CMD_FPWR, idx, FALSE,
+                                 context->slavelist[context->grouplist[group].DCnext].configadr,
+                                 ECT_REG_DCSYSTIME, sizeof(dcm->txvalue), &(dcm->txvalue));
+   dcm->idx = idx;
+   dcm->pending = TRUE;
+}
+
+/** Run the controller of the master clock reference on a received frame.
+ * Called by the process data receive function after the DC time was updated.
+ *
+ * @param[in]  context      = context struct
+ * @param[in]  idx          = index of received frame
+ * @param[in]  wkc          = result of receiving the frame
+ */
+void ecx_dcmaster_rx(ecx_contextt *context, uint8 idx, int wkc)
+{
+   ec_dcmastert *dcm = context->DCmaster;
+   uint16 le_wkc;
+   int64 error, corr;
+   float64 ilimit;
+
+   if ((dcm == NULL) || !dcm->pending || (dcm->idx != idx))
+   {
+      return;
+   }
+   dcm->pending = FALSE;
+   le_wkc = 0;
+   if (wkc > EC_NOFRAME)
+   {
+      memcpy(&le_wkc, &(context->port->rxbuf[idx][dcm->offset + sizeof(dcm->txvalue)]), EC_WKCSIZE);
+   }
+   if (etohs(le_wkc) != 1)
+   {
+      dcm->lost++;
+      return;
+   }
+   /* DC time was read by the FRMW just before the write passed the reference */
+   error = *(context->DCtime) - (int64)dcm->target;
+   dcm->integral += (float64)error;
+   /* anti windup, integral part alone may not exceed max. correction */
+   if (dcm->ki > 0.0)
+   {
+      ilimit = (float64)dcm->maxcorr / dcm->ki;
+      if (dcm->integral > ilimit)
+      {
+         dcm->integral = ilimit;
+      }
+      else if (dcm->integral < -ilimit)
+      {
+         dcm->integral = -ilimit;
+      }
+   }
+   corr = (int64)((dcm->kp * (float64)error) + (dcm->ki * dcm->integral));
+   if (corr > dcm->maxcorr)
+   {
+      corr = dcm->maxcorr;
+   }
+   else if (corr < -dcm->maxcorr)
+   {
+      corr = -dcm->maxcorr;
+   }
+   dcm->correction = corr;
+   dcm->error = error;
+   if ((dcm->cycles == 0) || (error < dcm->errormin))
+   {
+      dcm->errormin = error;
+   }
+   if ((dcm->cycles == 0) || (error > dcm->errormax))
+   {
+      dcm->errormax = error;
+   }
+   dcm->cycles++;
+}
+
+/** Initialise DC monitor with default settings.
+ *
+ * @param[out] mon          = DC monitor
+ */
+void ec_dcmon_init(ec_dcmont *mon)
+{
+   memset(mon, 0, sizeof(*mon));
+   mon->perframe = 8;
+   mon->interval = 1;
+}
+
+/* histogram bin of a system time difference */
+static int ecx_dcmon_bin(int32 diff)
+{
+   uint32 v = (diff < 0) ? (uint32)(-diff) : (uint32)diff;
+   int bin = 0;
+
+   while (v && (bin < (EC_DCMONBINS - 1)))
+   {
+      v >>= 1;
+      bin++;
+   }
+   return bin;
+}
+
+/* writer lock of the statistics. ecx_dcmon_poll() waits for it, the process
+ * data thread only tries it and drops the samples of a frame when busy, so it
+ * never waits for a preempted poll. Both hold it for a few updates only. */
+static void ecx_dcmon_lock(ec_dcmont *mon)
+{
+   while (!osal_atomic_cas(&(mon->wlock), 0, 1))
+   {
+   }
+}
+
+static void ecx_dcmon_unlock(ec_dcmont *mon)
+{
+   osal_atomic_store(&(mon->wlock), 0);
+}
+
+/* add a sample to the statistics of a slave, called with the writer lock */
+static void ecx_dcmon_add(ec_dcmont *mon, uint16 slave, int32 diff)
+{
+   ec_dcmonslavet *st = &(mon->slave[slave]);
+
+   osal_atomic_add(&(mon->seq[slave]), 1);
+   if ((st->samples == 0) || (diff < st->min))
+   {
+      st->min = diff;
+   }
+   if ((st->samples == 0) || (diff > st->max))
+   {
+      st->max = diff;
+   }
+   st->last = diff;
+   st->hist[ecx_dcmon_bin(diff)]++;
+   st->samples++;
+   osal_atomic_add(&(mon->seq[slave]), 1);
+}
+
+/* clear all statistics if requested by the application, called with the
+ * writer lock */
+static void ecx_dcmon_checkreset(ecx_contextt *context, ec_dcmont *mon)
+{
+   uint16 i;
+
+   if (!mon->reset)
+   {
+      return;
+   }
+   for (i = 1; (i <= *(context->slavecount)) && (i < EC_MAXSLAVE); i++)
+   {
+      osal_atomic_add(&(mon->seq[i]), 1);
+      memset(&(mon->slave[i]), 0, sizeof(mon->slave[i]));
+      osal_atomic_add(&(mon->seq[i]), 1);
+   }
+   mon->reset = FALSE;
+}
+
+/**
+ * Start the DC monitor. Every interval cycles the process data frame with
+ * the DC FRMW also reads the system time difference of perframe DC slaves,
+ * round robin over all DC slaves.
+ *
+ * @param[in]  context      = context struct
+ * @param[in]  mon          = DC monitor, see ec_dcmon_init()
+ */
+void ecx_dcmon_start(ecx_contextt *context, ec_dcmont *mon)
+{
+   if (mon->perframe > EC_DCMONFRAME)
+   {
+      mon->perframe = EC_DCMONFRAME;
+   }
+   if (mon->interval == 0)
+   {
+      mon->interval = 1;
+   }
+   mon->count = 0;
+   mon->npending = 0;
+   context->DCmon = mon;
+}
+
+/**
+ * Stop reading the system time differences in the process data frames.
+ * The statistics stay in the monitor struct.
+ *
+ * @param[in]  context      = context struct
+ */
+void ecx_dcmon_stop(ecx_contextt *context)
+{
+   context->DCmon = NULL;
+}
+
+/**
+ * Read the system time difference of all DC slaves in batched frames and
+ * add them to the statistics. For use outside the process data thread, or
+ * from it when there is time left in the cycle. While poll adds samples the
+ * process data thread drops its reads, counted in mon->dropped.
+ *
+ * @param[in]  context      = context struct
+ * @return number of slaves read, -1 if monitor not started
+ */
+int ecx_dcmon_poll(ecx_contextt *context)
+{
+   ec_dcmont *mon = context->DCmon;
+   ec_mdatagramt dg[DCMULTI];
+   uint32 reg[DCMULTI];
+   uint16 slave[DCMULTI];
+   uint16 i;
+   int n, j, cnt;
+
+   if (mon == NULL)
+   {
+      return -1;
+   }
+   ecx_dcmon_lock(mon);
+   ecx_dcmon_checkreset(context, mon);
+   ecx_dcmon_unlock(mon);
+   cnt = 0;
+   n = 0;
+   for (i = 1; (i <= *(context->slavecount)) && (i < EC_MAXSLAVE); i++)
+   {
+      if (context->slavelist[i].hasdc)
+      {
+         slave[n] = i;
+         reg[n] = 0;
+         dg[n].com = EC_CMD_FPRD;
+         dg[n].ADP = context->slavelist[i].configadr;
+         dg[n].ADO = ECT_REG_DCSYSDIFF;
+         dg[n].length = sizeof(reg[n]);
+         dg[n].data = &reg[n];
+         n++;
+      }
+      if ((n == DCMULTI) || ((n > 0) && (i == *(context->slavecount))))
+      {
+         (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+         ecx_dcmon_lock(mon);
+         for (j = 0; j < n; j++)
+         {
+            if (dg[j].wkc == 1)
+            {
+               ecx_dcmon_add(mon, slave[j], ecx_dcsysdiff(etohl(reg[j])));
+               cnt++;
+            }
+         }
+         ecx_dcmon_unlock(mon);
+         n = 0;
+      }
+   }
+   return cnt;
+}
+
+/**
+ * Get a consistent snapshot of the statistics of a slave. Safe to call from
+ * any thread while the monitor runs.
+ *
+ * @param[in]  context      = context struct
+ * @param[in]  slave        = slave number
+ * @param[out] stat         = statistics and percentiles
+ * @return TRUE if the slave has samples
+ */
+boolean ecx_dcmon_read(ecx_contextt *context, uint16 slave, ec_dcmonstatt *stat)
+{
+   ec_dcmont *mon = context->DCmon;
+   uint32 seq, sum, n50, n99, n999;
+   boolean f50, f99, f999;
+   int bin;
+
+   memset(stat, 0, sizeof(*stat));
+   if ((mon == NULL) || (slave == 0) || (slave >= EC_MAXSLAVE))
+   {
+      return FALSE;
+   }
+   /* retry while the process data thread updates the slave */
+   do
+   {
+      seq = osal_atomic_load(&(mon->seq[slave]));
+      if (seq & 1)
+      {
+         continue;
+      }
+      stat->stat = mon->slave[slave];
+   } while ((seq & 1) || !osal_atomic_cas(&(mon->seq[slave]), seq, seq));
+   if (stat->stat.samples == 0)
+   {
+      return FALSE;
+   }
+   n50 = stat->stat.samples - (stat->stat.samples / 2);
+   n99 = stat->stat.samples - (stat->stat.samples / 100);
+   n999 = stat->stat.samples - (stat->stat.samples / 1000);
+   sum = 0;
+   f50 = f99 = f999 = FALSE;
+   for (bin = 0; bin < EC_DCMONBINS; bin++)
+   {
+      sum += stat->stat.hist[bin];
+      /* upper bound of bin, 0 for bin 0 */
+      if ((sum >= n50) && !f50)
+      {
+         stat->p50 = (int32)((1UL << bin) - 1);
+         f50 = TRUE;
+      }
+      if ((sum >= n99) && !f99)
+      {
+         stat->p99 = (int32)((1UL << bin) - 1);
+         f99 = TRUE;
+      }
+      if ((sum >= n999) && !f999)
+      {
+         stat->p999 = (int32)((1UL << bin) - 1);
+         f999 = TRUE;
+      }
+   }
+   return TRUE;
+}
+
+/** Add system time difference reads of the DC monitor to a frame.
+ * Called by the process data send function after the DC FRMW was added.
+ *
+ * @param[in]  context      = context struct
+ * @param[in]  idx          = index of frame being built
+ */
+void ecx_dcmon_tx(ecx_contextt *context, uint8 idx)
+{
+   ec_dcmont *mon = context->DCmon;
+   ecx_portt *port;
+   uint32 reg;
+   uint16 slave, checked;
+   uint16 slavecount;
+
+   if ((mon == NULL) || (mon->npending > 0))
+   {
+      return;
+   }
+   if (++mon->count < mon->interval)
+   {
+      return;
+   }
+   mon->count = 0;
+   port = context->port;
+   slavecount = *(context->slavecount);
+   if (slavecount >= EC_MAXSLAVE)
+   {
+      slavecount = EC_MAXSLAVE - 1;
+   }
+   reg = 0;
+   slave = mon->next;
+   for (checked = 0; (checked < slavecount) && (mon->npending < mon->perframe); checked++)
+   {
+      if ((slave == 0) || (slave > slavecount))
+      {
+         slave = 1;
+      }
+      if (context->slavelist[slave].hasdc)
+      {
+         if ((port->txbuflength[idx] + EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + (int)sizeof(reg)) >
+             (int)(ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + EC_MAXLRWDATA))
+         {
+            break;
+         }
+         ecx_appenddatagram(port, idx);
+         mon->poffset[mon->npending] = ecx_adddatagram(port, &(port->txbuf[idx]), EC_CMD_FPRD, idx, FALSE,
+                                                       context->slavelist[slave].configadr,
+                                                       ECT_REG_DCSYSDIFF, sizeof(reg), &reg);
+         mon->pslave[mon->npending] = slave;
+         mon->npending++;
+      }
+      slave++;
+   }
+   mon->next = slave;
+   mon->idx = idx;
+}
+
+/** Add the system time differences of a received frame to the statistics.
+ * Called by the process data receive function for each frame.
+ *
+ * @param[in]  context      = context struct
+ * @param[in]  idx          = index of received frame
+ * @param[in]  wkc          = result of receiving the frame
+ */
+void ecx_dcmon_rx(ecx_contextt *context, uint8 idx, int wkc)
+{
+   ec_dcmont *mon = context->DCmon;
+   uint8 *rxbuf;
+   uint32 reg;
+   uint16 le_wkc;
+   int i;
+
+   if ((mon == NULL) || (mon->npending == 0) || (mon->idx != idx))
+   {
+      return;
+   }
+   if (!osal_atomic_cas(&(mon->wlock), 0, 1))
+   {
+      mon->dropped++;
+      mon->npending = 0;
+      return;
+   }
+   ecx_dcmon_checkreset(context, mon);
+   if (wkc > EC_NOFRAME)
+   {
+      rxbuf = (uint8 *)&(context->port->rxbuf[idx]);
+      for (i = 0; i < mon->npending; i++)
+      {
+         memcpy(&le_wkc, &rxbuf[mon->poffset[i] + sizeof(reg)], EC_WKCSIZE);
+         if (etohs(le_wkc) == 1)
+         {
+            memcpy(&reg, &rxbuf[mon->poffset[i]], sizeof(reg));
+            ecx_dcmon_add(mon, mon->pslave[i], ecx_dcsysdiff(etohl(reg)));
+         }
+      }
+   }
+   ecx_dcmon_unlock(mon);
+   mon->npending = 0;
+}
+
 #ifdef EC_VER1
 void ec_dcsync0(uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift)
 {
@@ -441,8 +1574,58 @@ void ec_dcsync01(uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1,
    ecx_dcsync01(&ecx_context, slave, act, CyclTime0, CyclTime1, CyclShift);
 }
 
+int ec_dcsync0_group(uint8 group, boolean act, uint32 CyclTime, int32 CyclShift)
+{
+   return ecx_dcsync0_group(&ecx_context, group, act, CyclTime, CyclShift);
+}
+
+int ec_dcsync01_group(uint8 group, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift)
+{
+   return ecx_dcsync01_group(&ecx_context, group, act, CyclTime0, CyclTime1, CyclShift);
+}
+
 boolean ec_configdc(void)
 {
    return ecx_configdc(&ecx_context);
 }
+
+boolean ec_dcdriftcomp(int maxframes, int32 threshold, int32 *maxdiff)
+{
+   return ecx_dcdriftcomp(&ecx_context, maxframes, threshold, maxdiff);
+}
+
+int ec_dcsched_run(ec_dcschedt *sched)
+{
+   return ecx_dcsched_run(&ecx_context, sched);
+}
+
+boolean ec_dcmaster_init(ec_dcmastert *dcm)
+{
+   return ecx_dcmaster_init(&ecx_context, dcm);
+}
+
+void ec_dcmaster_stop(void)
+{
+   ecx_dcmaster_stop(&ecx_context);
+}
+
+void ec_dcmon_start(ec_dcmont *mon)
+{
+   ecx_dcmon_start(&ecx_context, mon);
+}
+
+void ec_dcmon_stop(void)
+{
+   ecx_dcmon_stop(&ecx_context);
+}
+
+int ec_dcmon_poll(void)
+{
+   return ecx_dcmon_poll(&ecx_context);
+}
+
+boolean ec_dcmon_read(uint16 slave, ec_dcmonstatt *stat)
+{
+   return ecx_dcmon_read(&ecx_context, slave, stat);
+}
 #endif
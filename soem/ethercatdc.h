@@ -16,15 +16,237 @@ extern "C"
 {
 #endif
 
+typedef struct ec_dcsched ec_dcschedt;
+
+/** application hook of the DC cycle scheduler */
+typedef void (*ec_dchookt)(ecx_contextt *context, ec_dcschedt *sched);
+
+/** DC synchronised cycle scheduler, see ecx_dcsched_run() */
+struct ec_dcsched
+{
+   /** cycle time in ns */
+   int64      cycletime;
+   /** wanted DC time of the frame passing the reference clock, relative to
+    * the DC cycle start in ns. Use a value before the SYNC0 shift. */
+   int64      shift;
+   /** proportional gain of the PI controller */
+   float64    kp;
+   /** integral gain of the PI controller */
+   float64    ki;
+   /** max. correction of the cycle start in ns per cycle */
+   int64      maxcorr;
+   /** phase error window in ns for lock */
+   int64      lockwindow;
+   /** number of cycles within lockwindow before locked is set */
+   uint32     lockcycles;
+   /** process data group */
+   uint8      group;
+   /** timeout in us for receiving process data */
+   int        timeout;
+   /** called before process data is sent, to write outputs. NULL = none */
+   ec_dchookt pre;
+   /** called after process data is received, to read inputs. NULL = none */
+   ec_dchookt post;
+   /** application data for the hooks */
+   void       *userdata;
+   /** scheduler runs while TRUE, clear from any thread to stop */
+   volatile boolean run;
+
+   /* statistics, written by the scheduler thread */
+   /** number of cycles run */
+   uint32     cycles;
+   /** workcounter of last process data exchange */
+   int        wkc;
+   /** TRUE if phase error stayed within lockwindow for lockcycles cycles */
+   boolean    locked;
+   /** number of times lock was lost */
+   uint32     lockloss;
+   /** phase error of last cycle in ns */
+   int64      delta;
+   /** min. and max. phase error since lock in ns */
+   int64      deltamin;
+   int64      deltamax;
+   /** correction of cycle start in last cycle in ns */
+   int64      correction;
+   /** drift of master clock against DC reference clock in ppm */
+   float64    drift;
+   /** max. wakeup latency in ns */
+   int64      latencymax;
+   /** cycles that started more than half a cycle late */
+   uint32     overruns;
+
+   /* scheduler state */
+   /** integral of phase error in ns */
+   float64    integral;
+   /** start of next cycle, monotonic time in ns */
+   uint64     next;
+   /** consecutive cycles within lockwindow */
+   uint32     inwindow;
+};
+
+/** Master clock as DC reference, see ecx_dcmaster_init().
+ *
+ * The master writes its host time to the system time register of the
+ * reference slave in every process data frame. The time control loop of the
+ * reference ESC adjusts its clock speed to the written value, all other DC
+ * slaves follow the reference by the cyclic FRMW. A PI controller in the
+ * master removes the remaining offset between host and reference.
+ */
+struct ec_dcmaster
+{
+   /** host clock in ns the segment follows, NULL = osal_monotonic_ns() */
+   uint64     (*hosttime)(void);
+   /** time from reading the host clock to the frame passing the reference
+    * slave in ns */
+   int64      delay;
+   /** proportional gain of the PI controller */
+   float64    kp;
+   /** integral gain of the PI controller */
+   float64    ki;
+   /** max. correction of the written system time in ns */
+   int64      maxcorr;
+   /** start value of the speed counter 0x0930 of all DC slaves, lower values
+    * steer faster. 0 = not written */
+   uint16     speedstart;
+
+   /** DC slaves not aligned by ecx_dcmaster_init(), their system time
+    * offset could not be read or written */
+   uint16     unaligned;
+   /** first DC slave not aligned, 0 = none */
+   uint16     firstunaligned;
+
+   /* statistics, written by the process data thread */
+   /** number of corrections written */
+   uint32     cycles;
+   /** frames where the system time write was not acknowledged */
+   uint32     lost;
+   /** offset of reference clock to host clock of last cycle in ns */
+   int64      error;
+   /** min. and max. offset since ecx_dcmaster_init() in ns */
+   int64      errormin;
+   int64      errormax;
+   /** correction of the written system time in last cycle in ns */
+   int64      correction;
+
+   /* controller state */
+   /** integral of offset in ns */
+   float64    integral;
+   /** host time written in the pending frame in ns */
+   uint64     target;
+   /** index and data offset of the pending system time write */
+   uint8      idx;
+   uint16     offset;
+   /** TRUE if a system time write is in flight */
+   boolean    pending;
+   /** little endian value of the pending system time write */
+   uint32     txvalue;
+};
+
+/** number of histogram bins of the DC monitor, bin 0 counts a system time
+ * difference of 0 ns, bin n counts 2^(n-1) up to 2^n - 1 ns */
+#define EC_DCMONBINS    32
+/** max. number of slaves read per process data frame by the DC monitor */
+#define EC_DCMONFRAME   16
+
+/** system time difference statistics of one slave */
+typedef struct
+{
+   /** number of samples */
+   uint32     samples;
+   /** last, min. and max. system time difference in ns */
+   int32      last;
+   int32      min;
+   int32      max;
+   /** histogram of the absolute system time difference */
+   uint32     hist[EC_DCMONBINS];
+} ec_dcmonslavet;
+
+/** snapshot of the statistics of one slave, see ecx_dcmon_read() */
+typedef struct
+{
+   ec_dcmonslavet stat;
+   /** upper bound of 50%, 99% and 99.9% of absolute differences in ns */
+   int32      p50;
+   int32      p99;
+   int32      p999;
+} ec_dcmonstatt;
+
+/** DC synchronisation monitor, see ecx_dcmon_start().
+ *
+ * Reads the system time difference register 0x092C of the DC slaves in
+ * the cyclic process data frame, or all at once with ecx_dcmon_poll(), and
+ * keeps statistics per slave that other threads can read at any time.
+ */
+struct ec_dcmon
+{
+   /** number of slaves read per process data frame, max. EC_DCMONFRAME */
+   int        perframe;
+   /** process data cycles between reads, 1 = every cycle */
+   uint32     interval;
+   /** set TRUE from any thread to clear all statistics */
+   volatile boolean reset;
+
+   /** statistics per slave, guarded by seq */
+   ec_dcmonslavet slave[EC_MAXSLAVE];
+   /** sequence counter per slave, odd while the statistics are written */
+   uint32     seq[EC_MAXSLAVE];
+
+   /* monitor state */
+   /** cycle counter for interval */
+   uint32     count;
+   /** slave read next */
+   uint16     next;
+   /** index of frame with pending reads */
+   uint8      idx;
+   /** number of pending reads, 0 = none */
+   int        npending;
+   /** slave and data offset of pending reads */
+   uint16     pslave[EC_DCMONFRAME];
+   uint16     poffset[EC_DCMONFRAME];
+   /** writer lock of the statistics, ecx_dcmon_poll() and the process data
+    * thread both add samples */
+   uint32     wlock;
+   /** frames whose reads were dropped while ecx_dcmon_poll() held the lock */
+   uint32     dropped;
+};
+
 #ifdef EC_VER1
 boolean ec_configdc();
 void ec_dcsync0(uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift);
 void ec_dcsync01(uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
+int ec_dcsync0_group(uint8 group, boolean act, uint32 CyclTime, int32 CyclShift);
+int ec_dcsync01_group(uint8 group, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
+boolean ec_dcdriftcomp(int maxframes, int32 threshold, int32 *maxdiff);
+int ec_dcsched_run(ec_dcschedt *sched);
+boolean ec_dcmaster_init(ec_dcmastert *dcm);
+void ec_dcmaster_stop(void);
+void ec_dcmon_start(ec_dcmont *mon);
+void ec_dcmon_stop(void);
+int ec_dcmon_poll(void);
+boolean ec_dcmon_read(uint16 slave, ec_dcmonstatt *stat);
 #endif
 
 boolean ecx_configdc(ecx_contextt *context);
 void ecx_dcsync0(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift);
 void ecx_dcsync01(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
+int ecx_dcsync0_group(ecx_contextt *context, uint8 group, boolean act, uint32 CyclTime, int32 CyclShift);
+int ecx_dcsync01_group(ecx_contextt *context, uint8 group, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
+boolean ecx_dcdriftcomp(ecx_contextt *context, int maxframes, int32 threshold, int32 *maxdiff);
+void ec_dcsched_init(ec_dcschedt *sched, int64 cycletime, int64 shift);
+void ecx_dcsched_cycle(ecx_contextt *context, ec_dcschedt *sched);
+int ecx_dcsched_run(ecx_contextt *context, ec_dcschedt *sched);
+void ec_dcmaster_defaults(ec_dcmastert *dcm);
+boolean ecx_dcmaster_init(ecx_contextt *context, ec_dcmastert *dcm);
+void ecx_dcmaster_stop(ecx_contextt *context);
+void ecx_dcmaster_tx(ecx_contextt *context, uint8 idx, uint8 group);
+void ecx_dcmaster_rx(ecx_contextt *context, uint8 idx, int wkc);
+void ec_dcmon_init(ec_dcmont *mon);
+void ecx_dcmon_start(ecx_contextt *context, ec_dcmont *mon);
+void ecx_dcmon_stop(ecx_contextt *context);
+int ecx_dcmon_poll(ecx_contextt *context);
+boolean ecx_dcmon_read(ecx_contextt *context, uint16 slave, ec_dcmonstatt *stat);
+void ecx_dcmon_tx(ecx_contextt *context, uint8 idx);
+void ecx_dcmon_rx(ecx_contextt *context, uint8 idx, int wkc);
 
 #ifdef __cplusplus
 }
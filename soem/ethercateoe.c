@@ -67,18 +67,22 @@ int ecx_EOEdefinehook(ecx_contextt *context, void *hook)
 int ecx_EOEsetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t * ipparam, int timeout)
 {
    ec_EOEt *EOEp, *aEOEp;  
-   ec_mbxbuft MbxIn, MbxOut;  
+   ec_mbxbuft *MbxIn, *MbxOut;  
    uint16 frameinfo1, result;
    uint8 cnt, data_offset;
    uint8 flags = 0;
    int wkc;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timout set to 0 */
-   wkc = ecx_mbxreceive(context,  slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aEOEp = (ec_EOEt *)&MbxIn;
-   EOEp = (ec_EOEt *)&MbxOut;  
+   wkc = ecx_mbxreceive(context,  slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aEOEp = (ec_EOEt *)MbxIn;
+   EOEp = (ec_EOEt *)MbxOut;  
    EOEp->mbxheader.address = htoes(0x0000);
    EOEp->mbxheader.priority = 0x00;
    data_offset = EOE_PARAM_OFFSET;
@@ -136,14 +140,14 @@ int ecx_EOEsetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
    EOEp->data[0] = flags;
 
    /* send EoE request to slave */
-   wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
 
    if (wkc > 0) /* succeeded to place mailbox in slave ? */
    {
       /* clean mailboxbuffer */
-      ec_clearmbx(&MbxIn);
+      MbxIn = ecx_mbxin(context, slave);
       /* read slave response */
-      wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+      wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
       if (wkc > 0) /* succeeded to read slave response ? */
       {
          /* slave response should be FoE */
@@ -179,17 +183,22 @@ int ecx_EOEsetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
 int ecx_EOEgetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t * ipparam, int timeout)
 {
    ec_EOEt *EOEp, *aEOEp;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint16 frameinfo1, eoedatasize;
    uint8 cnt, data_offset;
    uint8 flags = 0;
    int wkc;
 
    /* Empty slave out mailbox if something is in. Timout set to 0 */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aEOEp = (ec_EOEt *)&MbxIn;
-   EOEp = (ec_EOEt *)&MbxOut;
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aEOEp = (ec_EOEt *)MbxIn;
+   EOEp = (ec_EOEt *)MbxOut;
    EOEp->mbxheader.address = htoes(0x0000);
    EOEp->mbxheader.priority = 0x00;
    data_offset = EOE_PARAM_OFFSET;
@@ -209,13 +218,13 @@ int ecx_EOEgetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
    EOEp->data[0] = flags;
 
    /* send EoE request to slave */
-   wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
    if (wkc > 0) /* succeeded to place mailbox in slave ? */
    {
       /* clean mailboxbuffer */
-      ec_clearmbx(&MbxIn);
+      MbxIn = ecx_mbxin(context, slave);
       /* read slave response */
-      wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+      wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
       if (wkc > 0) /* succeeded to read slave response ? */
       {
          /* slave response should be FoE */
@@ -316,16 +325,20 @@ int ecx_EOEgetIp(ecx_contextt *context, uint16 slave, uint8 port, eoe_param_t *
 int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void *p, int timeout)
 {
    ec_EOEt *EOEp;
-   ec_mbxbuft MbxOut;
+   ec_mbxbuft *MbxOut;
    uint16 frameinfo1, frameinfo2;
    uint8 cnt, txfragmentno;  
    boolean  NotLast;
    int wkc, maxdata, txframesize, txframeoffset;
    const uint8 * buf = p;
-   static uint8_t txframeno = 0;
+   uint8 txframeno;
 
-   ec_clearmbx(&MbxOut);
-   EOEp = (ec_EOEt *)&MbxOut;
+   MbxOut = ecx_mbxout(context, slave);
+   if (MbxOut == NULL)
+   {
+      return 0;
+   }
+   EOEp = (ec_EOEt *)MbxOut;
    EOEp->mbxheader.address = htoes(0x0000);
    EOEp->mbxheader.priority = 0x00;
    /* data section=mailbox size - 6 mbx - 4 EoEh */
@@ -333,6 +346,7 @@ int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void
    txframesize = psize;
    txfragmentno = 0;
    txframeoffset = 0;
+   txframeno = context->slavelist[slave].eoe_frameno;
    NotLast = TRUE;
 
    do
@@ -363,6 +377,7 @@ int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void
       {
          frameinfo2 = frameinfo2 | (EOE_HDR_FRAME_OFFSET_SET(((psize + 31) >> 5)));
          txframeno++;
+         context->slavelist[slave].eoe_frameno = txframeno;
       }
       frameinfo2 = frameinfo2 | EOE_HDR_FRAME_NO_SET(txframeno);
 
@@ -379,7 +394,7 @@ int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void
       memcpy(EOEp->data, &buf[txframeoffset], txframesize);
 
       /* send EoE request to slave */
-      wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, timeout);
+      wkc = ecx_mbxsend(context, slave, MbxOut, timeout);
       if ((NotLast == TRUE)  && (wkc > 0))
       {
          txframeoffset += txframesize;
@@ -408,15 +423,19 @@ int ecx_EOEsend(ecx_contextt *context, uint16 slave, uint8 port, int psize, void
 int ecx_EOErecv(ecx_contextt *context, uint16 slave, uint8 port, int * psize, void *p, int timeout)
 {
    ec_EOEt *aEOEp;
-   ec_mbxbuft MbxIn;
+   ec_mbxbuft *MbxIn;
    uint16 frameinfo1, frameinfo2;
    uint8 rxfragmentno, rxframeno;
    boolean NotLast;
    int wkc, buffersize, rxframesize, rxframeoffset, eoedatasize;
    uint8 * buf = p;
    
-   ec_clearmbx(&MbxIn);
-   aEOEp = (ec_EOEt *)&MbxIn;
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
+   aEOEp = (ec_EOEt *)MbxIn;
    NotLast = TRUE;
    buffersize = *psize;
    rxfragmentno = 0;
@@ -424,7 +443,7 @@ int ecx_EOErecv(ecx_contextt *context, uint16 slave, uint8 port, int * psize, vo
    rxframeoffset = 0;
    
    /* Hang for a while if nothing is in */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+   wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
 
    while ((wkc > 0) && (NotLast == TRUE))
    {
@@ -479,18 +498,26 @@ int ecx_EOErecv(ecx_contextt *context, uint16 slave, uint8 port, int * psize, vo
             }
          }
 
-         if ((rxframeoffset + eoedatasize) <= buffersize)
+         if ((rxframeoffset + eoedatasize) > buffersize)
          {
-            memcpy(&buf[rxframeoffset], aEOEp->data, eoedatasize);
-            rxframeoffset += eoedatasize;
-            rxfragmentno++;
+            wkc = -EC_ERR_TYPE_EOE_INVALID_RX_DATA;
+            /* Exit here, a frame with a skipped fragment is dropped */
+            break;
          }
+         memcpy(&buf[rxframeoffset], aEOEp->data, eoedatasize);
+         rxframeoffset += eoedatasize;
+         rxfragmentno++;
 
          if (EOE_HDR_LAST_FRAGMENT_GET(frameinfo1))
          {
             /* Remove timestamp */
             if (EOE_HDR_TIME_APPEND_GET(frameinfo1))
             {
+               if (rxframeoffset < 4)
+               {
+                  wkc = -EC_ERR_TYPE_EOE_INVALID_RX_DATA;
+                  break;
+               }
                rxframeoffset -= 4;
             }
             NotLast = FALSE;
@@ -499,7 +526,7 @@ int ecx_EOErecv(ecx_contextt *context, uint16 slave, uint8 port, int * psize, vo
          else
          {
             /* Hang for a while if nothing is in */
-            wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+            wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
          }
       }
       else
@@ -523,7 +550,8 @@ int ecx_EOErecv(ecx_contextt *context, uint16 slave, uint8 port, int * psize, vo
 * @param[in,out] rxframeno     = Frame number
 * @param[in,out] psize         = Size in bytes of frame buffer.
 * @param[out] p                = Pointer to frame buffer
-* @return 0= if fragment OK, >0 if last fragment, <0 on error
+* @return 0= if fragment OK, >0 if last fragment, <0 on error, the frame is
+* dropped then and reassembly restarts with the next first fragment
 */
 int ecx_EOEreadfragment(
    ec_mbxbuft * MbxIn,
@@ -600,14 +628,21 @@ int ecx_EOEreadfragment(
          }
       }
 
-      /* Make sure we're inside expected frame size */
-      if (((*rxframeoffset + eoedatasize) <= *rxframesize) && 
-         ((*rxframeoffset + eoedatasize) <= *psize))
+      /* Make sure we're inside expected frame size, a frame with a skipped
+       * fragment is dropped */
+      if (((*rxframeoffset + eoedatasize) > *rxframesize) ||
+         ((*rxframeoffset + eoedatasize) > *psize))
       {
-         memcpy(&buf[*rxframeoffset], aEOEp->data, eoedatasize);
-         *rxframeoffset += eoedatasize;
-         *rxfragmentno += 1;
+         *rxfragmentno = 0;
+         *rxframesize = 0;
+         *rxframeoffset = 0;
+         *rxframeno = 0;
+         wkc = -EC_ERR_TYPE_EOE_INVALID_RX_DATA;
+         return wkc;
       }
+      memcpy(&buf[*rxframeoffset], aEOEp->data, eoedatasize);
+      *rxframeoffset += eoedatasize;
+      *rxfragmentno += 1;
 
       /* Is it the last fragment */
       if (EOE_HDR_LAST_FRAGMENT_GET(frameinfo1))
@@ -615,6 +650,15 @@ int ecx_EOEreadfragment(
          /* Remove timestamp */
          if (EOE_HDR_TIME_APPEND_GET(frameinfo1))
          {
+            if (*rxframeoffset < 4)
+            {
+               *rxfragmentno = 0;
+               *rxframesize = 0;
+               *rxframeoffset = 0;
+               *rxframeno = 0;
+               wkc = -EC_ERR_TYPE_EOE_INVALID_RX_DATA;
+               return wkc;
+            }
             *rxframeoffset -= 4;
          }
          *psize = *rxframeoffset;
@@ -632,3 +676,451 @@ int ecx_EOEreadfragment(
    }
    return wkc;
 }
+
+/* free frame slots in receive queue, one slot is kept for reassembly */
+#define EC_EOEGW_RXFREE(gws) \
+   ((EC_EOEGWFRAMES - 1) - (uint16)((gws)->rxhead - (gws)->rxtail))
+
+/** Start EoE gateway on all EoE capable slaves.
+*
+* The gateway moves Ethernet frames between queues and the slave mailboxes
+* without blocking. Its mailbox datagrams are added to the process data
+* frames, so the transfers are pipelined with the cyclic exchange and need no
+* extra frames. Frames are fragmented and reassembled per slave, fragments
+* read by other mailbox functions are reassembled as well. Call after
+* configuration, the slaves must be in PRE-OP or higher. The queues are not
+* protected, use the gateway functions from the thread that exchanges the
+* process data. Other mailbox messages read by the gateway are parked in the
+* mailbox pool of the slave, where ecx_mbxreceive() and the asynchronous SDO
+* engine take them, so CoE, SoE and FoE transfers to served slaves work.
+*
+* @param[in]  context = context struct
+* @param[in]  gw      = gateway storage, NULL stops the gateway
+* @return number of slaves served by the gateway
+*/
+int ecx_EOEgw_init(ecx_contextt *context, ec_EOEgwt *gw)
+{
+   ec_slavet *slavep;
+   uint16 slave;
+
+   context->EOEgw = NULL;
+   if (gw == NULL)
+   {
+      return 0;
+   }
+   memset(gw, 0, sizeof(*gw));
+   for (slave = 1; (slave <= *(context->slavecount)) && (gw->slaves < EC_MAXEOEGW); slave++)
+   {
+      slavep = &(context->slavelist[slave]);
+      if ((slavep->mbx_proto & ECT_MBXPROT_EOE) &&
+          (slavep->mbx_l > 0x0A) && (slavep->mbx_l <= EC_MAXMBX) &&
+          (slavep->mbx_rl > 0) && (slavep->mbx_rl <= EC_MAXMBX))
+      {
+         gw->slave[gw->slaves].slave = slave;
+         gw->slave[gw->slaves].txidx = -1;
+         gw->slave[gw->slaves].rxidx = -1;
+         gw->slaves++;
+      }
+   }
+   context->EOEgw = gw;
+   return gw->slaves;
+}
+
+/* gateway entry of slave, NULL if slave is not served */
+static ec_EOEgwslavet *ecx_EOEgw_slave(ecx_contextt *context, uint16 slave)
+{
+   ec_EOEgwt *gw = context->EOEgw;
+   int i;
+
+   if (gw)
+   {
+      for (i = 0; i < gw->slaves; i++)
+      {
+         if (gw->slave[i].slave == slave)
+         {
+            return &(gw->slave[i]);
+         }
+      }
+   }
+   return NULL;
+}
+
+/** Queue Ethernet frame for slave in the EoE gateway, non-blocking.
+*
+* @param[in]  context = context struct
+* @param[in]  slave   = Slave number
+* @param[in]  port    = Port number on slave if applicable
+* @param[in]  psize   = Size in bytes of frame
+* @param[in]  p       = Pointer to frame, copied in the queue
+* @return 1 if queued, 0 if the queue is full, EC_ERROR if the slave is not
+* served or the frame is too large
+*/
+int ecx_EOEgw_send(ecx_contextt *context, uint16 slave, uint8 port, int psize, const void *p)
+{
+   ec_EOEgwslavet *gws;
+   ec_EOEframet *frame;
+
+   gws = ecx_EOEgw_slave(context, slave);
+   if ((gws == NULL) || (psize <= 0) || (psize > EC_EOEMAXFRAME))
+   {
+      return EC_ERROR;
+   }
+   if ((uint16)(gws->txhead - gws->txtail) >= EC_EOEGWFRAMES)
+   {
+      return 0;
+   }
+   frame = &(gws->tx[gws->txhead % EC_EOEGWFRAMES]);
+   memcpy(frame->data, p, psize);
+   frame->size = (uint16)psize;
+   frame->port = port;
+   gws->txhead++;
+   return 1;
+}
+
+/** Get oldest received Ethernet frame from the EoE gateway, non-blocking.
+* The frame stays in its slot in the receive queue, no data is copied. It is
+* valid until it is released with ecx_EOEgw_release(). Slaves are served
+* round robin.
+*
+* @param[in]  context = context struct
+* @param[out] slave   = Slave number the frame is from
+* @return frame, NULL if no frame is available
+*/
+ec_EOEframet *ecx_EOEgw_peek(ecx_contextt *context, uint16 *slave)
+{
+   ec_EOEgwt *gw = context->EOEgw;
+   ec_EOEgwslavet *gws;
+   int i;
+
+   if (gw == NULL)
+   {
+      return NULL;
+   }
+   for (i = 0; i < gw->slaves; i++)
+   {
+      gws = &(gw->slave[(gw->next + i) % gw->slaves]);
+      if (gws->rxhead != gws->rxtail)
+      {
+         gw->next = (gw->next + i) % gw->slaves;
+         *slave = gws->slave;
+         return &(gws->rx[gws->rxtail % EC_EOEGWFRAMES]);
+      }
+   }
+   return NULL;
+}
+
+/** Release frame returned by ecx_EOEgw_peek(), its slot is reused for
+* reassembly.
+*
+* @param[in]  context = context struct
+* @param[in]  slave   = Slave number the frame is from
+*/
+void ecx_EOEgw_release(ecx_contextt *context, uint16 slave)
+{
+   ec_EOEgwt *gw = context->EOEgw;
+   ec_EOEgwslavet *gws;
+
+   gws = ecx_EOEgw_slave(context, slave);
+   if ((gws != NULL) && (gws->rxhead != gws->rxtail))
+   {
+      gws->rxtail++;
+      /* next slave first */
+      gw->next = (int)(gws - &(gw->slave[0]) + 1) % gw->slaves;
+   }
+}
+
+/** Get received Ethernet frame from the EoE gateway, non-blocking.
+* Copying variant of ecx_EOEgw_peek().
+*
+* @param[in]     context = context struct
+* @param[out]    slave   = Slave number the frame is from
+* @param[out]    port    = Port number on slave
+* @param[in,out] psize   = Size in bytes of frame buffer, returns frame size
+* @param[out]    p       = Pointer to frame buffer
+* @return 1 if a frame is returned, 0 if no frame is available, EC_ERROR if
+* the frame buffer is too small, the frame is dropped then
+*/
+int ecx_EOEgw_recv(ecx_contextt *context, uint16 *slave, uint8 *port, int *psize, void *p)
+{
+   ec_EOEframet *frame;
+   int result;
+
+   frame = ecx_EOEgw_peek(context, slave);
+   if (frame == NULL)
+   {
+      return 0;
+   }
+   *port = frame->port;
+   result = EC_ERROR;
+   if (frame->size <= *psize)
+   {
+      memcpy(p, frame->data, frame->size);
+      result = 1;
+   }
+   *psize = frame->size;
+   ecx_EOEgw_release(context, *slave);
+   return result;
+}
+
+/* build next transmit fragment of slave in mailbox, returns TRUE if there is one */
+static boolean ecx_EOEgw_fragment(ecx_contextt *context, ec_EOEgwslavet *gws, ec_EOEt *EOEp)
+{
+   ec_EOEframet *frame;
+   uint16 frameinfo1, frameinfo2;
+   int maxdata, size;
+   uint8 cnt;
+
+   if (!gws->txactive)
+   {
+      if (gws->txhead == gws->txtail)
+      {
+         return FALSE;
+      }
+      /* start next frame */
+      gws->txactive = TRUE;
+      gws->txoffset = 0;
+      gws->txfragmentno = 0;
+      context->slavelist[gws->slave].eoe_frameno++;
+   }
+   frame = &(gws->tx[gws->txtail % EC_EOEGWFRAMES]);
+   /* data section=mailbox size - 6 mbx - 4 EoEh */
+   maxdata = context->slavelist[gws->slave].mbx_l - 0x0A;
+   size = frame->size - gws->txoffset;
+   frameinfo1 = EOE_HDR_FRAME_PORT_SET(frame->port);
+   if (size > maxdata)
+   {
+      /* Adjust to even 32-octect blocks */
+      size = ((maxdata >> 5) << 5);
+   }
+   else
+   {
+      frameinfo1 |= EOE_HDR_LAST_FRAGMENT_SET(1);
+   }
+   frameinfo2 = EOE_HDR_FRAG_NO_SET(gws->txfragmentno) |
+      EOE_HDR_FRAME_NO_SET(context->slavelist[gws->slave].eoe_frameno);
+   if (gws->txfragmentno > 0)
+   {
+      frameinfo2 |= EOE_HDR_FRAME_OFFSET_SET(gws->txoffset >> 5);
+   }
+   else
+   {
+      frameinfo2 |= EOE_HDR_FRAME_OFFSET_SET((frame->size + 31) >> 5);
+   }
+   cnt = ec_nextmbxcnt(context->slavelist[gws->slave].mbx_cnt);
+   context->slavelist[gws->slave].mbx_cnt = cnt;
+   memset(EOEp, 0, context->slavelist[gws->slave].mbx_l);
+   EOEp->mbxheader.length = htoes((uint16)(4 + size)); /* no timestamp */
+   EOEp->mbxheader.address = htoes(0x0000);
+   EOEp->mbxheader.priority = 0x00;
+   EOEp->mbxheader.mbxtype = ECT_MBXT_EOE + MBX_HDR_SET_CNT(cnt); /* EoE */
+   EOEp->frameinfo1 = htoes(frameinfo1);
+   EOEp->frameinfo2 = htoes(frameinfo2);
+   memcpy(EOEp->data, &(frame->data[gws->txoffset]), size);
+   gws->txsize = (uint16)size;
+   return TRUE;
+}
+
+/* fragment sent to slave, advance to next fragment or frame */
+static void ecx_EOEgw_sent(ec_EOEgwslavet *gws)
+{
+   ec_EOEframet *frame = &(gws->tx[gws->txtail % EC_EOEGWFRAMES]);
+
+   gws->txoffset += gws->txsize;
+   gws->txfragmentno++;
+   if (gws->txoffset >= frame->size)
+   {
+      gws->txactive = FALSE;
+      gws->txtail++;
+      gws->txframes++;
+   }
+}
+
+/** Reassemble EoE fragment of slave served by the EoE gateway.
+* Called from ecx_mbxhandlemsg(), so fragments read by any mailbox function
+* end up in the gateway. Complete frames are put in the receive queue of the
+* slave, they are reassembled in place in the next free slot.
+*
+* @param[in]  context = context struct
+* @param[in]  slave   = Slave number
+* @param[in]  mbx     = Received mailbox with EoE fragment
+* @return TRUE if the slave is served by the gateway and the fragment is taken
+*/
+boolean ecx_EOEgw_input(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx)
+{
+   ec_EOEgwslavet *gws;
+   ec_EOEframet *frame;
+   uint16 frameinfo1;
+   int size, rval;
+
+   gws = ecx_EOEgw_slave(context, slave);
+   if (gws == NULL)
+   {
+      return FALSE;
+   }
+   frameinfo1 = etohs(((ec_EOEt *)mbx)->frameinfo1);
+   frame = &(gws->rx[gws->rxhead % EC_EOEGWFRAMES]);
+   size = EC_EOEMAXFRAME;
+   rval = ecx_EOEreadfragment(mbx, &(gws->rxfragmentno), &(gws->rxframesize),
+      &(gws->rxframeoffset), &(gws->rxframeno), &size, frame->data);
+   if ((rval < 0) || ((rval > 0) && ((size < 0) || (size > EC_EOEMAXFRAME))))
+   {
+      gws->rxdropped++;
+   }
+   else if (rval > 0)
+   {
+      if (EC_EOEGW_RXFREE(gws) > 0)
+      {
+         frame->size = (uint16)size;
+         frame->port = (uint8)EOE_HDR_FRAME_PORT_GET(frameinfo1);
+         gws->rxhead++;
+         gws->rxframes++;
+      }
+      else
+      {
+         gws->rxdropped++;
+      }
+   }
+   return TRUE;
+}
+
+/* add datagram to process data frame if there is room, returns data offset or 0 */
+static uint16 ecx_EOEgw_add(ecx_portt *port, uint8 idx, uint8 com, uint16 ADP, uint16 ADO,
+   uint16 length, void *data)
+{
+   if ((port->txbuflength[idx] + EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + length) >
+       (int)(ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + EC_MAXLRWDATA))
+   {
+      return 0;
+   }
+   ecx_appenddatagram(port, idx);
+   return ecx_adddatagram(port, &(port->txbuf[idx]), com, idx, FALSE, ADP, ADO, length, data);
+}
+
+/** Add mailbox datagrams of the EoE gateway to a frame.
+* Called by the process data send function for each frame, before transmit.
+* Per slave one fragment is written and the mailbox status or the mailbox
+* itself is read, while the frame has room.
+*
+* @param[in]  context = context struct
+* @param[in]  idx     = index of frame being built
+*/
+void ecx_EOEgw_tx(ecx_contextt *context, uint8 idx)
+{
+   ec_EOEgwt *gw = context->EOEgw;
+   ec_EOEgwslavet *gws;
+   ec_slavet *slavep;
+   ecx_portt *port;
+   uint16 offset;
+   int i;
+
+   if (gw == NULL)
+   {
+      return;
+   }
+   port = context->port;
+   for (i = 0; i < gw->slaves; i++)
+   {
+      gws = &(gw->slave[i]);
+      slavep = &(context->slavelist[gws->slave]);
+      if ((gws->txidx < 0) && ecx_EOEgw_fragment(context, gws, (ec_EOEt *)&(gw->mbx)))
+      {
+         offset = ecx_EOEgw_add(port, idx, EC_CMD_FPWR, slavep->configadr, slavep->mbx_wo,
+            slavep->mbx_l, &(gw->mbx));
+         /* without room the fragment is built again with the next frame */
+         if (offset)
+         {
+            gws->txidx = idx;
+            gws->txdgoffset = offset;
+         }
+      }
+      if (gws->rxidx < 0)
+      {
+         /* after a mailbox with data read the mailbox directly, a slave with an
+          * empty mailbox does not increment the workcounter */
+         if (gws->rxread)
+         {
+            offset = ecx_EOEgw_add(port, idx, EC_CMD_FPRD, slavep->configadr, slavep->mbx_ro,
+               slavep->mbx_rl, NULL);
+         }
+         else
+         {
+            offset = ecx_EOEgw_add(port, idx, EC_CMD_FPRD, slavep->configadr, ECT_REG_SM1STAT,
+               1, NULL);
+         }
+         if (offset)
+         {
+            gws->rxidx = idx;
+            gws->rxdgoffset = offset;
+         }
+      }
+   }
+}
+
+/** Process mailbox datagrams of the EoE gateway in a received frame.
+* Called by the process data receive function for each frame, before the
+* frame buffer is released.
+*
+* @param[in]  context = context struct
+* @param[in]  idx     = index of received frame
+* @param[in]  wkc     = result of frame receive, EC_NOFRAME if lost
+*/
+void ecx_EOEgw_rx(ecx_contextt *context, uint8 idx, int wkc)
+{
+   ec_EOEgwt *gw = context->EOEgw;
+   ec_EOEgwslavet *gws;
+   ec_slavet *slavep;
+   uint8 *rxp;
+   uint16 length;
+   int i, dwkc;
+
+   if (gw == NULL)
+   {
+      return;
+   }
+   for (i = 0; i < gw->slaves; i++)
+   {
+      gws = &(gw->slave[i]);
+      slavep = &(context->slavelist[gws->slave]);
+      if (gws->txidx == idx)
+      {
+         gws->txidx = -1;
+         rxp = &(context->port->rxbuf[idx][gws->txdgoffset]);
+         length = slavep->mbx_l;
+         /* mailbox full or frame lost, fragment is built again with next frame */
+         if ((wkc > EC_NOFRAME) && ((rxp[length] + ((int)rxp[length + 1] << 8)) == 1))
+         {
+            ecx_EOEgw_sent(gws);
+         }
+      }
+      if (gws->rxidx == idx)
+      {
+         gws->rxidx = -1;
+         if (wkc <= EC_NOFRAME)
+         {
+            continue;
+         }
+         rxp = &(context->port->rxbuf[idx][gws->rxdgoffset]);
+         length = gws->rxread ? slavep->mbx_rl : 1;
+         dwkc = rxp[length] + ((int)rxp[length + 1] << 8);
+         if (!gws->rxread)
+         {
+            /* mailbox full, read it with next frame */
+            gws->rxread = ((dwkc == 1) && (rxp[0] & 0x08));
+         }
+         else if (dwkc == 1)
+         {
+            memcpy(&(gw->mbx), rxp, length);
+            /* EoE fragments come back in ecx_EOEgw_input(), replies for
+             * other mailbox users are parked in the mailbox pool */
+            if (!ecx_mbxhandlemsg(context, gws->slave, &(gw->mbx)))
+            {
+               (void)ecx_mbxpark(context, gws->slave, &(gw->mbx));
+            }
+         }
+         else
+         {
+            gws->rxread = FALSE;
+         }
+      }
+   }
+}
@@ -174,6 +174,69 @@ typedef struct PACKED
 } ec_EOEt;
 PACKED_END
 
+/** maximum number of slaves served by the EoE gateway */
+#define EC_MAXEOEGW        16
+/** frame slots per direction and slave of the EoE gateway */
+#define EC_EOEGWFRAMES     4
+/** maximum Ethernet frame size of the EoE gateway, multiple of 32 */
+#define EC_EOEMAXFRAME     1536
+
+/** Ethernet frame in EoE gateway queue */
+typedef struct
+{
+   /** frame size in bytes */
+   uint16 size;
+   /** port number on slave */
+   uint8  port;
+   /** frame data */
+   uint8  data[EC_EOEMAXFRAME];
+} ec_EOEframet;
+
+/** EoE gateway state of one slave */
+typedef struct
+{
+   /** slave number */
+   uint16       slave;
+   /** transmit queue */
+   ec_EOEframet tx[EC_EOEGWFRAMES];
+   /** transmit queue write and read counters */
+   uint16       txhead, txtail;
+   /** frame at txtail is being sent */
+   boolean      txactive;
+   /** offset and size of current fragment in frame */
+   uint16       txoffset, txsize;
+   /** fragment number of current fragment */
+   uint8        txfragmentno;
+   /** receive queue, one slot is used for reassembly */
+   ec_EOEframet rx[EC_EOEGWFRAMES];
+   /** receive queue write and read counters */
+   uint16       rxhead, rxtail;
+   /** reassembly state for ecx_EOEreadfragment() */
+   uint8        rxfragmentno;
+   uint16       rxframesize, rxframeoffset, rxframeno;
+   /** TRUE = read mailbox, FALSE = poll mailbox status */
+   boolean      rxread;
+   /** index of frame with transmit and receive datagram, -1 = none */
+   int          txidx, rxidx;
+   /** offset of datagram data in frame */
+   uint16       txdgoffset, rxdgoffset;
+   /** frames sent and received, received frames dropped */
+   uint32       txframes, rxframes, rxdropped;
+} ec_EOEgwslavet;
+
+/** EoE gateway, moves Ethernet frames in the process data frames */
+struct ec_EOEgw
+{
+   /** number of served slaves */
+   int            slaves;
+   /** slave served next by ecx_EOEgw_recv() */
+   int            next;
+   /** state per slave */
+   ec_EOEgwslavet slave[EC_MAXEOEGW];
+   /** mailbox scratch buffer */
+   ec_mbxbuft     mbx;
+};
+
 int ecx_EOEdefinehook(ecx_contextt *context, void *hook);
 int ecx_EOEsetIp(ecx_contextt *context, 
    uint16 slave, 
@@ -205,6 +268,14 @@ int ecx_EOEreadfragment(
    uint16 * rxframeno,
    int * psize,
    void *p);
+int ecx_EOEgw_init(ecx_contextt *context, ec_EOEgwt *gw);
+int ecx_EOEgw_send(ecx_contextt *context, uint16 slave, uint8 port, int psize, const void *p);
+ec_EOEframet *ecx_EOEgw_peek(ecx_contextt *context, uint16 *slave);
+void ecx_EOEgw_release(ecx_contextt *context, uint16 slave);
+int ecx_EOEgw_recv(ecx_contextt *context, uint16 *slave, uint8 *port, int *psize, void *p);
+boolean ecx_EOEgw_input(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx);
+void ecx_EOEgw_tx(ecx_contextt *context, uint8 idx);
+void ecx_EOEgw_rx(ecx_contextt *context, uint8 idx, int wkc);
 
 #ifdef __cplusplus
 }
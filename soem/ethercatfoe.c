@@ -75,17 +75,21 @@ int ecx_FOEread(ecx_contextt *context, uint16 slave, char *filename, uint32 pass
    int32 dataread = 0;
    int32 buffersize, packetnumber, prevpacket = 0;
    uint16 fnsize, maxdata, segmentdata;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
    boolean worktodo;
 
    buffersize = *psize;
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aFOEp = (ec_FOEt *)&MbxIn;
-   FOEp = (ec_FOEt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aFOEp = (ec_FOEt *)MbxIn;
+   FOEp = (ec_FOEt *)MbxOut;
    fnsize = (uint16)strlen(filename);
    maxdata = context->slavelist[slave].mbx_l - 12;
    if (fnsize > maxdata)
@@ -104,16 +108,16 @@ int ecx_FOEread(ecx_contextt *context, uint16 slave, char *filename, uint32 pass
    /* copy filename in mailbox */
    memcpy(&FOEp->FileName[0], filename, fnsize);
    /* send FoE request to slave */
-   wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
    if (wkc > 0) /* succeeded to place mailbox in slave ? */
    {
       do
       {
          worktodo = FALSE;
          /* clean mailboxbuffer */
-         ec_clearmbx(&MbxIn);
+         MbxIn = ecx_mbxin(context, slave);
          /* read slave response */
-         wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+         wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
          if (wkc > 0) /* succeeded to read slave response ? */
          {
             /* slave response should be FoE */
@@ -142,7 +146,7 @@ int ecx_FOEread(ecx_contextt *context, uint16 slave, char *filename, uint32 pass
                      FOEp->OpCode = ECT_FOE_ACK;
                      FOEp->PacketNumber = htoel(packetnumber);
                      /* send FoE ack to slave */
-                     wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+                     wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
                      if (wkc <= 0)
                      {
                         worktodo = FALSE;
@@ -203,17 +207,21 @@ int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 pas
    int32 packetnumber, sendpacket = 0;
    uint16 fnsize, maxdata;
    int segmentdata;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
    boolean worktodo, dofinalzero;
    int tsize;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aFOEp = (ec_FOEt *)&MbxIn;
-   FOEp = (ec_FOEt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aFOEp = (ec_FOEt *)MbxIn;
+   FOEp = (ec_FOEt *)MbxOut;
    dofinalzero = FALSE;
    fnsize = (uint16)strlen(filename);
    maxdata = context->slavelist[slave].mbx_l - 12;
@@ -233,16 +241,16 @@ int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 pas
    /* copy filename in mailbox */
    memcpy(&FOEp->FileName[0], filename, fnsize);
    /* send FoE request to slave */
-   wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
    if (wkc > 0) /* succeeded to place mailbox in slave ? */
    {
       do
       {
          worktodo = FALSE;
          /* clean mailboxbuffer */
-         ec_clearmbx(&MbxIn);
+         MbxIn = ecx_mbxin(context, slave);
          /* read slave response */
-         wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+         wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
          if (wkc > 0) /* succeeded to read slave response ? */
          {
             /* slave response should be FoE */
@@ -289,7 +297,7 @@ int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 pas
                            memcpy(&FOEp->Data[0], p, segmentdata);
                            p = (uint8 *)p + segmentdata;
                            /* send FoE data to slave */
-                           wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+                           wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
                            if (wkc <= 0)
                            {
                               worktodo = FALSE;
@@ -352,6 +360,748 @@ int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 pas
    return wkc;
 }
 
+/* set FoE header, the mailbox counter is set by ecx_FOEsend() */
+static void ecx_FOEsetup(ec_FOEt *FOEp, uint16 length, uint8 opcode, uint32 value)
+{
+   FOEp->MbxHeader.length = htoes(length);
+   FOEp->MbxHeader.address = htoes(0x0000);
+   FOEp->MbxHeader.priority = 0x00;
+   FOEp->OpCode = opcode;
+   FOEp->PacketNumber = htoel(value);
+}
+
+/* send FoE packet with new mailbox counter */
+static int ecx_FOEsend(ecx_contextt *context, uint16 slave, ec_FOEt *FOEp)
+{
+   uint8 cnt;
+
+   cnt = ec_nextmbxcnt(context->slavelist[slave].mbx_cnt);
+   context->slavelist[slave].mbx_cnt = cnt;
+   FOEp->MbxHeader.mbxtype = ECT_MBXT_FOE + MBX_HDR_SET_CNT(cnt); /* FoE */
+   return ecx_mbxsend(context, slave, (ec_mbxbuft *)FOEp, EC_TIMEOUTTXM);
+}
+
+/* abort FoE transfer because the application stream failed */
+static void ecx_FOEabort(ecx_contextt *context, uint16 slave, ec_FOEt *FOEp)
+{
+   ecx_FOEsetup(FOEp, 0x0006, ECT_FOE_ERROR, 0x8000); /* not defined error */
+   (void)ecx_FOEsend(context, slave, FOEp);
+}
+
+/* fill FoE data from stream until size bytes or end of stream,
+ * returns number of bytes or <0 on stream error */
+static int ecx_FOEfill(ecx_contextt *context, uint16 slave, ec_FOEstreamt stream,
+   void *userdata, uint8 *p, int size)
+{
+   int n, got = 0;
+
+   while (got < size)
+   {
+      n = stream(context, slave, userdata, p + got, size - got);
+      if (n < 0)
+      {
+         return n;
+      }
+      if (n == 0)
+      {
+         break;
+      }
+      got += n;
+   }
+   return got;
+}
+
+/** FoE read to stream, blocking.
+ *
+ * Like ecx_FOEread() but every received data packet is passed to stream,
+ * so the file does not have to fit in a buffer. The packet is acknowledged
+ * before stream is called, the slave can prepare the next packet while the
+ * application stores the data.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number.
+ * @param[in]  filename   = Filename of file to read.
+ * @param[in]  password   = password.
+ * @param[in]  stream     = called with each data packet, return <0 to abort
+ * @param[in]  userdata   = passed to stream
+ * @param[out] psize      = bytes read from file
+ * @param[in]  timeout    = Timeout per mailbox cycle in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ */
+int ecx_FOEread_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+   ec_FOEstreamt stream, void *userdata, int *psize, int timeout)
+{
+   ec_FOEt *FOEp, *aFOEp;
+   int wkc;
+   int32 dataread = 0;
+   int32 packetnumber, prevpacket = 0;
+   uint16 fnsize, maxdata, segmentdata;
+   ec_mbxbuft *MbxIn;
+   boolean worktodo;
+
+   *psize = 0;
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
+   /* Empty slave out mailbox if something is in. Timeout set to 0 */
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   FOEp = (ec_FOEt *)ecx_mbxout(context, slave);
+   aFOEp = (ec_FOEt *)MbxIn;
+   fnsize = (uint16)strlen(filename);
+   maxdata = context->slavelist[slave].mbx_l - 12;
+   if (fnsize > maxdata)
+   {
+      fnsize = maxdata;
+   }
+   ecx_FOEsetup(FOEp, 0x0006 + fnsize, ECT_FOE_READ, password);
+   memcpy(&FOEp->FileName[0], filename, fnsize);
+   /* send FoE request to slave */
+   wkc = ecx_FOEsend(context, slave, FOEp);
+   if (wkc > 0) /* succeeded to place mailbox in slave ? */
+   {
+      do
+      {
+         worktodo = FALSE;
+         MbxIn = ecx_mbxin(context, slave);
+         /* read slave response */
+         wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
+         if (wkc > 0) /* succeeded to read slave response ? */
+         {
+            if (((aFOEp->MbxHeader.mbxtype & 0x0f) == ECT_MBXT_FOE) &&
+                (aFOEp->OpCode == ECT_FOE_DATA))
+            {
+               segmentdata = etohs(aFOEp->MbxHeader.length) - 0x0006;
+               packetnumber = etohl(aFOEp->PacketNumber);
+               if ((packetnumber == ++prevpacket) && (segmentdata <= maxdata))
+               {
+                  /* ack first, slave works on next packet while stream stores data */
+                  ecx_FOEsetup(FOEp, 0x0006, ECT_FOE_ACK, packetnumber);
+                  wkc = ecx_FOEsend(context, slave, FOEp);
+                  if ((wkc > 0) && (segmentdata == maxdata))
+                  {
+                     worktodo = TRUE;
+                  }
+                  if (stream(context, slave, userdata, &aFOEp->Data[0], segmentdata) < 0)
+                  {
+                     if (worktodo)
+                     {
+                        ecx_FOEabort(context, slave, FOEp);
+                     }
+                     worktodo = FALSE;
+                     wkc = -EC_ERR_TYPE_FOE_ERROR;
+                  }
+                  dataread += segmentdata;
+                  if (context->FOEhook)
+                  {
+                     context->FOEhook(slave, packetnumber, dataread);
+                  }
+               }
+               else
+               {
+                  /* FoE error */
+                  wkc = -EC_ERR_TYPE_FOE_PACKETNUMBER;
+               }
+            }
+            else if (((aFOEp->MbxHeader.mbxtype & 0x0f) == ECT_MBXT_FOE) &&
+                     (aFOEp->OpCode == ECT_FOE_ERROR))
+            {
+               /* FoE error */
+               wkc = -EC_ERR_TYPE_FOE_ERROR;
+            }
+            else
+            {
+               /* unexpected mailbox received */
+               wkc = -EC_ERR_TYPE_PACKET_ERROR;
+            }
+            *psize = dataread;
+         }
+      } while (worktodo);
+   }
+
+   return wkc;
+}
+
+/** FoE write from stream, blocking.
+ *
+ * Like ecx_FOEwrite() but the file data is pulled from stream, so the file
+ * does not have to be in memory. One packet is prefetched: while the slave
+ * stores a packet the next one is read from stream, and it is sent as soon
+ * as the slave acknowledges.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number.
+ * @param[in]  filename   = Filename of file to write.
+ * @param[in]  password   = password.
+ * @param[in]  stream     = called to fill data packets, returns bytes filled,
+ *                          0 at end of file or <0 to abort
+ * @param[in]  userdata   = passed to stream
+ * @param[in]  timeout    = Timeout per mailbox cycle in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ */
+int ecx_FOEwrite_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+   ec_FOEstreamt stream, void *userdata, int timeout)
+{
+   ec_FOEt *FOEp, *aFOEp, *preFOEp, *tFOEp;
+   ec_mbxbuft *MbxIn;
+   int wkc, presize;
+   int32 packetnumber, sendpacket = 0, datasent = 0;
+   uint16 fnsize, maxdata;
+   boolean worktodo, lastsent;
+
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
+   /* Empty slave out mailbox if something is in. Timeout set to 0 */
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   FOEp = (ec_FOEt *)ecx_mbxout(context, slave);
+   aFOEp = (ec_FOEt *)MbxIn;
+   preFOEp = (ec_FOEt *)ecx_mbxspare(context, slave);
+   fnsize = (uint16)strlen(filename);
+   maxdata = context->slavelist[slave].mbx_l - 12;
+   if (fnsize > maxdata)
+   {
+      fnsize = maxdata;
+   }
+   ecx_FOEsetup(FOEp, 0x0006 + fnsize, ECT_FOE_WRITE, password);
+   memcpy(&FOEp->FileName[0], filename, fnsize);
+   /* send FoE request to slave */
+   wkc = ecx_FOEsend(context, slave, FOEp);
+   if (wkc > 0) /* succeeded to place mailbox in slave ? */
+   {
+      lastsent = FALSE;
+      /* prefetch first packet while slave opens the file */
+      presize = ecx_FOEfill(context, slave, stream, userdata, &preFOEp->Data[0], maxdata);
+      if (presize < 0)
+      {
+         ecx_FOEabort(context, slave, FOEp);
+         return -EC_ERR_TYPE_FOE_ERROR;
+      }
+      do
+      {
+         worktodo = FALSE;
+         MbxIn = ecx_mbxin(context, slave);
+         /* read slave response */
+         wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
+         if (wkc > 0) /* succeeded to read slave response ? */
+         {
+            /* slave response should be FoE */
+            if ((aFOEp->MbxHeader.mbxtype & 0x0f) == ECT_MBXT_FOE)
+            {
+               switch (aFOEp->OpCode)
+               {
+                  case ECT_FOE_ACK:
+                  {
+                     packetnumber = etohl(aFOEp->PacketNumber);
+                     if (packetnumber != sendpacket)
+                     {
+                        /* FoE error */
+                        wkc = -EC_ERR_TYPE_FOE_PACKETNUMBER;
+                        break;
+                     }
+                     if (context->FOEhook)
+                     {
+                        context->FOEhook(slave, packetnumber, datasent);
+                     }
+                     if (lastsent)
+                     {
+                        break; /* last packet acknowledged, done */
+                     }
+                     /* send prefetched packet, the sent one becomes the next prefetch buffer */
+                     tFOEp = FOEp;
+                     FOEp = preFOEp;
+                     preFOEp = tFOEp;
+                     sendpacket++;
+                     ecx_FOEsetup(FOEp, (uint16)(0x0006 + presize), ECT_FOE_DATA, sendpacket);
+                     wkc = ecx_FOEsend(context, slave, FOEp);
+                     if (wkc <= 0)
+                     {
+                        break;
+                     }
+                     datasent += presize;
+                     /* EOF is defined as packetsize < full packetsize, after a full
+                      * last packet the stream returns 0 and a zero size packet follows */
+                     lastsent = (presize < maxdata);
+                     worktodo = TRUE;
+                     if (!lastsent)
+                     {
+                        presize = ecx_FOEfill(context, slave, stream, userdata,
+                           &preFOEp->Data[0], maxdata);
+                        if (presize < 0)
+                        {
+                           ecx_FOEabort(context, slave, preFOEp);
+                           wkc = -EC_ERR_TYPE_FOE_ERROR;
+                           worktodo = FALSE;
+                        }
+                     }
+                     break;
+                  }
+                  case ECT_FOE_BUSY:
+                  {
+                     /* slave not ready, repeat last data packet */
+                     worktodo = TRUE;
+                     if (sendpacket)
+                     {
+                        wkc = ecx_FOEsend(context, slave, FOEp);
+                        worktodo = (wkc > 0);
+                     }
+                     break;
+                  }
+                  case ECT_FOE_ERROR:
+                  {
+                     /* FoE error */
+                     if (aFOEp->ErrorCode == 0x8001)
+                     {
+                        wkc = -EC_ERR_TYPE_FOE_FILE_NOTFOUND;
+                     }
+                     else
+                     {
+                        wkc = -EC_ERR_TYPE_FOE_ERROR;
+                     }
+                     break;
+                  }
+                  default:
+                  {
+                     /* unexpected mailbox received */
+                     wkc = -EC_ERR_TYPE_PACKET_ERROR;
+                     break;
+                  }
+               }
+            }
+            else
+            {
+               /* unexpected mailbox received */
+               wkc = -EC_ERR_TYPE_PACKET_ERROR;
+            }
+         }
+      } while (worktodo);
+   }
+
+   return wkc;
+}
+
+/** transfer steps of a parallel FoE update entry */
+enum
+{
+   EC_FOEUPD_SEND = 1,
+   EC_FOEUPD_WAIT,
+   EC_FOEUPD_READ,
+   EC_FOEUPD_DONE
+};
+
+/* put slaves in BOOT state with the boot mailbox configuration from EEPROM,
+ * entries that fail are finished with wkc 0 */
+static void ecx_FOEupdate_boot(ecx_contextt *context, ec_FOEupdatet *list, int n, int timeout)
+{
+   ec_slavet *slavep;
+   uint32 data;
+   int i;
+
+   for (i = 0; i < n; i++)
+   {
+      context->slavelist[list[i].slave].state = EC_STATE_INIT;
+      (void)ecx_writestate(context, list[i].slave);
+   }
+   /* slaves change state in parallel, the checks after the first return fast */
+   for (i = 0; i < n; i++)
+   {
+      slavep = &(context->slavelist[list[i].slave]);
+      if (ecx_statecheck(context, list[i].slave, EC_STATE_INIT, timeout) != EC_STATE_INIT)
+      {
+         list[i].step = EC_FOEUPD_DONE;
+         continue;
+      }
+      /* read BOOT mailbox data, master -> slave */
+      data = ecx_readeeprom(context, list[i].slave, ECT_SII_BOOTRXMBX, EC_TIMEOUTEEP);
+      slavep->SM[0].StartAddr = (uint16)LO_WORD(data);
+      slavep->SM[0].SMlength = (uint16)HI_WORD(data);
+      slavep->mbx_wo = (uint16)LO_WORD(data);
+      slavep->mbx_l = (uint16)HI_WORD(data);
+      /* read BOOT mailbox data, slave -> master */
+      data = ecx_readeeprom(context, list[i].slave, ECT_SII_BOOTTXMBX, EC_TIMEOUTEEP);
+      slavep->SM[1].StartAddr = (uint16)LO_WORD(data);
+      slavep->SM[1].SMlength = (uint16)HI_WORD(data);
+      slavep->mbx_ro = (uint16)LO_WORD(data);
+      slavep->mbx_rl = (uint16)HI_WORD(data);
+      if ((slavep->mbx_l <= 12) || (slavep->mbx_l > EC_MAXMBX) ||
+          (slavep->mbx_rl == 0) || (slavep->mbx_rl > EC_MAXMBX))
+      {
+         list[i].step = EC_FOEUPD_DONE;
+         continue;
+      }
+      /* program SM0 mailbox in and SM1 mailbox out for slave */
+      (void)ecx_FPWR(context->port, slavep->configadr, ECT_REG_SM0, sizeof(ec_smt),
+         &(slavep->SM[0]), EC_TIMEOUTRET3);
+      (void)ecx_FPWR(context->port, slavep->configadr, ECT_REG_SM1, sizeof(ec_smt),
+         &(slavep->SM[1]), EC_TIMEOUTRET3);
+      slavep->state = EC_STATE_BOOT;
+      (void)ecx_writestate(context, list[i].slave);
+   }
+   for (i = 0; i < n; i++)
+   {
+      if ((list[i].step != EC_FOEUPD_DONE) &&
+          (ecx_statecheck(context, list[i].slave, EC_STATE_BOOT, timeout) != EC_STATE_BOOT))
+      {
+         list[i].step = EC_FOEUPD_DONE;
+      }
+   }
+}
+
+/* write (step SEND) or read (step READ) mailboxes of all entries in one
+ * step, as many per frame as fit. Data is transferred directly to and from
+ * the mailbox pool of each slave. */
+static void ecx_FOEupdate_mbx(ecx_contextt *context, ec_FOEupdatet *list, int n, uint8 which)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   int ent[EC_MAXMDATAGRAM];
+   ec_slavet *slavep;
+   ec_FOEupdatet *e;
+   int i, d, nd, used;
+   uint16 length;
+
+   i = 0;
+   while (i < n)
+   {
+      nd = 0;
+      used = 0;
+      for (; (i < n) && (nd < EC_MAXMDATAGRAM); i++)
+      {
+         e = &list[i];
+         if (e->step != which)
+         {
+            continue;
+         }
+         slavep = &(context->slavelist[e->slave]);
+         length = (which == EC_FOEUPD_SEND) ? slavep->mbx_l : slavep->mbx_rl;
+         if ((nd > 0) && ((used + length + EC_HEADERSIZE + EC_WKCSIZE) > EC_MAXLRWDATA))
+         {
+            break; /* frame is full */
+         }
+         if (which == EC_FOEUPD_SEND)
+         {
+            dg[nd].com = EC_CMD_FPWR;
+            dg[nd].ADO = slavep->mbx_wo;
+            dg[nd].data = (uint8 *)(e->mbxout);
+         }
+         else
+         {
+            dg[nd].com = EC_CMD_FPRD;
+            dg[nd].ADO = slavep->mbx_ro;
+            dg[nd].data = (uint8 *)(e->mbxin);
+         }
+         dg[nd].ADP = slavep->configadr;
+         dg[nd].length = length;
+         ent[nd++] = i;
+         used += length + EC_HEADERSIZE + EC_WKCSIZE;
+      }
+      if (nd == 0)
+      {
+         break;
+      }
+      (void)ecx_multidatagram(context->port, dg, nd, EC_TIMEOUTRET3);
+      for (d = 0; d < nd; d++)
+      {
+         e = &list[ent[d]];
+         if (which == EC_FOEUPD_SEND)
+         {
+            /* mailbox of slave still full when wkc is 0, send again next round */
+            if (dg[d].wkc == 1)
+            {
+               e->step = EC_FOEUPD_WAIT;
+            }
+         }
+         else
+         {
+            e->step = (dg[d].wkc == 1) ? EC_FOEUPD_READ : EC_FOEUPD_WAIT;
+         }
+      }
+   }
+}
+
+/* poll SM1 status of all waiting entries in one frame, full mailboxes move
+ * to step READ. Returns TRUE if any mailbox is full. */
+static boolean ecx_FOEupdate_poll(ecx_contextt *context, ec_FOEupdatet *list, int n)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   uint8 stat[EC_MAXMDATAGRAM];
+   int ent[EC_MAXMDATAGRAM];
+   int i, d, nd;
+   boolean full = FALSE;
+
+   i = 0;
+   while (i < n)
+   {
+      nd = 0;
+      for (; (i < n) && (nd < EC_MAXMDATAGRAM); i++)
+      {
+         if (list[i].step == EC_FOEUPD_WAIT)
+         {
+            stat[nd] = 0;
+            dg[nd].com = EC_CMD_FPRD;
+            dg[nd].ADP = context->slavelist[list[i].slave].configadr;
+            dg[nd].ADO = ECT_REG_SM1STAT;
+            dg[nd].length = sizeof(stat[nd]);
+            dg[nd].data = &stat[nd];
+            ent[nd++] = i;
+         }
+      }
+      if (nd == 0)
+      {
+         break;
+      }
+      (void)ecx_multidatagram(context->port, dg, nd, EC_TIMEOUTRET);
+      for (d = 0; d < nd; d++)
+      {
+         if ((dg[d].wkc == 1) && (stat[d] & 0x08))
+         {
+            list[ent[d]].step = EC_FOEUPD_READ;
+            full = TRUE;
+         }
+      }
+   }
+   return full;
+}
+
+/* finish entry with result */
+static void ecx_FOEupdate_finish(ec_FOEupdatet *e, int wkc)
+{
+   e->wkc = wkc;
+   e->step = EC_FOEUPD_DONE;
+}
+
+/* prepare next data packet of entry, stream errors abort the transfer */
+static void ecx_FOEupdate_next(ecx_contextt *context, ec_FOEupdatet *e)
+{
+   ec_FOEt *FOEp = (ec_FOEt *)e->mbxout;
+   uint16 maxdata = context->slavelist[e->slave].mbx_l - 12;
+   int size;
+
+   size = ecx_FOEfill(context, e->slave, e->stream, e->userdata, &FOEp->Data[0], maxdata);
+   if (size < 0)
+   {
+      ecx_FOEabort(context, e->slave, FOEp);
+      ecx_FOEupdate_finish(e, -EC_ERR_TYPE_FOE_ERROR);
+      return;
+   }
+   e->packet++;
+   e->size = size;
+   ecx_FOEsetup(FOEp, (uint16)(0x0006 + size), ECT_FOE_DATA, e->packet);
+   e->step = EC_FOEUPD_SEND;
+}
+
+/* handle response in receive mailbox of entry */
+static void ecx_FOEupdate_response(ecx_contextt *context, ec_FOEupdatet *e, int timeout)
+{
+   ec_FOEt *aFOEp = (ec_FOEt *)e->mbxin;
+   ec_FOEt *FOEp = (ec_FOEt *)e->mbxout;
+   uint8 cnt;
+
+   if ((aFOEp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_FOE)
+   {
+      /* emergency or mailbox error, keep waiting for the FoE response */
+      (void)ecx_mbxhandlemsg(context, e->slave, (ec_mbxbuft *)aFOEp);
+      e->step = EC_FOEUPD_WAIT;
+      return;
+   }
+   osal_timer_start(&(e->timer), timeout);
+   switch (aFOEp->OpCode)
+   {
+      case ECT_FOE_ACK:
+      {
+         if ((int32)etohl(aFOEp->PacketNumber) != e->packet)
+         {
+            ecx_FOEupdate_finish(e, -EC_ERR_TYPE_FOE_PACKETNUMBER);
+            break;
+         }
+         if (e->packet)
+         {
+            e->datasent += e->size;
+         }
+         if (context->FOEhook)
+         {
+            context->FOEhook(e->slave, e->packet, e->datasent);
+         }
+         /* EOF is defined as packetsize < full packetsize */
+         if (e->packet && (e->size < (context->slavelist[e->slave].mbx_l - 12)))
+         {
+            ecx_FOEupdate_finish(e, 1);
+         }
+         else
+         {
+            ecx_FOEupdate_next(context, e);
+         }
+         break;
+      }
+      case ECT_FOE_BUSY:
+      {
+         /* slave not ready, repeat last data packet with new mailbox counter */
+         if (e->packet)
+         {
+            e->step = EC_FOEUPD_SEND;
+         }
+         else
+         {
+            e->step = EC_FOEUPD_WAIT;
+         }
+         break;
+      }
+      case ECT_FOE_ERROR:
+      {
+         ecx_FOEupdate_finish(e, (etohl(aFOEp->ErrorCode) == 0x8001) ?
+            -EC_ERR_TYPE_FOE_FILE_NOTFOUND : -EC_ERR_TYPE_FOE_ERROR);
+         break;
+      }
+      default:
+      {
+         ecx_FOEupdate_finish(e, -EC_ERR_TYPE_PACKET_ERROR);
+         break;
+      }
+   }
+   if (e->step == EC_FOEUPD_SEND)
+   {
+      cnt = ec_nextmbxcnt(context->slavelist[e->slave].mbx_cnt);
+      context->slavelist[e->slave].mbx_cnt = cnt;
+      FOEp->MbxHeader.mbxtype = ECT_MBXT_FOE + MBX_HDR_SET_CNT(cnt); /* FoE */
+   }
+}
+
+/** FoE firmware update of many slaves in parallel, blocking.
+ *
+ * All slaves are put in BOOT state with the boot mailbox configuration from
+ * their EEPROM. The FoE write of every slave then runs interleaved with the
+ * others: the data packets of all slaves that are ready are written in
+ * shared frames, the SM1 status of all waiting slaves is polled in one frame
+ * and the ACKs are read in shared frames. Progress is reported per slave
+ * through the FoE hook with the number of acknowledged bytes. After the
+ * transfer the slaves are requested to go to INIT.
+ *
+ * @param[in]  context    = context struct
+ * @param[in,out] list    = slaves with their firmware stream, wkc and
+ *                          datasent are returned per slave, a slave listed
+ *                          more than once fails with wkc 0 after its first
+ *                          entry
+ * @param[in]  n          = number of entries in list
+ * @param[in]  filename   = Filename of file to write.
+ * @param[in]  password   = password.
+ * @param[in]  timeout    = Timeout per mailbox cycle in us, also used for
+ *                          the state changes, standard is EC_TIMEOUTSTATE
+ * @return number of slaves updated successfully
+ */
+int ecx_FOEupdate(ecx_contextt *context, ec_FOEupdatet *list, int n, char *filename,
+   uint32 password, int timeout)
+{
+   ec_FOEt *FOEp;
+   ec_FOEupdatet *e;
+   uint16 fnsize, maxdata;
+   uint8 cnt;
+   int i, j, busy, success;
+
+   for (i = 0; i < n; i++)
+   {
+      e = &list[i];
+      e->wkc = 0;
+      e->datasent = 0;
+      e->packet = 0;
+      e->size = 0;
+      e->step = EC_FOEUPD_SEND;
+      if ((e->slave < 1) || (e->slave > *(context->slavecount)) ||
+          (context->mbxpool == NULL))
+      {
+         e->step = EC_FOEUPD_DONE;
+      }
+      /* a slave listed twice would share its mailbox pool entry, only the
+       * first entry is served */
+      for (j = 0; j < i; j++)
+      {
+         if (list[j].slave == e->slave)
+         {
+            e->step = EC_FOEUPD_DONE;
+         }
+      }
+   }
+   ecx_FOEupdate_boot(context, list, n, timeout);
+   /* build write requests */
+   for (i = 0; i < n; i++)
+   {
+      e = &list[i];
+      if (e->step == EC_FOEUPD_DONE)
+      {
+         continue;
+      }
+      /* empty slave out mailbox if something is in */
+      e->mbxin = ecx_mbxin(context, e->slave);
+      (void)ecx_mbxreceive(context, e->slave, e->mbxin, 0);
+      e->mbxout = ecx_mbxout(context, e->slave);
+      FOEp = (ec_FOEt *)e->mbxout;
+      fnsize = (uint16)strlen(filename);
+      maxdata = context->slavelist[e->slave].mbx_l - 12;
+      if (fnsize > maxdata)
+      {
+         fnsize = maxdata;
+      }
+      ecx_FOEsetup(FOEp, 0x0006 + fnsize, ECT_FOE_WRITE, password);
+      memcpy(&FOEp->FileName[0], filename, fnsize);
+      cnt = ec_nextmbxcnt(context->slavelist[e->slave].mbx_cnt);
+      context->slavelist[e->slave].mbx_cnt = cnt;
+      FOEp->MbxHeader.mbxtype = ECT_MBXT_FOE + MBX_HDR_SET_CNT(cnt); /* FoE */
+      osal_timer_start(&(e->timer), timeout);
+   }
+   do
+   {
+      ecx_FOEupdate_mbx(context, list, n, EC_FOEUPD_SEND);
+      if (ecx_FOEupdate_poll(context, list, n))
+      {
+         ecx_FOEupdate_mbx(context, list, n, EC_FOEUPD_READ);
+         for (i = 0; i < n; i++)
+         {
+            if (list[i].step == EC_FOEUPD_READ)
+            {
+               ecx_FOEupdate_response(context, &list[i], timeout);
+            }
+         }
+      }
+      else
+      {
+         osal_usleep(EC_LOCALDELAY);
+      }
+      busy = 0;
+      for (i = 0; i < n; i++)
+      {
+         e = &list[i];
+         if (e->step != EC_FOEUPD_DONE)
+         {
+            if (osal_timer_is_expired(&(e->timer)))
+            {
+               ecx_FOEupdate_finish(e, EC_TIMEOUT);
+            }
+            else
+            {
+               busy++;
+            }
+         }
+      }
+   }
+   while (busy);
+
+   success = 0;
+   for (i = 0; i < n; i++)
+   {
+      if (list[i].wkc > 0)
+      {
+         success++;
+      }
+      if ((list[i].slave >= 1) && (list[i].slave <= *(context->slavecount)))
+      {
+         context->slavelist[list[i].slave].state = EC_STATE_INIT;
+         (void)ecx_writestate(context, list[i].slave);
+      }
+   }
+   return success;
+}
+
 #ifdef EC_VER1
 int ec_FOEdefinehook(void *hook)
 {
@@ -367,4 +1117,19 @@ int ec_FOEwrite(uint16 slave, char *filename, uint32 password, int psize, void *
 {
    return ecx_FOEwrite(&ecx_context, slave, filename, password, psize, p, timeout);
 }
+
+int ec_FOEread_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt stream, void *userdata, int *psize, int timeout)
+{
+   return ecx_FOEread_stream(&ecx_context, slave, filename, password, stream, userdata, psize, timeout);
+}
+
+int ec_FOEwrite_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt stream, void *userdata, int timeout)
+{
+   return ecx_FOEwrite_stream(&ecx_context, slave, filename, password, stream, userdata, timeout);
+}
+
+int ec_FOEupdate(ec_FOEupdatet *list, int n, char *filename, uint32 password, int timeout)
+{
+   return ecx_FOEupdate(&ecx_context, list, n, filename, password, timeout);
+}
 #endif
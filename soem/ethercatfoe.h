@@ -16,15 +16,56 @@ extern "C"
 {
 #endif
 
+/** FoE data stream of ecx_FOEread_stream() and ecx_FOEwrite_stream().
+ * Reads or writes at most size bytes at p, returns the number of bytes,
+ * 0 at end of file or <0 to abort the transfer. */
+typedef int (*ec_FOEstreamt)(ecx_contextt *context, uint16 slave, void *userdata, uint8 *p, int size);
+
+/** one slave of ecx_FOEupdate() */
+typedef struct
+{
+   /** slave number */
+   uint16         slave;
+   /** firmware data of this slave */
+   ec_FOEstreamt  stream;
+   /** passed to stream */
+   void           *userdata;
+   /** result, >0 success, 0 slave did not reach BOOT, <0 error or EC_TIMEOUT */
+   int            wkc;
+   /** bytes acknowledged by the slave */
+   int32          datasent;
+   /** internal, transfer step */
+   uint8          step;
+   /** internal, number of last packet sent */
+   int32          packet;
+   /** internal, data size of last packet sent */
+   int            size;
+   /** internal, receive mailbox of slave */
+   ec_mbxbuft     *mbxin;
+   /** internal, transmit mailbox of slave */
+   ec_mbxbuft     *mbxout;
+   /** internal, response timer */
+   osal_timert    timer;
+} ec_FOEupdatet;
+
 #ifdef EC_VER1
 int ec_FOEdefinehook(void *hook);
 int ec_FOEread(uint16 slave, char *filename, uint32 password, int *psize, void *p, int timeout);
 int ec_FOEwrite(uint16 slave, char *filename, uint32 password, int psize, void *p, int timeout);
+int ec_FOEread_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt stream, void *userdata, int *psize, int timeout);
+int ec_FOEwrite_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt stream, void *userdata, int timeout);
+int ec_FOEupdate(ec_FOEupdatet *list, int n, char *filename, uint32 password, int timeout);
 #endif
 
 int ecx_FOEdefinehook(ecx_contextt *context, void *hook);
 int ecx_FOEread(ecx_contextt *context, uint16 slave, char *filename, uint32 password, int *psize, void *p, int timeout);
 int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 password, int psize, void *p, int timeout);
+int ecx_FOEread_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+   ec_FOEstreamt stream, void *userdata, int *psize, int timeout);
+int ecx_FOEwrite_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+   ec_FOEstreamt stream, void *userdata, int timeout);
+int ecx_FOEupdate(ecx_contextt *context, ec_FOEupdatet *list, int n, char *filename,
+   uint32 password, int timeout);
 
 #ifdef __cplusplus
 }
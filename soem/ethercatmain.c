@@ -21,10 +21,6 @@
 #include "oshw.h"
 #include "ethercat.h"
 
-
-/** delay in us for eeprom ready loop */
-#define EC_LOCALDELAY  200
-
 /** record for ethercat eeprom communications */
 PACKED_BEGIN
 typedef struct PACKED
@@ -59,6 +55,9 @@ typedef struct PACKED
 PACKED_END
 
 #ifdef EC_VER1
+/** mailbox buffers per slave of ecx_context */
+static ec_mbxpoolt      ec_mbxpool[EC_MAXSLAVE];
+
 /** Main slave data array.
  *  Each slave found on the network gets its own record.
  *  ec_slave[0] is reserved for the master. Structure gets filled
@@ -85,6 +84,9 @@ static ec_PDOassignt    ec_PDOassign[EC_MAX_MAPT];
 /** PDO description struct to store data of one slave */
 static ec_PDOdesct      ec_PDOdesc[EC_MAX_MAPT];
 
+/** asynchronous SDO engine */
+static ec_SDOasynct     ec_SDOasync;
+
 /** buffer for EEPROM SM data */
 static ec_eepromSMt     ec_SM;
 /** buffer for EEPROM FMMU data */
@@ -120,6 +122,13 @@ ecx_contextt  ecx_context = {
     NULL,               // .EOEhook()
     0,                  // .manualstatechange
     NULL,               // .userdata
+    1,                  // .maptworkers
+    NULL,               // .PDOcache
+    &ec_SDOasync,       // .SDOasync
+    &ec_mbxpool[0],     // .mbxpool
+    NULL,               // .EOEgw
+    NULL,               // .DCmaster
+    NULL,               // .DCmon
 };
 #endif
 
@@ -145,32 +154,70 @@ void ec_free_adapters (ec_adaptert * adapter)
    oshw_free_adapters (adapter);
 }
 
+/* slot storage and mask of error queue */
+static ec_eslott *ecx_errorslots(ec_eringt *elist, uint32 *mask)
+{
+   if (elist->slot && elist->size)
+   {
+      *mask = elist->size - 1;
+      return elist->slot;
+   }
+   *mask = EC_MAXELIST - 1;
+   return elist->defslot;
+}
+
 /** Pushes an error on the error list.
+ *
+ * The list is a lock-free queue that can be pushed from several threads at
+ * the same time, e.g. the cyclic thread, mailbox functions and mapper threads.
+ * A slot is claimed by moving head with compare-and-swap and handed to the
+ * consumer by its sequence number. If the list is full the error is dropped
+ * and counted, older errors are not overwritten.
  *
  * @param[in] context        = context struct
  * @param[in] Ec pointer describing the error.
  */
 void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec)
 {
-   context->elist->Error[context->elist->head] = *Ec;
-   context->elist->Error[context->elist->head].Signal = TRUE;
-   context->elist->head++;
-   if (context->elist->head > EC_MAXELIST)
-   {
-      context->elist->head = 0;
-   }
-   if (context->elist->head == context->elist->tail)
-   {
-      context->elist->tail++;
-   }
-   if (context->elist->tail > EC_MAXELIST)
+   ec_eringt *elist = context->elist;
+   ec_eslott *slots, *s;
+   uint32 mask, pos, seq;
+   int32 dif;
+
+   slots = ecx_errorslots(elist, &mask);
+   pos = osal_atomic_load(&elist->head);
+   for (;;)
    {
-      context->elist->tail = 0;
+      s = &slots[pos & mask];
+      seq = osal_atomic_load(&s->seq);
+      /* free slot has sequence of the lap of pos */
+      dif = (int32)(seq - (pos & ~mask));
+      if (dif == 0)
+      {
+         if (osal_atomic_cas(&elist->head, pos, pos + 1))
+         {
+            break;
+         }
+      }
+      else if (dif < 0)
+      {
+         /* slot not read yet, list full */
+         osal_atomic_add(&elist->dropped, 1);
+         *(context->ecaterror) = TRUE;
+         return;
+      }
+      pos = osal_atomic_load(&elist->head);
    }
+   s->Error = *Ec;
+   s->Error.Signal = TRUE;
+   s->Error.Timestamp = osal_monotonic_ns();
+   osal_atomic_store(&s->seq, (pos & ~mask) + 1);
    *(context->ecaterror) = TRUE;
 }
 
 /** Pops an error from the list.
+ *
+ * Does not block producers, can be called from a non real-time thread.
  *
  * @param[in] context        = context struct
  * @param[out] Ec = Struct describing the error.
@@ -178,23 +225,39 @@ void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec)
  */
 boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec)
 {
-   boolean notEmpty = (context->elist->head != context->elist->tail);
+   ec_eringt *elist = context->elist;
+   ec_eslott *slots, *s;
+   uint32 mask, pos, seq;
+   int32 dif;
 
-   *Ec = context->elist->Error[context->elist->tail];
-   context->elist->Error[context->elist->tail].Signal = FALSE;
-   if (notEmpty)
+   slots = ecx_errorslots(elist, &mask);
+   pos = osal_atomic_load(&elist->tail);
+   for (;;)
    {
-      context->elist->tail++;
-      if (context->elist->tail > EC_MAXELIST)
+      s = &slots[pos & mask];
+      seq = osal_atomic_load(&s->seq);
+      /* written slot has sequence of the lap of pos + 1 */
+      dif = (int32)(seq - ((pos & ~mask) + 1));
+      if (dif == 0)
+      {
+         if (osal_atomic_cas(&elist->tail, pos, pos + 1))
+         {
+            break;
+         }
+      }
+      else if (dif < 0)
       {
-         context->elist->tail = 0;
+         /* list empty or next error still being written */
+         memset(Ec, 0, sizeof(*Ec));
+         *(context->ecaterror) = FALSE;
+         return FALSE;
       }
+      pos = osal_atomic_load(&elist->tail);
    }
-   else
-   {
-      *(context->ecaterror) = FALSE;
-   }
-   return notEmpty;
+   *Ec = s->Error;
+   /* free slot for next lap */
+   osal_atomic_store(&s->seq, (pos & ~mask) + mask + 1);
+   return TRUE;
 }
 
 /** Check if error list has entries.
@@ -204,7 +267,46 @@ boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec)
  */
 boolean ecx_iserror(ecx_contextt *context)
 {
-   return (context->elist->head != context->elist->tail);
+   return (osal_atomic_load(&context->elist->head) != osal_atomic_load(&context->elist->tail));
+}
+
+/** Set storage and depth of the error list. Must be called before the list
+ * is used, e.g. before ecx_init().
+ *
+ * @param[in] context        = context struct
+ * @param[in] slot           = slot storage, NULL = EC_MAXELIST built-in slots
+ * @param[in] size           = number of slots, power of 2
+ * @return 1 if set, 0 if size is not a power of 2.
+ */
+int ecx_seterrorqueue(ecx_contextt *context, ec_eslott *slot, uint32 size)
+{
+   ec_eringt *elist = context->elist;
+
+   if (slot && ((size < 2) || (size & (size - 1))))
+   {
+      return 0;
+   }
+   elist->head = 0;
+   elist->tail = 0;
+   elist->dropped = 0;
+   elist->slot = slot;
+   elist->size = slot ? size : 0;
+   if (slot)
+   {
+      memset(slot, 0, sizeof(ec_eslott) * size);
+   }
+   memset(elist->defslot, 0, sizeof(elist->defslot));
+   return 1;
+}
+
+/** Number of errors dropped because the error list was full.
+ *
+ * @param[in] context        = context struct
+ * @return number of dropped errors since ecx_seterrorqueue().
+ */
+uint32 ecx_errordropped(ecx_contextt *context)
+{
+   return osal_atomic_load(&context->elist->dropped);
 }
 
 /** Report packet error
@@ -322,6 +424,87 @@ void ecx_close(ecx_contextt *context)
    ecx_closenic(context->port);
 };
 
+/** Prefault and lock all memory used by the context in RAM, so the first
+ * cycles after OP do not take page faults. Covers port buffers, slave and
+ * group lists, EEPROM cache, error list, index stack, mapping buffers,
+ * mailbox buffers, the optional engines and the IOmap. Engines that are
+ * set in the context later have to be locked by the application.
+ * Use osal_mem_alloc_locked() for an IOmap backed by hugepages.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  IOmap          = IOmap, NULL = none
+ * @param[in]  IOmapsize      = size of IOmap in bytes
+ * @return TRUE if all memory is locked
+ */
+boolean ecx_lockmemory(ecx_contextt *context, void *IOmap, size_t IOmapsize)
+{
+   int ok, workers;
+
+   /* mapping buffers have one entry per worker, as in ecx_config_map_group */
+   workers = context->maptworkers;
+   if (workers < 1)
+   {
+      workers = 1;
+   }
+   if (workers > EC_MAX_MAPT)
+   {
+      workers = EC_MAX_MAPT;
+   }
+   ok = osal_mem_lock(context, sizeof(*context));
+   ok &= osal_mem_lock(context->port, sizeof(*(context->port)));
+   if (context->port->redport)
+   {
+      ok &= osal_mem_lock(context->port->redport, sizeof(*(context->port->redport)));
+   }
+   ok &= osal_mem_lock(context->slavelist, sizeof(ec_slavet) * (size_t)context->maxslave);
+   ok &= osal_mem_lock(context->slavecount, sizeof(*(context->slavecount)));
+   ok &= osal_mem_lock(context->grouplist, sizeof(ec_groupt) * (size_t)context->maxgroup);
+   ok &= osal_mem_lock(context->esibuf, EC_MAXEEPBUF);
+   ok &= osal_mem_lock(context->esimap, sizeof(uint32) * EC_MAXEEPBITMAP);
+   ok &= osal_mem_lock(context->elist, sizeof(*(context->elist)));
+   if (context->elist->slot && (context->elist->slot != context->elist->defslot))
+   {
+      ok &= osal_mem_lock(context->elist->slot, sizeof(ec_eslott) * context->elist->size);
+   }
+   ok &= osal_mem_lock(context->idxstack, sizeof(*(context->idxstack)));
+   ok &= osal_mem_lock(context->ecaterror, sizeof(*(context->ecaterror)));
+   ok &= osal_mem_lock(context->DCtime, sizeof(*(context->DCtime)));
+   ok &= osal_mem_lock(context->SMcommtype, sizeof(ec_SMcommtypet) * (size_t)workers);
+   ok &= osal_mem_lock(context->PDOassign, sizeof(ec_PDOassignt) * (size_t)workers);
+   ok &= osal_mem_lock(context->PDOdesc, sizeof(ec_PDOdesct) * (size_t)workers);
+   ok &= osal_mem_lock(context->eepSM, sizeof(*(context->eepSM)));
+   ok &= osal_mem_lock(context->eepFMMU, sizeof(*(context->eepFMMU)));
+   if (context->PDOcache)
+   {
+      ok &= osal_mem_lock(context->PDOcache, sizeof(*(context->PDOcache)));
+   }
+   if (context->SDOasync)
+   {
+      ok &= osal_mem_lock(context->SDOasync, sizeof(*(context->SDOasync)));
+   }
+   if (context->mbxpool)
+   {
+      ok &= osal_mem_lock(context->mbxpool, sizeof(ec_mbxpoolt) * (size_t)context->maxslave);
+   }
+   if (context->EOEgw)
+   {
+      ok &= osal_mem_lock(context->EOEgw, sizeof(*(context->EOEgw)));
+   }
+   if (context->DCmaster)
+   {
+      ok &= osal_mem_lock(context->DCmaster, sizeof(*(context->DCmaster)));
+   }
+   if (context->DCmon)
+   {
+      ok &= osal_mem_lock(context->DCmon, sizeof(*(context->DCmon)));
+   }
+   if (IOmap)
+   {
+      ok &= osal_mem_lock(IOmap, IOmapsize);
+   }
+   return ok ? TRUE : FALSE;
+}
+
 /** Read one byte from slave EEPROM via cache.
  *  If the cache location is empty then a read request is made to the slave.
  *  Depending on the slave capabilities the request is 4 or 8 bytes.
@@ -904,6 +1087,185 @@ uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int
    return state;
 }
 
+/** Write requested state to all slaves of a group in one frame.
+ * If all slaves belong to the group one BWR is used, otherwise the FPWR
+ * datagrams of all slaves are packed in as few frames as possible.
+ * The function does not check if the actual state is changed, use
+ * ecx_statecheck_group() for that.
+ * @param[in] context     = context struct
+ * @param[in] group       = group number, 0 = all slaves
+ * @param[in] reqstate    = Requested state, including EC_STATE_ACK if needed
+ * @return Workcounter or EC_NOFRAME
+ */
+int ecx_writestate_group(ecx_contextt *context, uint8 group, uint16 reqstate)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   uint16 slave, slstate;
+   int n, wkc, rval;
+   boolean allslaves;
+
+   slstate = htoes(reqstate);
+   allslaves = TRUE;
+   for (slave = 1; group && (slave <= *(context->slavecount)); slave++)
+   {
+      if (context->slavelist[slave].group != group)
+      {
+         allslaves = FALSE;
+         break;
+      }
+   }
+   if (allslaves)
+   {
+      return ecx_BWR(context->port, 0, ECT_REG_ALCTL, sizeof(slstate),
+         &slstate, EC_TIMEOUTRET3);
+   }
+   rval = 0;
+   n = 0;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if (context->slavelist[slave].group == group)
+      {
+         dg[n].com = EC_CMD_FPWR;
+         dg[n].ADP = context->slavelist[slave].configadr;
+         dg[n].ADO = ECT_REG_ALCTL;
+         dg[n].length = sizeof(slstate);
+         dg[n].data = &slstate;
+         n++;
+      }
+      if ((n == EC_MAXMDATAGRAM) || ((n > 0) && (slave == *(context->slavecount))))
+      {
+         wkc = ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET3);
+         if (wkc == EC_NOFRAME)
+         {
+            return EC_NOFRAME;
+         }
+         rval += wkc;
+         n = 0;
+      }
+   }
+   return rval;
+}
+
+/** Check actual state of all slaves of a group.
+ * This is a blocking function. The AL status of all slaves that did not yet
+ * reach the requested state is read each iteration, packed in as few frames
+ * as possible. The poll interval starts short and is doubled while no slave
+ * makes progress. Each slave is reported once through hook as soon as it
+ * reached the requested state or has set the error flag, slaves in error
+ * are not polled any further.
+ * @param[in] context     = context struct
+ * @param[in] group       = group number, 0 = all slaves
+ * @param[in] reqstate    = Requested state
+ * @param[in] timeout     = Timeout value in us
+ * @param[in] hook        = progress callback, NULL = no reporting
+ * @return Lowest state of group after requested state is reached or timeout.
+ */
+uint16 ecx_statecheck_group(ecx_contextt *context, uint8 group, uint16 reqstate,
+   int timeout, ec_statehookt hook)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   ec_alstatust slstat[EC_MAXMDATAGRAM];
+   uint16 slca[EC_MAXMDATAGRAM];
+   uint16 slave, lowest, rval;
+   int n, i, pending, interval;
+   boolean progress;
+   osal_timert timer;
+
+   reqstate &= 0x0f;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if (!group || (group == context->slavelist[slave].group))
+      {
+         context->slavelist[slave].state = EC_STATE_NONE;
+      }
+   }
+   osal_timer_start(&timer, timeout);
+   interval = EC_STATEPOLLMIN;
+   do
+   {
+      pending = 0;
+      progress = FALSE;
+      n = 0;
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         /* still waiting for this slave ? */
+         if ((!group || (group == context->slavelist[slave].group)) &&
+             ((context->slavelist[slave].state & 0x0f) != reqstate) &&
+             !(context->slavelist[slave].state & EC_STATE_ERROR))
+         {
+            slstat[n].alstatus = 0;
+            slstat[n].alstatuscode = 0;
+            dg[n].com = EC_CMD_FPRD;
+            dg[n].ADP = context->slavelist[slave].configadr;
+            dg[n].ADO = ECT_REG_ALSTAT;
+            dg[n].length = sizeof(ec_alstatust);
+            dg[n].data = &slstat[n];
+            slca[n] = slave;
+            n++;
+         }
+         if ((n == EC_MAXMDATAGRAM) || ((n > 0) && (slave == *(context->slavecount))))
+         {
+            (void)ecx_multidatagram(context->port, dg, n, EC_TIMEOUTRET);
+            for (i = 0; i < n; i++)
+            {
+               if (dg[i].wkc <= 0)
+               {
+                  pending++;
+                  continue;
+               }
+               rval = etohs(slstat[i].alstatus);
+               context->slavelist[slca[i]].state = rval;
+               context->slavelist[slca[i]].ALstatuscode = etohs(slstat[i].alstatuscode);
+               if (((rval & 0x0f) == reqstate) || (rval & EC_STATE_ERROR))
+               {
+                  progress = TRUE;
+                  if (hook)
+                  {
+                     hook(context, slca[i], rval, context->slavelist[slca[i]].ALstatuscode);
+                  }
+               }
+               else
+               {
+                  pending++;
+               }
+            }
+            n = 0;
+         }
+      }
+      if (pending)
+      {
+         /* back off while slaves are busy, poll fast again after progress */
+         interval = progress ? EC_STATEPOLLMIN : interval * 2;
+         if (interval > EC_STATEPOLLMAX)
+         {
+            interval = EC_STATEPOLLMAX;
+         }
+         osal_usleep(interval);
+      }
+   }
+   while (pending && (osal_timer_is_expired(&timer) == FALSE));
+
+   lowest = 0xff;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if ((!group || (group == context->slavelist[slave].group)) &&
+          ((context->slavelist[slave].state & 0x0f) < lowest))
+      {
+         lowest = context->slavelist[slave].state & 0x0f;
+      }
+   }
+   if (lowest == 0xff)
+   {
+      lowest = EC_STATE_NONE;
+   }
+   if (!group)
+   {
+      context->slavelist[0].state = lowest;
+   }
+
+   return lowest;
+}
+
 /** Get index of next mailbox counter value.
  * Used for Mailbox Link Layer.
  * @param[in] cnt     = Mailbox counter value [0..7]
@@ -928,6 +1290,92 @@ void ec_clearmbx(ec_mbxbuft *Mbx)
     memset(Mbx, 0x00, EC_MAXMBX);
 }
 
+/* mailbox buffers of slave, NULL if the context has no mailbox pool or the
+ * slave is outside of it, reported as mailbox error EC_MBXERR_NOPOOL */
+static ec_mbxpoolt *ecx_mbxpool(ecx_contextt *context, uint16 slave)
+{
+   if ((context->mbxpool == NULL) || (slave >= context->maxslave))
+   {
+      ecx_mbxerror(context, slave, EC_MBXERR_NOPOOL);
+      return NULL;
+   }
+   return &(context->mbxpool[slave]);
+}
+
+/* clear length of mailbox buffer, only the part transferred to or from the
+ * slave needs to be cleared */
+static void ecx_mbxclear(ec_mbxbuft *Mbx, uint16 length)
+{
+   if ((length == 0) || (length > EC_MAXMBX))
+   {
+      length = EC_MAXMBX;
+   }
+   memset(Mbx, 0x00, length);
+}
+
+/** Borrow receive mailbox buffer of slave from the context mailbox pool.
+ * The buffer is cleared over the read mailbox length of the slave. It stays
+ * valid until the next call for the same slave, so mailbox transfers to one
+ * slave must not run concurrently from different threads.
+ * @param[in]  context  = context struct
+ * @param[in]  slave    = Slave number
+ * @return receive mailbox buffer, NULL if the context has no mailbox pool or
+ * slave is not below maxslave, an EC_ERR_TYPE_MBX_ERROR is added then
+ */
+ec_mbxbuft *ecx_mbxin(ecx_contextt *context, uint16 slave)
+{
+   ec_mbxpoolt *pool;
+
+   pool = ecx_mbxpool(context, slave);
+   if (pool == NULL)
+   {
+      return NULL;
+   }
+   ecx_mbxclear(&(pool->in), context->slavelist[slave].mbx_rl);
+   return &(pool->in);
+}
+
+/** Borrow transmit mailbox buffer of slave from the context mailbox pool.
+ * The buffer is cleared over the write mailbox length of the slave.
+ * @param[in]  context  = context struct
+ * @param[in]  slave    = Slave number
+ * @return transmit mailbox buffer, NULL if slave has no pool entry
+ * @see ecx_mbxin
+ */
+ec_mbxbuft *ecx_mbxout(ecx_contextt *context, uint16 slave)
+{
+   ec_mbxpoolt *pool;
+
+   pool = ecx_mbxpool(context, slave);
+   if (pool == NULL)
+   {
+      return NULL;
+   }
+   ecx_mbxclear(&(pool->out), context->slavelist[slave].mbx_l);
+   return &(pool->out);
+}
+
+/** Borrow second transmit mailbox buffer of slave from the context mailbox
+ * pool, for protocols that prepare the next message while the current one
+ * may still have to be repeated. Cleared over the write mailbox length.
+ * @param[in]  context  = context struct
+ * @param[in]  slave    = Slave number
+ * @return transmit mailbox buffer, NULL if slave has no pool entry
+ * @see ecx_mbxin
+ */
+ec_mbxbuft *ecx_mbxspare(ecx_contextt *context, uint16 slave)
+{
+   ec_mbxpoolt *pool;
+
+   pool = ecx_mbxpool(context, slave);
+   if (pool == NULL)
+   {
+      return NULL;
+   }
+   ecx_mbxclear(&(pool->spare), context->slavelist[slave].mbx_l);
+   return &(pool->spare);
+}
+
 /** Check if IN mailbox of slave is empty.
  * @param[in] context  = context struct
  * @param[in] slave    = Slave number
@@ -995,8 +1443,136 @@ int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout
    return wkc;
 }
 
+/** Handle mailbox messages that are not a response to a request.
+ * Mailbox errors and CoE emergencies are pushed on the error list, EoE
+ * fragments are passed to the EoE hook if registered.
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[in]  mbx        = Mailbox data read from slave
+ * @return TRUE if mailbox is handled and should not be used any further
+ */
+boolean ecx_mbxhandlemsg(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx)
+{
+   ec_mbxheadert *mbxh;
+   ec_emcyt *EMp;
+   ec_mbxerrort *MBXEp;
+   boolean handled = FALSE;
+
+   mbxh = (ec_mbxheadert *)mbx;
+   if ((mbxh->mbxtype & 0x0f) == 0x00) /* Mailbox error response? */
+   {
+      MBXEp = (ec_mbxerrort *)mbx;
+      ecx_mbxerror(context, slave, etohs(MBXEp->Detail));
+      handled = TRUE;
+   }
+   else if ((mbxh->mbxtype & 0x0f) == ECT_MBXT_COE) /* CoE response? */
+   {
+      EMp = (ec_emcyt *)mbx;
+      if ((etohs(EMp->CANOpen) >> 12) == 0x01) /* Emergency request? */
+      {
+         ecx_mbxemergencyerror(context, slave, etohs(EMp->ErrorCode), EMp->ErrorReg,
+                 EMp->bData, etohs(EMp->w1), etohs(EMp->w2));
+         handled = TRUE;
+      }
+   }
+   else if ((mbxh->mbxtype & 0x0f) == ECT_MBXT_EOE) /* EoE response? */
+   {
+      ec_EOEt * eoembx = (ec_EOEt *)mbx;
+      uint16 frameinfo1 = etohs(eoembx->frameinfo1);
+      /* All non fragment data frame types are expected to be handled by
+      * slave send/receive API if the EoE hook is set
+      */
+      if (EOE_HDR_FRAME_TYPE_GET(frameinfo1) == EOE_FRAG_DATA)
+      {
+         if (ecx_EOEgw_input(context, slave, mbx))
+         {
+            /* Fragment reassembled by EoE gateway */
+            handled = TRUE;
+         }
+         else if (context->EOEhook)
+         {
+            if (context->EOEhook(context, slave, eoembx) > 0)
+            {
+               /* Fragment handled by EoE hook */
+               handled = TRUE;
+            }
+         }
+      }
+   }
+
+   return handled;
+}
+
+/* length of a mailbox message read from slave */
+static uint16 ecx_mbxparklength(ecx_contextt *context, uint16 slave)
+{
+   uint16 length = context->slavelist[slave].mbx_rl;
+
+   return ((length > 0) && (length <= EC_MAXMBX)) ? length : EC_MAXMBX;
+}
+
+/** Park a mailbox message read from slave for another mailbox user.
+ * Used by readers that serve only one protocol, like the EoE gateway, so
+ * replies they read are still found by ecx_mbxreceive() and the
+ * asynchronous SDO engine. One thread parks, any thread may take.
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[in]  mbx        = Mailbox data read from slave
+ * @return TRUE if parked, FALSE if no pool or the park queue is full
+ */
+boolean ecx_mbxpark(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx)
+{
+   ec_mbxpoolt *pool;
+   uint32 head;
+
+   if ((context->mbxpool == NULL) || (slave >= context->maxslave))
+   {
+      return FALSE;
+   }
+   pool = &(context->mbxpool[slave]);
+   head = pool->parkhead;
+   if ((head - osal_atomic_load(&(pool->parktail))) >= EC_MBXPARK)
+   {
+      return FALSE;
+   }
+   memcpy(&(pool->park[head % EC_MBXPARK]), mbx, ecx_mbxparklength(context, slave));
+   /* release, the message is complete before it is visible */
+   osal_atomic_store(&(pool->parkhead), head + 1);
+   return TRUE;
+}
+
+/** Take the oldest parked mailbox message of slave.
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[out] mbx        = Mailbox data
+ * @return TRUE if a message was taken
+ */
+boolean ecx_mbxunpark(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx)
+{
+   ec_mbxpoolt *pool;
+   uint32 tail;
+
+   if ((context->mbxpool == NULL) || (slave >= context->maxslave))
+   {
+      return FALSE;
+   }
+   pool = &(context->mbxpool[slave]);
+   do
+   {
+      tail = osal_atomic_load(&(pool->parktail));
+      if (tail == osal_atomic_load(&(pool->parkhead)))
+      {
+         return FALSE;
+      }
+      memcpy(mbx, &(pool->park[tail % EC_MBXPARK]), ecx_mbxparklength(context, slave));
+   /* another taker was first, the copy may be overwritten already */
+   } while (!osal_atomic_cas(&(pool->parktail), tail, tail + 1));
+   return TRUE;
+}
+
 /** Read OUT mailbox from slave.
- * Supports Mailbox Link Layer with repeat requests.
+ * Supports Mailbox Link Layer with repeat requests. A message parked by
+ * the EoE gateway for this slave is returned instead of reading the slave.
  * @param[in]  context    = context struct
  * @param[in]  slave      = Slave number
  * @param[out] mbx        = Mailbox data
@@ -1010,9 +1586,6 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
    int wkc2;
    uint16 SMstat;
    uint8 SMcontr;
-   ec_mbxheadert *mbxh;
-   ec_emcyt *EMp;
-   ec_mbxerrort *MBXEp;
 
    configadr = context->slavelist[slave].configadr;
    mbxl = context->slavelist[slave].mbx_rl;
@@ -1024,6 +1597,11 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
       wkc = 0;
       do /* wait for read mailbox available */
       {
+         /* the EoE gateway may read the mailbox from the cyclic task */
+         if (ecx_mbxunpark(context, slave, mbx))
+         {
+            return 1;
+         }
          SMstat = 0;
          wkc = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
          SMstat = etohs(SMstat);
@@ -1037,67 +1615,35 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
       if ((wkc > 0) && ((SMstat & 0x08) > 0)) /* read mailbox available ? */
       {
          mbxro = context->slavelist[slave].mbx_ro;
-         mbxh = (ec_mbxheadert *)mbx;
          do
          {
             wkc = ecx_FPRD(context->port, configadr, mbxro, mbxl, mbx, EC_TIMEOUTRET); /* get mailbox */
-            if ((wkc > 0) && ((mbxh->mbxtype & 0x0f) == 0x00)) /* Mailbox error response? */
-            {
-               MBXEp = (ec_mbxerrort *)mbx;
-               ecx_mbxerror(context, slave, etohs(MBXEp->Detail));
-               wkc = 0; /* prevent emergency to cascade up, it is already handled. */
-            }
-            else if ((wkc > 0) && ((mbxh->mbxtype & 0x0f) == ECT_MBXT_COE)) /* CoE response? */
+            if (wkc > 0)
             {
-               EMp = (ec_emcyt *)mbx;
-               if ((etohs(EMp->CANOpen) >> 12) == 0x01) /* Emergency request? */
+               if (ecx_mbxhandlemsg(context, slave, mbx))
                {
-                  ecx_mbxemergencyerror(context, slave, etohs(EMp->ErrorCode), EMp->ErrorReg,
-                          EMp->bData, etohs(EMp->w1), etohs(EMp->w2));
                   wkc = 0; /* prevent emergency to cascade up, it is already handled. */
                }
             }
-            else if ((wkc > 0) && ((mbxh->mbxtype & 0x0f) == ECT_MBXT_EOE)) /* EoE response? */
+            else /* read mailbox lost */
             {
-               ec_EOEt * eoembx = (ec_EOEt *)mbx;
-               uint16 frameinfo1 = etohs(eoembx->frameinfo1);
-               /* All non fragment data frame types are expected to be handled by
-               * slave send/receive API if the EoE hook is set
-               */
-               if (EOE_HDR_FRAME_TYPE_GET(frameinfo1) == EOE_FRAG_DATA)
+               SMstat ^= 0x0200; /* toggle repeat request */
+               SMstat = htoes(SMstat);
+               wkc2 = ecx_FPWR(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+               SMstat = etohs(SMstat);
+               do /* wait for toggle ack */
                {
-                  if (context->EOEhook)
-                  {
-                     if (context->EOEhook(context, slave, eoembx) > 0)
-                     {
-                        /* Fragment handled by EoE hook */
-                        wkc = 0;
-                     }
-                  }
-               }
-            }
-            else
-            {
-               if (wkc <= 0) /* read mailbox lost */
+                  wkc2 = ecx_FPRD(context->port, configadr, ECT_REG_SM1CONTR, sizeof(SMcontr), &SMcontr, EC_TIMEOUTRET);
+                } while (((wkc2 <= 0) || ((SMcontr & 0x02) != (HI_BYTE(SMstat) & 0x02))) && (osal_timer_is_expired(&timer) == FALSE));
+               do /* wait for read mailbox available */
                {
-                  SMstat ^= 0x0200; /* toggle repeat request */
-                  SMstat = htoes(SMstat);
-                  wkc2 = ecx_FPWR(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+                  wkc2 = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
                   SMstat = etohs(SMstat);
-                  do /* wait for toggle ack */
+                  if (((SMstat & 0x08) == 0) && (timeout > EC_LOCALDELAY))
                   {
-                     wkc2 = ecx_FPRD(context->port, configadr, ECT_REG_SM1CONTR, sizeof(SMcontr), &SMcontr, EC_TIMEOUTRET);
-                   } while (((wkc2 <= 0) || ((SMcontr & 0x02) != (HI_BYTE(SMstat) & 0x02))) && (osal_timer_is_expired(&timer) == FALSE));
-                  do /* wait for read mailbox available */
-                  {
-                     wkc2 = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
-                     SMstat = etohs(SMstat);
-                     if (((SMstat & 0x08) == 0) && (timeout > EC_LOCALDELAY))
-                     {
-                        osal_usleep(EC_LOCALDELAY);
-                     }
-                  } while (((wkc2 <= 0) || ((SMstat & 0x08) == 0)) && (osal_timer_is_expired(&timer) == FALSE));
-               }
+                     osal_usleep(EC_LOCALDELAY);
+                  }
+               } while (((wkc2 <= 0) || ((SMstat & 0x08) == 0)) && (osal_timer_is_expired(&timer) == FALSE));
             }
          } while ((wkc <= 0) && (osal_timer_is_expired(&timer) == FALSE)); /* if WKC<=0 repeat */
       }
@@ -1775,8 +2321,13 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
                   DCO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
                                            context->slavelist[context->grouplist[group].DCnext].configadr,
                                            ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+                  ecx_dcmaster_tx(context, idx, group);
+                  ecx_dcmon_tx(context, idx);
                   first = FALSE;
                }
+               /* add pending mailbox steps */
+               ecx_SDOasync_tx(context, idx);
+               ecx_EOEgw_tx(context, idx);
                /* send frame */
                ecx_outframe_red(context->port, idx);
                /* push index and data pointer on stack */
@@ -1813,8 +2364,13 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
                   DCO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
                                            context->slavelist[context->grouplist[group].DCnext].configadr,
                                            ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+                  ecx_dcmaster_tx(context, idx, group);
+                  ecx_dcmon_tx(context, idx);
                   first = FALSE;
                }
+               /* add pending mailbox steps */
+               ecx_SDOasync_tx(context, idx);
+               ecx_EOEgw_tx(context, idx);
                /* send frame */
                ecx_outframe_red(context->port, idx);
                /* push index and data pointer on stack */
@@ -1854,8 +2410,13 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
                DCO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
                                         context->slavelist[context->grouplist[group].DCnext].configadr,
                                         ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+               ecx_dcmaster_tx(context, idx, group);
+               ecx_dcmon_tx(context, idx);
                first = FALSE;
             }
+            /* add pending mailbox steps */
+            ecx_SDOasync_tx(context, idx);
+            ecx_EOEgw_tx(context, idx);
             /* send frame */
             ecx_outframe_red(context->port, idx);
             /* push index and data pointer on stack.
@@ -1957,7 +2518,9 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
             {
                /* copy input data back to process data buffer */
                memcpy(idxstack->data[pos], &(rxbuf[idx][EC_HEADERSIZE]), idxstack->length[pos]);
-               wkc += wkc2;
+               /* wkc of first datagram, mailbox datagrams may follow */
+               memcpy(&le_wkc, &(rxbuf[idx][EC_HEADERSIZE + idxstack->length[pos]]), EC_WKCSIZE);
+               wkc += etohs(le_wkc);
             }
             valid_wkc = 1;
          }
@@ -1973,12 +2536,18 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
             }
             else
             {
+               memcpy(&le_wkc, &(rxbuf[idx][EC_HEADERSIZE + idxstack->length[pos]]), EC_WKCSIZE);
                /* output WKC counts 2 times when using LRW, emulate the same for LWR */
-               wkc += wkc2 * 2;
+               wkc += etohs(le_wkc) * 2;
             }
             valid_wkc = 1;
          }
       }
+      /* advance mailbox steps that were added to this frame */
+      ecx_SDOasync_rx(context, idx, wkc2);
+      ecx_EOEgw_rx(context, idx, wkc2);
+      ecx_dcmaster_rx(context, idx, wkc2);
+      ecx_dcmon_rx(context, idx, wkc2);
       /* release buffer */
       ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
       /* get next index */
@@ -2027,6 +2596,16 @@ boolean ec_iserror(void)
    return ecx_iserror(&ecx_context);
 }
 
+int ec_seterrorqueue(ec_eslott *slot, uint32 size)
+{
+   return ecx_seterrorqueue(&ecx_context, slot, size);
+}
+
+uint32 ec_errordropped(void)
+{
+   return ecx_errordropped(&ecx_context);
+}
+
 void ec_packeterror(uint16 Slave, uint16 Index, uint8 SubIdx, uint16 ErrorCode)
 {
    ecx_packeterror(&ecx_context, Slave, Index, SubIdx, ErrorCode);
@@ -2061,6 +2640,17 @@ void ec_close(void)
    ecx_close(&ecx_context);
 };
 
+/** Prefault and lock all memory used by the default context.
+ * @param[in]  IOmap          = IOmap, NULL = none
+ * @param[in]  IOmapsize      = size of IOmap in bytes
+ * @return TRUE if all memory is locked
+ * @see ecx_lockmemory
+ */
+boolean ec_lockmemory(void *IOmap, size_t IOmapsize)
+{
+   return ecx_lockmemory(&ecx_context, IOmap, IOmapsize);
+}
+
 /** Read one byte from slave EEPROM via cache.
  *  If the cache location is empty then a read request is made to the slave.
  *  Depending on the slave capabillities the request is 4 or 8 bytes.
@@ -2182,6 +2772,30 @@ uint16 ec_statecheck(uint16 slave, uint16 reqstate, int timeout)
    return ecx_statecheck (&ecx_context, slave, reqstate, timeout);
 }
 
+/** Write requested state to all slaves of a group in one frame.
+ * @param[in] group       = group number, 0 = all slaves
+ * @param[in] reqstate    = Requested state, including EC_STATE_ACK if needed
+ * @return Workcounter or EC_NOFRAME
+ * @see ecx_writestate_group
+ */
+int ec_writestate_group(uint8 group, uint16 reqstate)
+{
+   return ecx_writestate_group(&ecx_context, group, reqstate);
+}
+
+/** Check actual state of all slaves of a group, polled in one frame.
+ * @param[in] group       = group number, 0 = all slaves
+ * @param[in] reqstate    = Requested state
+ * @param[in] timeout     = Timeout value in us
+ * @param[in] hook        = progress callback, NULL = no reporting
+ * @return Lowest state of group after requested state is reached or timeout.
+ * @see ecx_statecheck_group
+ */
+uint16 ec_statecheck_group(uint8 group, uint16 reqstate, int timeout, ec_statehookt hook)
+{
+   return ecx_statecheck_group(&ecx_context, group, reqstate, timeout, hook);
+}
+
 /** Check if IN mailbox of slave is empty.
  * @param[in] slave    = Slave number
  * @param[in] timeout  = Timeout in us
@@ -2218,6 +2832,37 @@ int ec_mbxreceive(uint16 slave, ec_mbxbuft *mbx, int timeout)
    return ecx_mbxreceive (&ecx_context, slave, mbx, timeout);
 }
 
+/** Handle mailbox messages that are not a response to a request.
+ * @param[in]  slave      = Slave number
+ * @param[in]  mbx        = Mailbox data read from slave
+ * @return TRUE if mailbox is handled and should not be used any further
+ * @see ecx_mbxhandlemsg
+ */
+boolean ec_mbxhandlemsg(uint16 slave, ec_mbxbuft *mbx)
+{
+   return ecx_mbxhandlemsg(&ecx_context, slave, mbx);
+}
+
+/** Borrow receive mailbox buffer of slave.
+ * @param[in]  slave    = Slave number
+ * @return receive mailbox buffer
+ * @see ecx_mbxin
+ */
+ec_mbxbuft *ec_mbxin(uint16 slave)
+{
+   return ecx_mbxin(&ecx_context, slave);
+}
+
+/** Borrow transmit mailbox buffer of slave.
+ * @param[in]  slave    = Slave number
+ * @return transmit mailbox buffer
+ * @see ecx_mbxout
+ */
+ec_mbxbuft *ec_mbxout(uint16 slave)
+{
+   return ecx_mbxout(&ecx_context, slave);
+}
+
 /** Dump complete EEPROM data from slave in buffer.
  * @param[in]  slave    = Slave number
  * @param[out] esibuf   = EEPROM data buffer, make sure it is big enough.
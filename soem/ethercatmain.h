@@ -37,8 +37,17 @@ extern "C"
 #define EC_MAXFMMU        4
 /** max. Adapter */
 #define EC_MAXLEN_ADAPTERNAME    128
-/** define maximum number of concurrent threads in mapping */
-#define EC_MAX_MAPT           1
+/** define maximum number of concurrent threads in mapping, targets without
+ * osal_thread_join and osal_mutex support set this to 1 in osal_defs.h */
+#ifndef EC_MAX_MAPT
+#define EC_MAX_MAPT           4
+#endif
+/** delay in us for eeprom ready loop */
+#define EC_LOCALDELAY         200
+/** shortest poll interval in us of ecx_statecheck_group */
+#define EC_STATEPOLLMIN       100
+/** longest poll interval in us of ecx_statecheck_group */
+#define EC_STATEPOLLMAX       5000
 
 typedef struct ec_adapter ec_adaptert;
 struct ec_adapter
@@ -101,6 +110,14 @@ PACKED_END
 #define EC_SMENABLEMASK      0xfffeffff
 
 typedef struct ecx_context ecx_contextt;
+/** asynchronous SDO engine, see ethercatcoe.h */
+typedef struct ec_SDOasync ec_SDOasynct;
+/** EoE gateway, see ethercateoe.h */
+typedef struct ec_EOEgw ec_EOEgwt;
+/** master clock as DC reference, see ethercatdc.h */
+typedef struct ec_dcmaster ec_dcmastert;
+/** DC synchronisation monitor, see ethercatdc.h */
+typedef struct ec_dcmon ec_dcmont;
 
 /** for list of ethercat slaves detected */
 typedef struct ec_slave
@@ -165,6 +182,8 @@ typedef struct ec_slave
    uint16           mbx_proto;
    /** Counter value of mailbox link layer protocol 1..7 */
    uint8            mbx_cnt;
+   /** EoE frame number of last frame sent to slave */
+   uint8            eoe_frameno;
    /** has DC capability */
    boolean          hasdc;
    /** Physical type; Ebus, EtherNet combinations */
@@ -311,6 +330,28 @@ typedef struct ec_eepromPDO
 /** mailbox buffer array */
 typedef uint8 ec_mbxbuft[EC_MAXMBX + 1];
 
+/** mailbox error detail reported by the master when a context has no
+ * mailbox pool entry for a slave, outside of the slave defined range */
+#define EC_MBXERR_NOPOOL     0x0100
+
+/** number of mailbox messages that can be parked per slave */
+#define EC_MBXPARK           2
+
+/** mailbox buffers of one slave, borrowed by the mailbox protocol functions */
+typedef struct ec_mbxpool
+{
+   /** receive buffer, data from slave */
+   ec_mbxbuft in;
+   /** transmit buffer, data to slave */
+   ec_mbxbuft out;
+   /** second transmit buffer, prefetched packet of ecx_FOEwrite_stream() */
+   ec_mbxbuft spare;
+   /** messages read by the EoE gateway for other mailbox users, in read order */
+   ec_mbxbuft park[EC_MBXPARK];
+   /** number of messages parked and taken, the difference is the fill level */
+   uint32     parkhead, parktail;
+} ec_mbxpoolt;
+
 /** standard ethercat mailbox header */
 PACKED_BEGIN
 typedef struct PACKED ec_mbxheader
@@ -343,12 +384,29 @@ typedef struct ec_idxstack
    uint16  dcoffset[EC_MAXBUF];
 } ec_idxstackT;
 
-/** ringbuf for error storage */
+/** slot of error queue */
+typedef struct
+{
+   /** slot sequence, tells producers and consumers if the slot is free */
+   uint32    seq;
+   ec_errort Error;
+} ec_eslott;
+
+/** lock-free multi-producer queue for error storage. A zero initialised
+ * queue is valid and uses the EC_MAXELIST slots in defslot. */
 typedef struct ec_ering
 {
-   int16     head;
-   int16     tail;
-   ec_errort Error[EC_MAXELIST + 1];
+   /** next position to write, claimed by producers */
+   uint32    head;
+   /** next position to read */
+   uint32    tail;
+   /** errors dropped because the queue was full */
+   uint32    dropped;
+   /** number of slots, power of 2. 0 = EC_MAXELIST slots in defslot */
+   uint32    size;
+   /** slot storage set by ecx_seterrorqueue(), NULL = defslot */
+   ec_eslott *slot;
+   ec_eslott defslot[EC_MAXELIST];
 } ec_eringt;
 
 /** SyncManager Communication Type structure for CA */
@@ -381,6 +439,49 @@ typedef struct PACKED ec_PDOdesc
 } ec_PDOdesct;
 PACKED_END
 
+/** max. number of slave types in CoE PDO mapping cache */
+#define EC_MAXPDOCACHE    32
+
+/** CoE PDO mapping of one slave type and PDO assignment */
+typedef struct ec_PDOcacheentry
+{
+   /** Manufacturer from EEprom */
+   uint32  eep_man;
+   /** ID from EEprom */
+   uint32  eep_id;
+   /** revision from EEprom */
+   uint32  eep_rev;
+   /** hash over content of the PDO assign objects 1C12 and up */
+   uint32  assignhash;
+   /** output bits */
+   uint32  Osize;
+   /** input bits */
+   uint32  Isize;
+   /** SM type per SM */
+   uint8   SMtype[EC_MAXSM];
+   /** SM length per SM in host order, 0 = not a process data SM */
+   uint16  SMlength[EC_MAXSM];
+} ec_PDOcacheentryt;
+
+/** CoE PDO mapping cache, contains no pointers so it can be stored and
+ * reloaded by the application. A cached mapping is confirmed by the content
+ * of the PDO assign objects only, the PDO mapping objects 16xx/1Axx are not
+ * read again. Only use the cache when slaves with equal identity and PDO
+ * assignment also have equal PDO mapping objects, i.e. they are not changed
+ * per slave by PO2SOconfig hooks. */
+typedef struct ec_PDOcache
+{
+   /** number of used entries */
+   uint16  entries;
+   /** cached mappings */
+   ec_PDOcacheentryt entry[EC_MAXPDOCACHE];
+} ec_PDOcachet;
+
+/** progress callback of ecx_statecheck_group(), called once per slave when
+ * it reached the requested state or reported an error */
+typedef void (*ec_statehookt)(ecx_contextt *context, uint16 slave,
+   uint16 alstatus, uint16 alstatuscode);
+
 /** Context structure , referenced by all ecx functions*/
 struct ecx_context
 {
@@ -429,6 +530,25 @@ struct ecx_context
    /** userdata, promotes application configuration esp. in EC_VER2 with multiple 
     * ec_context instances. Note: userdata memory is managed by application, not SOEM */
    void           *userdata;
+   /** number of mapping worker threads used in ecx_config_map_group,
+    * 0 = 1, at most EC_MAX_MAPT. SMcommtype, PDOassign and PDOdesc need one
+    * entry per worker. The workers are started and joined per call. */
+   int            maptworkers;
+   /** CoE PDO mapping cache, opt-in, NULL = each slave is read completely */
+   ec_PDOcachet   *PDOcache;
+   /** asynchronous SDO engine, NULL = no mailbox traffic in process data frames */
+   ec_SDOasynct   *SDOasync;
+   /** mailbox buffers, maxslave entries, one per slave in slavelist. Each
+    * context needs its own pool, mailbox functions fail when NULL and add
+    * a mailbox error EC_MBXERR_NOPOOL to the error list */
+   ec_mbxpoolt    *mbxpool;
+   /** EoE gateway, NULL = not active, set by ecx_EOEgw_init() */
+   ec_EOEgwt      *EOEgw;
+   /** master clock as DC reference, NULL = first DC slave is reference,
+    * set by ecx_dcmaster_init() */
+   ec_dcmastert   *DCmaster;
+   /** DC synchronisation monitor, NULL = not active, set by ecx_dcmon_start() */
+   ec_dcmont      *DCmon;
 };
 
 #ifdef EC_VER1
@@ -446,10 +566,13 @@ extern int64       ec_DCtime;
 void ec_pusherror(const ec_errort *Ec);
 boolean ec_poperror(ec_errort *Ec);
 boolean ec_iserror(void);
+int ec_seterrorqueue(ec_eslott *slot, uint32 size);
+uint32 ec_errordropped(void);
 void ec_packeterror(uint16 Slave, uint16 Index, uint8 SubIdx, uint16 ErrorCode);
 int ec_init(const char * ifname);
 int ec_init_redundant(const char *ifname, char *if2name);
 void ec_close(void);
+boolean ec_lockmemory(void *IOmap, size_t IOmapsize);
 uint8 ec_siigetbyte(uint16 slave, uint16 address);
 int16 ec_siifind(uint16 slave, uint16 cat);
 void ec_siistring(char *str, uint16 slave, uint16 Sn);
@@ -460,9 +583,12 @@ uint32 ec_siiPDO(uint16 slave, ec_eepromPDOt* PDO, uint8 t);
 int ec_readstate(void);
 int ec_writestate(uint16 slave);
 uint16 ec_statecheck(uint16 slave, uint16 reqstate, int timeout);
+int ec_writestate_group(uint8 group, uint16 reqstate);
+uint16 ec_statecheck_group(uint8 group, uint16 reqstate, int timeout, ec_statehookt hook);
 int ec_mbxempty(uint16 slave, int timeout);
 int ec_mbxsend(uint16 slave,ec_mbxbuft *mbx, int timeout);
 int ec_mbxreceive(uint16 slave, ec_mbxbuft *mbx, int timeout);
+boolean ec_mbxhandlemsg(uint16 slave, ec_mbxbuft *mbx);
 void ec_esidump(uint16 slave, uint8 *esibuf);
 uint32 ec_readeeprom(uint16 slave, uint16 eeproma, int timeout);
 int ec_writeeeprom(uint16 slave, uint16 eeproma, uint16 data, int timeout);
@@ -486,13 +612,18 @@ ec_adaptert * ec_find_adapters(void);
 void ec_free_adapters(ec_adaptert * adapter);
 uint8 ec_nextmbxcnt(uint8 cnt);
 void ec_clearmbx(ec_mbxbuft *Mbx);
+ec_mbxbuft *ec_mbxin(uint16 slave);
+ec_mbxbuft *ec_mbxout(uint16 slave);
 void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec);
 boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec);
 boolean ecx_iserror(ecx_contextt *context);
+int ecx_seterrorqueue(ecx_contextt *context, ec_eslott *slot, uint32 size);
+uint32 ecx_errordropped(ecx_contextt *context);
 void ecx_packeterror(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubIdx, uint16 ErrorCode);
 int ecx_init(ecx_contextt *context, const char * ifname);
 int ecx_init_redundant(ecx_contextt *context, ecx_redportt *redport, const char *ifname, char *if2name);
 void ecx_close(ecx_contextt *context);
+boolean ecx_lockmemory(ecx_contextt *context, void *IOmap, size_t IOmapsize);
 uint8 ecx_siigetbyte(ecx_contextt *context, uint16 slave, uint16 address);
 int16 ecx_siifind(ecx_contextt *context, uint16 slave, uint16 cat);
 void ecx_siistring(ecx_contextt *context, char *str, uint16 slave, uint16 Sn);
@@ -503,9 +634,18 @@ uint32 ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8
 int ecx_readstate(ecx_contextt *context);
 int ecx_writestate(ecx_contextt *context, uint16 slave);
 uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int timeout);
+int ecx_writestate_group(ecx_contextt *context, uint8 group, uint16 reqstate);
+uint16 ecx_statecheck_group(ecx_contextt *context, uint8 group, uint16 reqstate,
+   int timeout, ec_statehookt hook);
 int ecx_mbxempty(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout);
 int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int timeout);
+boolean ecx_mbxhandlemsg(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx);
+boolean ecx_mbxpark(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx);
+boolean ecx_mbxunpark(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx);
+ec_mbxbuft *ecx_mbxin(ecx_contextt *context, uint16 slave);
+ec_mbxbuft *ecx_mbxout(ecx_contextt *context, uint16 slave);
+ec_mbxbuft *ecx_mbxspare(ecx_contextt *context, uint16 slave);
 void ecx_esidump(ecx_contextt *context, uint16 slave, uint8 *esibuf);
 uint32 ecx_readeeprom(ecx_contextt *context, uint16 slave, uint16 eeproma, int timeout);
 int ecx_writeeeprom(ecx_contextt *context, uint16 slave, uint16 eeproma, uint16 data, int timeout);
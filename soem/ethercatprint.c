@@ -216,6 +216,7 @@ const ec_mbxerrorlist_t ec_mbxerrorlist[] = {
    {0x0006, "Length of received mailbox data is too short"},
    {0x0007, "No more memory in slave"},
    {0x0008, "The length of data is inconsistent"},
+   {EC_MBXERR_NOPOOL, "No mailbox buffers for slave in master context"},
    {0xffff, "Unknown"}
 };
 
@@ -83,16 +83,20 @@ int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elemen
    uint8 *bp;
    uint8 *mp;
    uint16 *errorcode;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
    boolean NotLast;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSoEp = (ec_SoEt *)&MbxIn;
-   SoEp = (ec_SoEt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aSoEp = (ec_SoEt *)MbxIn;
+   SoEp = (ec_SoEt *)MbxOut;
    SoEp->MbxHeader.length = htoes(sizeof(ec_SoEt) - sizeof(ec_mbxheadert));
    SoEp->MbxHeader.address = htoes(0x0000);
    SoEp->MbxHeader.priority = 0x00;
@@ -108,18 +112,18 @@ int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elemen
    SoEp->idn = htoes(idn);
    totalsize = 0;
    bp = p;
-   mp = (uint8 *)&MbxIn + sizeof(ec_SoEt);
+   mp = (uint8 *)MbxIn + sizeof(ec_SoEt);
    NotLast = TRUE;
    /* send SoE request to slave */
-   wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+   wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
    if (wkc > 0) /* succeeded to place mailbox in slave ? */
    {
       while (NotLast)
       {
          /* clean mailboxbuffer */
-         ec_clearmbx(&MbxIn);
+         MbxIn = ecx_mbxin(context, slave);
          /* read slave response */
-         wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+         wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
          if (wkc > 0) /* succeeded to read slave response ? */
          {
             /* slave response should be SoE, ReadRes */
@@ -161,7 +165,7 @@ int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elemen
                    (aSoEp->opCode == ECT_SOE_READRES) &&
                    (aSoEp->error == 1))
                {
-                  mp = (uint8 *)&MbxIn + (etohs(aSoEp->MbxHeader.length) + sizeof(ec_mbxheadert) - sizeof(uint16));
+                  mp = (uint8 *)MbxIn + (etohs(aSoEp->MbxHeader.length) + sizeof(ec_mbxheadert) - sizeof(uint16));
                   errorcode = (uint16 *)mp;
                   ecx_SoEerror(context, slave, idn, *errorcode);
                }
@@ -205,16 +209,20 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
    uint8 *mp;
    uint8 *hp;
    uint16 *errorcode;
-   ec_mbxbuft MbxIn, MbxOut;
+   ec_mbxbuft *MbxIn, *MbxOut;
    uint8 cnt;
    boolean NotLast;
 
-   ec_clearmbx(&MbxIn);
+   MbxIn = ecx_mbxin(context, slave);
+   if (MbxIn == NULL)
+   {
+      return 0;
+   }
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
-   wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
-   ec_clearmbx(&MbxOut);
-   aSoEp = (ec_SoEt *)&MbxIn;
-   SoEp = (ec_SoEt *)&MbxOut;
+   wkc = ecx_mbxreceive(context, slave, MbxIn, 0);
+   MbxOut = ecx_mbxout(context, slave);
+   aSoEp = (ec_SoEt *)MbxIn;
+   SoEp = (ec_SoEt *)MbxOut;
    SoEp->MbxHeader.address = htoes(0x0000);
    SoEp->MbxHeader.priority = 0x00;
    SoEp->opCode = ECT_SOE_WRITEREQ;
@@ -222,7 +230,7 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
    SoEp->driveNo = driveNo;
    SoEp->elementflags = elementflags;
    hp = p;
-   mp = (uint8 *)&MbxOut + sizeof(ec_SoEt);
+   mp = (uint8 *)MbxOut + sizeof(ec_SoEt);
    maxdata = context->slavelist[slave].mbx_l - sizeof(ec_SoEt);
    NotLast = TRUE;
    while (NotLast)
@@ -248,15 +256,15 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
       hp += framedatasize;
       psize -= framedatasize;
       /* send SoE request to slave */
-      wkc = ecx_mbxsend(context, slave, (ec_mbxbuft *)&MbxOut, EC_TIMEOUTTXM);
+      wkc = ecx_mbxsend(context, slave, MbxOut, EC_TIMEOUTTXM);
       if (wkc > 0) /* succeeded to place mailbox in slave ? */
       {
          if (!NotLast || !ecx_mbxempty(context, slave, timeout))
          {
             /* clean mailboxbuffer */
-            ec_clearmbx(&MbxIn);
+            MbxIn = ecx_mbxin(context, slave);
             /* read slave response */
-            wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, timeout);
+            wkc = ecx_mbxreceive(context, slave, MbxIn, timeout);
             if (wkc > 0) /* succeeded to read slave response ? */
             {
                NotLast = FALSE;
@@ -276,7 +284,7 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
                       (aSoEp->opCode == ECT_SOE_READRES) &&
                       (aSoEp->error == 1))
                   {
-                     mp = (uint8 *)&MbxIn + (etohs(aSoEp->MbxHeader.length) + sizeof(ec_mbxheadert) - sizeof(uint16));
+                     mp = (uint8 *)MbxIn + (etohs(aSoEp->MbxHeader.length) + sizeof(ec_mbxheadert) - sizeof(uint16));
                      errorcode = (uint16 *)mp;
                      ecx_SoEerror(context, slave, idn, *errorcode);
                   }
@@ -297,11 +305,391 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
    return wkc;
 }
 
+/** max. number of SoE requests outstanding per slave in ecx_SoEbatch() */
+#define EC_SOEBATCH_PIPELINE  2
+/** max. number of slaves served at once by ecx_SoEbatch() */
+#define EC_SOEBATCH_SLAVES    (EC_MAXMDATAGRAM / 2)
+/** marker for batch entries that are not finished yet */
+#define EC_SOEBATCH_PENDING   (-100)
+
+/** transfer state of one slave in ecx_SoEbatch() */
+typedef struct
+{
+   uint16  slave;
+   /** next entry to send, -1 = none */
+   int     next;
+   /** bytes of next entry already sent, for fragmented writes */
+   int     sentsize;
+   /** request of next entry is built in slave out mailbox buffer */
+   boolean built;
+   /** data bytes in built request */
+   int     fragsize;
+   /** built request */
+   ec_mbxbuft *mbxout;
+   /** entries sent and not answered yet, oldest first */
+   int     out[EC_SOEBATCH_PIPELINE];
+   int     nout;
+   /** bytes received for oldest entry, for fragmented reads */
+   int     rxsize;
+   /** datagram numbers in current round, -1 = none */
+   int     wr;
+   int     rd;
+   osal_timert timer;
+} ec_SoEbatchslavet;
+
+/* next pending entry of the same slave after entry i, -1 if none */
+static int ecx_SoEbatch_next(ec_SoEbatcht *list, int n, int i)
+{
+   uint16 slave = list[i].slave;
+
+   for (i++; i < n; i++)
+   {
+      if ((list[i].slave == slave) && (list[i].wkc == EC_SOEBATCH_PENDING))
+      {
+         return i;
+      }
+   }
+   return -1;
+}
+
+/* build request, or next fragment of a write, of entry st->next in the slave
+ * out mailbox buffer */
+static void ecx_SoEbatch_build(ecx_contextt *context, ec_SoEbatcht *list, ec_SoEbatchslavet *st)
+{
+   ec_SoEbatcht *e;
+   ec_SoEt *SoEp;
+   int maxdata, left;
+   uint8 cnt;
+
+   e = &list[st->next];
+   st->mbxout = ecx_mbxout(context, st->slave);
+   SoEp = (ec_SoEt *)st->mbxout;
+   SoEp->MbxHeader.address = htoes(0x0000);
+   SoEp->MbxHeader.priority = 0x00;
+   SoEp->error = 0;
+   SoEp->driveNo = e->driveNo;
+   SoEp->elementflags = e->elementflags;
+   SoEp->idn = htoes(e->idn);
+   SoEp->incomplete = 0;
+   st->fragsize = 0;
+   if (!e->write)
+   {
+      SoEp->opCode = ECT_SOE_READREQ;
+   }
+   else
+   {
+      SoEp->opCode = ECT_SOE_WRITEREQ;
+      maxdata = context->slavelist[st->slave].mbx_l - sizeof(ec_SoEt);
+      left = e->psize - st->sentsize;
+      st->fragsize = left;
+      if (left > maxdata)
+      {
+         st->fragsize = maxdata;  /*  segmented transfer needed  */
+         SoEp->incomplete = 1;
+         SoEp->fragmentsleft = htoes((uint16)(left / maxdata));
+      }
+      memcpy((uint8 *)SoEp + sizeof(ec_SoEt), (uint8 *)e->p + st->sentsize, st->fragsize);
+   }
+   SoEp->MbxHeader.length = htoes((uint16)(sizeof(ec_SoEt) - sizeof(ec_mbxheadert) + st->fragsize));
+   /* get new mailbox counter, used for session handle */
+   cnt = ec_nextmbxcnt(context->slavelist[st->slave].mbx_cnt);
+   context->slavelist[st->slave].mbx_cnt = cnt;
+   SoEp->MbxHeader.mbxtype = ECT_MBXT_SOE + MBX_HDR_SET_CNT(cnt); /* SoE */
+   st->built = TRUE;
+}
+
+/* handle response read from slave send mailbox */
+static void ecx_SoEbatch_response(ecx_contextt *context, ec_SoEbatcht *list, int n,
+   ec_SoEbatchslavet *st, ec_mbxbuft *MbxIn)
+{
+   ec_SoEt *aSoEp;
+   ec_SoEbatcht *e;
+   int i, framedatasize;
+   uint16 *errorcode;
+   boolean done;
+
+   aSoEp = (ec_SoEt *)MbxIn;
+   if ((aSoEp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_SOE)
+   {
+      (void)ecx_mbxhandlemsg(context, st->slave, MbxIn);
+      return;
+   }
+   /* oldest request, or write that is aborted by the slave while fragments are sent */
+   if (st->nout > 0)
+   {
+      i = st->out[0];
+   }
+   else if (st->sentsize > 0)
+   {
+      i = st->next;
+   }
+   else
+   {
+      return; /* old response, discard */
+   }
+   e = &list[i];
+   done = FALSE;
+   if (aSoEp->error)
+   {
+      errorcode = (uint16 *)((uint8 *)MbxIn + (etohs(aSoEp->MbxHeader.length) + sizeof(ec_mbxheadert) - sizeof(uint16)));
+      e->error = etohs(*errorcode);
+      ecx_SoEerror(context, st->slave, e->idn, e->error);
+      e->wkc = 0;
+      done = TRUE;
+   }
+   else if ((aSoEp->opCode == (e->write ? ECT_SOE_WRITERES : ECT_SOE_READRES)) &&
+            (aSoEp->driveNo == e->driveNo) &&
+            (aSoEp->elementflags == e->elementflags) &&
+            (aSoEp->incomplete || (etohs(aSoEp->idn) == e->idn)))
+   {
+      if (!e->write)
+      {
+         framedatasize = etohs(aSoEp->MbxHeader.length) - sizeof(ec_SoEt) + sizeof(ec_mbxheadert);
+         /* data that does not fit in parameter buffer is dropped */
+         if (framedatasize > (e->psize - st->rxsize))
+         {
+            framedatasize = e->psize - st->rxsize;
+         }
+         if (framedatasize > 0)
+         {
+            memcpy((uint8 *)e->p + st->rxsize, (uint8 *)MbxIn + sizeof(ec_SoEt), framedatasize);
+            st->rxsize += framedatasize;
+         }
+         if (!aSoEp->incomplete)
+         {
+            e->psize = st->rxsize;
+            e->wkc = 1;
+            done = TRUE;
+         }
+      }
+      else
+      {
+         e->wkc = 1;
+         done = TRUE;
+      }
+   }
+   else
+   {
+      ecx_packeterror(context, st->slave, e->idn, 0, 1); /* Unexpected frame returned */
+   }
+   if (done)
+   {
+      st->rxsize = 0;
+      if (st->nout > 0)
+      {
+         for (i = 1; i < st->nout; i++)
+         {
+            st->out[i - 1] = st->out[i];
+         }
+         st->nout--;
+      }
+      else
+      {
+         st->next = ecx_SoEbatch_next(list, n, st->next);
+         st->sentsize = 0;
+         st->built = FALSE;
+      }
+   }
+}
+
+/* run all entries of the selected slaves to completion */
+static void ecx_SoEbatch_run(ecx_contextt *context, ec_SoEbatcht *list, int n,
+   ec_SoEbatchslavet *st, int m, int timeout)
+{
+   ec_mdatagramt dg[EC_MAXMDATAGRAM];
+   ec_slavet *slavep;
+   ec_SoEbatchslavet *s;
+   ec_mbxbuft *MbxIn;
+   int k, i, nd;
+   boolean flush, progress;
+
+   for (k = 0; k < m; k++)
+   {
+      osal_timer_start(&st[k].timer, timeout);
+   }
+   /* first round also empties slave send mailboxes */
+   flush = TRUE;
+   do
+   {
+      nd = 0;
+      for (k = 0; k < m; k++)
+      {
+         s = &st[k];
+         slavep = &(context->slavelist[s->slave]);
+         s->wr = s->rd = -1;
+         if (!s->built && (s->next >= 0) && (s->nout < EC_SOEBATCH_PIPELINE))
+         {
+            ecx_SoEbatch_build(context, list, s);
+         }
+         if (s->built)
+         {
+            dg[nd].com = EC_CMD_FPWR;
+            dg[nd].ADP = slavep->configadr;
+            dg[nd].ADO = slavep->mbx_wo;
+            dg[nd].length = slavep->mbx_l;
+            dg[nd].data = s->mbxout;
+            s->wr = nd++;
+         }
+         if ((s->nout > 0) || (s->sentsize > 0) || (flush && s->built))
+         {
+            MbxIn = ecx_mbxin(context, s->slave);
+            dg[nd].com = EC_CMD_FPRD;
+            dg[nd].ADP = slavep->configadr;
+            dg[nd].ADO = slavep->mbx_ro;
+            dg[nd].length = slavep->mbx_rl;
+            dg[nd].data = MbxIn;
+            s->rd = nd++;
+         }
+      }
+      if (nd == 0)
+      {
+         break;
+      }
+      (void)ecx_multidatagram(context->port, dg, nd, EC_TIMEOUTRET3);
+      flush = FALSE;
+      progress = FALSE;
+      for (k = 0; k < m; k++)
+      {
+         s = &st[k];
+         /* response to requests sent in earlier rounds */
+         if ((s->rd >= 0) && (dg[s->rd].wkc == 1))
+         {
+            ecx_SoEbatch_response(context, list, n, s, (ec_mbxbuft *)dg[s->rd].data);
+            osal_timer_start(&s->timer, timeout);
+            progress = TRUE;
+         }
+         /* request accepted by slave */
+         if ((s->wr >= 0) && (dg[s->wr].wkc == 1) && s->built)
+         {
+            s->built = FALSE;
+            if (list[s->next].write && ((s->sentsize + s->fragsize) < list[s->next].psize))
+            {
+               s->sentsize += s->fragsize; /* more fragments to send */
+            }
+            else
+            {
+               s->out[s->nout++] = s->next;
+               s->next = ecx_SoEbatch_next(list, n, s->next);
+               s->sentsize = 0;
+            }
+            osal_timer_start(&s->timer, timeout);
+            progress = TRUE;
+         }
+         if (((s->next >= 0) || (s->nout > 0)) && osal_timer_is_expired(&s->timer))
+         {
+            /* slave does not answer, give up on all its entries */
+            for (i = 0; i < s->nout; i++)
+            {
+               list[s->out[i]].wkc = EC_TIMEOUT;
+            }
+            for (i = s->next; i >= 0; i = ecx_SoEbatch_next(list, n, i))
+            {
+               list[i].wkc = 0;
+            }
+            s->nout = 0;
+            s->next = -1;
+            s->sentsize = 0;
+            s->built = FALSE;
+         }
+      }
+      if (!progress)
+      {
+         osal_usleep(EC_LOCALDELAY);
+      }
+   }
+   while (TRUE);
+}
+
+/** SoE transfers to many IDNs and slaves at once, blocking.
+ *
+ * Transfers to different slaves run in parallel and up to EC_SOEBATCH_PIPELINE
+ * requests per slave are outstanding in the mailbox. Each round is one frame,
+ * or as few frames as possible, that writes the next request to the receive
+ * mailbox and reads the send mailbox of every slave, so no SM status polling
+ * is needed. Transfers to the same slave are done in list order. Fragmented
+ * read responses are combined and long writes are sent in fragments, as with
+ * ecx_SoEread() and ecx_SoEwrite().
+ *
+ * @param[in]  context    = context struct
+ * @param[in,out] list    = transfers, wkc, psize of reads and error are set
+ *                          per entry
+ * @param[in]  n          = number of entries in list
+ * @param[in]  timeout    = Timeout in us without progress per slave, standard is EC_TIMEOUTRXM
+ * @return number of successful transfers
+ */
+int ecx_SoEbatch(ecx_contextt *context, ec_SoEbatcht *list, int n, int timeout)
+{
+   ec_SoEbatchslavet st[EC_SOEBATCH_SLAVES];
+   ec_slavet *slavep;
+   int i, k, m, success;
+
+   for (i = 0; i < n; i++)
+   {
+      list[i].error = 0;
+      list[i].wkc = EC_SOEBATCH_PENDING;
+      if ((list[i].slave < 1) || (list[i].slave > *(context->slavecount)) ||
+          (context->mbxpool == NULL))
+      {
+         list[i].wkc = 0;
+         continue;
+      }
+      slavep = &(context->slavelist[list[i].slave]);
+      if (!(slavep->mbx_proto & ECT_MBXPROT_SOE) ||
+          (slavep->mbx_l == 0) || (slavep->mbx_l > EC_MAXMBX) ||
+          (slavep->mbx_rl == 0) || (slavep->mbx_rl > EC_MAXMBX))
+      {
+         list[i].wkc = 0;
+      }
+   }
+   do
+   {
+      /* first pending entry of each slave */
+      m = 0;
+      for (i = 0; (i < n) && (m < EC_SOEBATCH_SLAVES); i++)
+      {
+         if (list[i].wkc != EC_SOEBATCH_PENDING)
+         {
+            continue;
+         }
+         for (k = 0; k < m; k++)
+         {
+            if (st[k].slave == list[i].slave)
+            {
+               break;
+            }
+         }
+         if (k == m)
+         {
+            memset(&st[m], 0, sizeof(st[m]));
+            st[m].slave = list[i].slave;
+            st[m].next = i;
+            m++;
+         }
+      }
+      if (m > 0)
+      {
+         ecx_SoEbatch_run(context, list, n, st, m, timeout);
+      }
+   }
+   while (m > 0);
+
+   success = 0;
+   for (i = 0; i < n; i++)
+   {
+      if (list[i].wkc > 0)
+      {
+         success++;
+      }
+   }
+   return success;
+}
+
 /** SoE read AT and MTD mapping.
  *
  * SoE has standard indexes defined for mapping. This function
  * tries to read them and collect a full input and output mapping size
- * of designated slave.
+ * of designated slave. The mapping lists of all drives and then the
+ * attributes of the mapped IDNs of each drive are read with ecx_SoEbatch().
  *
  * @param[in]  context = context struct
  * @param[in]  slave   = Slave number
@@ -312,53 +700,70 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
 int ecx_readIDNmap(ecx_contextt *context, uint16 slave, uint32 *Osize, uint32 *Isize)
 {
    int retVal = 0;
-   int   wkc;
-   int psize;
+   int na, i;
    uint8 driveNr;
    uint16 entries, itemcount;
-   ec_SoEmappingt     SoEmapping;
-   ec_SoEattributet   SoEattribute;
+   uint8 input[2 * EC_SOE_MAXMAPPING];
+   ec_SoEbatcht       map[2 * EC_SOE_MAX_DRIVES];
+   ec_SoEbatcht       attr[2 * EC_SOE_MAXMAPPING];
+   ec_SoEmappingt     SoEmapping[2 * EC_SOE_MAX_DRIVES];
+   ec_SoEattributet   SoEattribute[2 * EC_SOE_MAXMAPPING];
 
    *Isize = 0;
    *Osize = 0;
+   memset(map, 0, sizeof(map));
+   for(driveNr = 0; driveNr < EC_SOE_MAX_DRIVES; driveNr++)
+   {
+      /* output mapping (MDT) and input mapping (AT) */
+      for (i = 0; i < 2; i++)
+      {
+         map[2 * driveNr + i].slave = slave;
+         map[2 * driveNr + i].driveNo = driveNr;
+         map[2 * driveNr + i].elementflags = EC_SOE_VALUE_B;
+         map[2 * driveNr + i].idn = i ? EC_IDN_ATCONFIG : EC_IDN_MDTCONFIG;
+         map[2 * driveNr + i].psize = sizeof(SoEmapping[0]);
+         map[2 * driveNr + i].p = &SoEmapping[2 * driveNr + i];
+      }
+   }
+   /* read mapping via SoE */
+   (void)ecx_SoEbatch(context, map, 2 * EC_SOE_MAX_DRIVES, EC_TIMEOUTRXM);
    for(driveNr = 0; driveNr < EC_SOE_MAX_DRIVES; driveNr++)
    {
-      psize = sizeof(SoEmapping);
-      /* read output mapping via SoE */
-      wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_VALUE_B, EC_IDN_MDTCONFIG, &psize, &SoEmapping, EC_TIMEOUTRXM);
-      if ((wkc > 0) && (psize >= 4) && ((entries = etohs(SoEmapping.currentlength) / 2) > 0) && (entries <= EC_SOE_MAXMAPPING))
+      na = 0;
+      memset(attr, 0, sizeof(attr));
+      for (i = 0; i < 2; i++)
       {
-         /* command word (uint16) is always mapped but not in list */
-         *Osize += 16;
-         for (itemcount = 0 ; itemcount < entries ; itemcount++)
+         if ((map[2 * driveNr + i].wkc > 0) && (map[2 * driveNr + i].psize >= 4) &&
+             ((entries = etohs(SoEmapping[2 * driveNr + i].currentlength) / 2) > 0) &&
+             (entries <= EC_SOE_MAXMAPPING))
          {
-            psize = sizeof(SoEattribute);
-            /* read attribute of each IDN in mapping list */
-            wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_ATTRIBUTE_B, SoEmapping.idn[itemcount], &psize, &SoEattribute, EC_TIMEOUTRXM);
-            if ((wkc > 0) && (!SoEattribute.list))
+            /* command word and status word (uint16) are always mapped but not in list */
+            *(i ? Isize : Osize) += 16;
+            for (itemcount = 0 ; itemcount < entries ; itemcount++)
             {
-               /* length : 0 = 8bit, 1 = 16bit .... */
-               *Osize += (int)8 << SoEattribute.length;
+               attr[na].slave = slave;
+               attr[na].driveNo = driveNr;
+               attr[na].elementflags = EC_SOE_ATTRIBUTE_B;
+               attr[na].idn = SoEmapping[2 * driveNr + i].idn[itemcount];
+               attr[na].psize = sizeof(SoEattribute[0]);
+               attr[na].p = &SoEattribute[na];
+               input[na] = (uint8)i;
+               na++;
             }
          }
       }
-      psize = sizeof(SoEmapping);
-      /* read input mapping via SoE */
-      wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_VALUE_B, EC_IDN_ATCONFIG, &psize, &SoEmapping, EC_TIMEOUTRXM);
-      if ((wkc > 0) && (psize >= 4) && ((entries = etohs(SoEmapping.currentlength) / 2) > 0) && (entries <= EC_SOE_MAXMAPPING))
+      if (na == 0)
       {
-         /* status word (uint16) is always mapped but not in list */
-         *Isize += 16;
-         for (itemcount = 0 ; itemcount < entries ; itemcount++)
+         continue;
+      }
+      /* read attribute of each IDN in mapping lists */
+      (void)ecx_SoEbatch(context, attr, na, EC_TIMEOUTRXM);
+      for (i = 0; i < na; i++)
+      {
+         if ((attr[i].wkc > 0) && (!SoEattribute[i].list))
          {
-            psize = sizeof(SoEattribute);
-            /* read attribute of each IDN in mapping list */
-            wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_ATTRIBUTE_B, SoEmapping.idn[itemcount], &psize, &SoEattribute, EC_TIMEOUTRXM);
-            if ((wkc > 0) && (!SoEattribute.list))
-            {
-               /* length : 0 = 8bit, 1 = 16bit .... */
-               *Isize += (int)8 << SoEattribute.length;
-            }
+            /* length : 0 = 8bit, 1 = 16bit .... */
+            *(input[i] ? Isize : Osize) += (int)8 << SoEattribute[i].length;
          }
       }
    }
@@ -386,4 +791,9 @@ int ec_readIDNmap(uint16 slave, uint32 *Osize, uint32 *Isize)
 {
    return ecx_readIDNmap(&ecx_context, slave, Osize, Isize);
 }
+
+int ec_SoEbatch(ec_SoEbatcht *list, int n, int timeout)
+{
+   return ecx_SoEbatch(&ecx_context, list, n, timeout);
+}
 #endif
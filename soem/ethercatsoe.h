@@ -113,15 +113,40 @@ typedef struct PACKED
 } ec_SoEattributet;
 PACKED_END
 
+/** one transfer of ecx_SoEbatch() */
+typedef struct
+{
+   /** slave number */
+   uint16  slave;
+   /** drive number in slave */
+   uint8   driveNo;
+   /** flags to select what properties of IDN are to be transferred */
+   uint8   elementflags;
+   /** IDN to read or write */
+   uint16  idn;
+   /** FALSE = read, TRUE = write */
+   boolean write;
+   /** size in bytes of parameter buffer, returns bytes read */
+   int     psize;
+   /** parameter buffer */
+   void    *p;
+   /** result, >0 success, 0 error, EC_TIMEOUT */
+   int     wkc;
+   /** SoE error code if slave answered with error */
+   uint16  error;
+} ec_SoEbatcht;
+
 #ifdef EC_VER1
 int ec_SoEread(uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int *psize, void *p, int timeout);
 int ec_SoEwrite(uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int psize, void *p, int timeout);
 int ec_readIDNmap(uint16 slave, uint32 *Osize, uint32 *Isize);
+int ec_SoEbatch(ec_SoEbatcht *list, int n, int timeout);
 #endif
 
 int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int *psize, void *p, int timeout);
 int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int psize, void *p, int timeout);
 int ecx_readIDNmap(ecx_contextt *context, uint16 slave, uint32 *Osize, uint32 *Isize);
+int ecx_SoEbatch(ecx_contextt *context, ec_SoEbatcht *list, int n, int timeout);
 
 #ifdef __cplusplus
 }
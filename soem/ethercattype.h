@@ -479,6 +479,8 @@ typedef struct
 {
    /** Time at which the error was generated. */
    ec_timet Time;
+   /** Monotonic time in ns at which the error was queued, see osal_monotonic_ns() */
+   uint64      Timestamp;
    /** Signal bit, error set but not read */
    boolean     Signal;
    /** Slave number that generated the error */
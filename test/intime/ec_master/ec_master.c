@@ -84,6 +84,9 @@ static ec_eepromSMt ec_SM2;
 /** buffer for EEPROM FMMU data */
 static ec_eepromFMMUt ec_FMMU;
 static ec_eepromFMMUt ec_FMMU2;
+/** mailbox buffers, one per slave */
+static ec_mbxpoolt    ec_mbxpool[EC_MAXSLAVE];
+static ec_mbxpoolt    ec_mbxpool2[EC_MAXSLAVE];
 
 /** Global variable TRUE if error available in error stack */
 static boolean    EcatError = FALSE;
@@ -110,14 +113,23 @@ static ecx_contextt ctx [] = {
    &ec_elist,
    &ec_idxstack,
    &EcatError,
-   0,
-   0,
    &ec_DCtime,
    &ec_SMcommtype,
    &ec_PDOassign,
    &ec_PDOdesc,
    &ec_SM,
-   &ec_FMMU
+   &ec_FMMU,
+   NULL,
+   NULL,
+   0,
+   NULL,
+   1,
+   NULL,
+   NULL,
+   &ec_mbxpool[0],
+   NULL,
+   NULL,
+   NULL
    },
    {
    &ecx_port2,
@@ -132,14 +144,23 @@ static ecx_contextt ctx [] = {
    &ec_elist2,
    &ec_idxstack2,
    &EcatError2,
-   0,
-   0,
    &ec_DCtime2,
    &ec_SMcommtype2,
    &ec_PDOassign2,
    &ec_PDOdesc2,
    &ec_SM2,
-   &ec_FMMU2
+   &ec_FMMU2,
+   NULL,
+   NULL,
+   0,
+   NULL,
+   1,
+   NULL,
+   NULL,
+   &ec_mbxpool2[0],
+   NULL,
+   NULL,
+   NULL
    }
 };
 
@@ -0,0 +1,214 @@
+/** \file
+ * \brief Example code for Simple Open EtherCAT master EoE gateway
+ *
+ * Creates a Linux TAP interface eoe<slave> for every EoE capable slave and
+ * bridges Ethernet frames between the TAP interfaces and the slaves. The
+ * frames are carried by the EoE gateway in the process data frames, the
+ * cyclic exchange is not stalled by EoE traffic. The slaves must have process
+ * data, EoE mailbox datagrams are only added to process data frames.
+ *
+ * Configure the TAP interfaces with ip/ifconfig after start, f.e.
+ * ip addr add 192.168.9.1/24 dev eoe1 && ip link set eoe1 up
+ *
+ * Usage : eoe_bridge ifname1 [cycletime_us]
+ * ifname is NIC interface, f.e. eth0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+#include "ethercat.h"
+
+char IOmap[4096];
+ec_EOEgwt eoegw;
+int tapfd[EC_MAXSLAVE];
+/** frame read from TAP that did not fit in the gateway queue yet */
+int pendingsize[EC_MAXSLAVE];
+uint8 pending[EC_MAXEOEGW][EC_EOEMAXFRAME];
+volatile sig_atomic_t run = 1;
+
+void stop(int sig)
+{
+   (void)sig;
+   run = 0;
+}
+
+int tap_open(uint16 slave)
+{
+   struct ifreq ifr;
+   int fd;
+
+   fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+   if (fd < 0)
+   {
+      return -1;
+   }
+   memset(&ifr, 0, sizeof(ifr));
+   ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+   snprintf(ifr.ifr_name, IFNAMSIZ, "eoe%d", slave);
+   if (ioctl(fd, TUNSETIFF, &ifr) < 0)
+   {
+      close(fd);
+      return -1;
+   }
+   printf("Slave %d bridged to %s\n", slave, ifr.ifr_name);
+   return fd;
+}
+
+/* move frames from TAP interfaces to gateway queues and back */
+void bridge(void)
+{
+   ec_EOEframet *rxframe;
+   uint16 slave;
+   int i;
+   ssize_t n;
+
+   for (i = 0; i < eoegw.slaves; i++)
+   {
+      slave = eoegw.slave[i].slave;
+      if (tapfd[slave] < 0)
+      {
+         continue;
+      }
+      while (1)
+      {
+         if (!pendingsize[slave])
+         {
+            n = read(tapfd[slave], pending[i], EC_EOEMAXFRAME);
+            if (n <= 0)
+            {
+               break;
+            }
+            pendingsize[slave] = (int)n;
+         }
+         if (ecx_EOEgw_send(&ecx_context, slave, 0, pendingsize[slave], pending[i]) == 0)
+         {
+            break; /* queue full, try again next cycle */
+         }
+         pendingsize[slave] = 0;
+      }
+   }
+   /* frames are written to TAP directly from the gateway queue */
+   while ((rxframe = ecx_EOEgw_peek(&ecx_context, &slave)) != NULL)
+   {
+      if (tapfd[slave] >= 0)
+      {
+         if (write(tapfd[slave], rxframe->data, rxframe->size) < 0)
+         {
+            printf("Slave %d: write to TAP failed, %s\n", slave, strerror(errno));
+         }
+      }
+      ecx_EOEgw_release(&ecx_context, slave);
+   }
+}
+
+void eoebridge(char *ifname, int cycletime)
+{
+   int i, wkc, expectedWKC;
+   uint16 slave;
+
+   printf("Starting EoE bridge\n");
+
+   /* initialise SOEM, bind socket to ifname */
+   if (ec_init(ifname))
+   {
+      printf("ec_init on %s succeeded.\n", ifname);
+      if (ec_config_init(FALSE) > 0)
+      {
+         printf("%d slaves found and configured.\n", ec_slavecount);
+         ec_config_map(&IOmap);
+         ec_configdc();
+         ec_statecheck(0, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE * 4);
+         expectedWKC = (ec_group[0].outputsWKC * 2) + ec_group[0].inputsWKC;
+         if (expectedWKC == 0)
+         {
+            printf("No process data, EoE gateway can not run.\n");
+         }
+         else if (ecx_EOEgw_init(&ecx_context, &eoegw) == 0)
+         {
+            printf("No EoE capable slaves found.\n");
+         }
+         else
+         {
+            for (slave = 0; slave < EC_MAXSLAVE; slave++)
+            {
+               tapfd[slave] = -1;
+            }
+            for (i = 0; i < eoegw.slaves; i++)
+            {
+               slave = eoegw.slave[i].slave;
+               tapfd[slave] = tap_open(slave);
+               if (tapfd[slave] < 0)
+               {
+                  printf("Slave %d: no TAP interface, %s\n", slave, strerror(errno));
+               }
+            }
+            ec_slave[0].state = EC_STATE_OPERATIONAL;
+            ec_send_processdata();
+            ec_receive_processdata(EC_TIMEOUTRET);
+            ec_writestate(0);
+            signal(SIGINT, stop);
+            while (run)
+            {
+               ec_send_processdata();
+               wkc = ec_receive_processdata(EC_TIMEOUTRET);
+               if (wkc < expectedWKC)
+               {
+                  ec_readstate();
+               }
+               bridge();
+               osal_usleep(cycletime);
+            }
+            for (i = 0; i < eoegw.slaves; i++)
+            {
+               slave = eoegw.slave[i].slave;
+               printf("Slave %d: %u frames sent, %u received, %u dropped\n", slave,
+                  eoegw.slave[i].txframes, eoegw.slave[i].rxframes, eoegw.slave[i].rxdropped);
+               if (tapfd[slave] >= 0)
+               {
+                  close(tapfd[slave]);
+               }
+            }
+            ecx_EOEgw_init(&ecx_context, NULL);
+         }
+         ec_slave[0].state = EC_STATE_INIT;
+         ec_writestate(0);
+      }
+      else
+      {
+         printf("No slaves found!\n");
+      }
+      printf("End EoE bridge, close socket\n");
+      /* stop SOEM, close socket */
+      ec_close();
+   }
+   else
+   {
+      printf("No socket connection on %s\nExecute as root\n", ifname);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   printf("SOEM (Simple Open EtherCAT Master)\nEoE bridge\n");
+
+   if (argc > 1)
+   {
+      eoebridge(argv[1], (argc > 2) ? atoi(argv[2]) : 1000);
+   }
+   else
+   {
+      printf("Usage: eoe_bridge ifname1 [cycletime_us]\nifname = eth0 for example\n");
+   }
+
+   printf("End program\n");
+   return (0);
+}
@@ -20,31 +20,23 @@
 
 #include "ethercat.h"
 
-#define FWBUFSIZE (8 * 1024 * 1024)
-
 uint8 ob;
 uint16 ow;
 uint32 data;
 char filename[256];
-char filebuffer[FWBUFSIZE]; // 8MB buffer
-int filesize;
 int j;
 uint16 argslave;
 
-int input_bin(char *fname, int *length)
+/* FoE stream callback, firmware is read from file while it is sent */
+int input_bin(ecx_contextt *context, uint16 slave, void *userdata, uint8 *p, int size)
 {
-    FILE *fp;
-
-	int cc = 0, c;
-
-    fp = fopen(fname, "rb");
-    if(fp == NULL)
-        return 0;
-	while (((c = fgetc(fp)) != EOF) && (cc < FWBUFSIZE))
-		filebuffer[cc++] = (uint8)c;
-	*length = cc;
-	fclose(fp);
-	return 1;
+	FILE *fp = (FILE *)userdata;
+
+	(void)context;
+	(void)slave;
+	if (ferror(fp))
+		return -1;
+	return (int)fread(p, 1, size, fp);
 }
 
 
@@ -110,11 +102,13 @@ void boottest(char *ifname, uint16 slave, char *filename)
 			{
 				printf("Slave %d state to BOOT.\n", slave);
 
-				if (input_bin(filename, &filesize))
+				FILE *fp = fopen(filename, "rb");
+				if (fp != NULL)
 				{
-					printf("File read OK, %d bytes.\n",filesize);
+					printf("File open OK.\n");
 					printf("FoE write....");
-					j = ec_FOEwrite(slave, filename, 0, filesize , &filebuffer, EC_TIMEOUTSTATE);
+					j = ec_FOEwrite_stream(slave, filename, 0, input_bin, fp, EC_TIMEOUTSTATE);
+					fclose(fp);
 					printf("result %d.\n",j);
 					printf("Request init state for slave %d\n", slave);
 					ec_slave[slave].state = EC_STATE_INIT;
@@ -0,0 +1,177 @@
+/** \file
+ * \brief Example code for Simple Open EtherCAT master
+ *
+ * Usage: foe_update ifname1 fname slave [slave ...]
+ * ifname is NIC interface, f.e. eth0
+ * fname = binary file to store in the slaves
+ * slave = slave number in EtherCAT order 1..n or a range like 1-60
+ * CAUTION! Using the wrong file can result in bricked slaves!
+ *
+ * This is a parallel slave firmware update test. All given slaves are
+ * updated at the same time with the same file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethercat.h"
+
+#define MAXUPDATE 200
+
+ec_FOEupdatet update[MAXUPDATE];
+FILE *files[MAXUPDATE];
+int32 progress[EC_MAXSLAVE];
+int nupdate;
+
+/* FoE stream callback, every slave reads its own handle of the file */
+int input_bin(ecx_contextt *context, uint16 slave, void *userdata, uint8 *p, int size)
+{
+   FILE *fp = (FILE *)userdata;
+
+   (void)context;
+   (void)slave;
+   if (ferror(fp))
+      return -1;
+   return (int)fread(p, 1, size, fp);
+}
+
+/* FoE progress hook, prints a line every 64 kB per slave */
+int foe_progress(uint16 slave, int packetnumber, int datasize)
+{
+   (void)packetnumber;
+   if ((slave < EC_MAXSLAVE) && ((datasize - progress[slave]) >= 65536))
+   {
+      progress[slave] = datasize;
+      printf("Slave %d: %d bytes\n", slave, datasize);
+   }
+   return 0;
+}
+
+int add_slaves(char *arg)
+{
+   int first, last, slave, i;
+   char *dash;
+
+   first = atoi(arg);
+   dash = strchr(arg, '-');
+   last = dash ? atoi(dash + 1) : first;
+   for (slave = first; slave <= last; slave++)
+   {
+      /* both transfers would use the same mailbox buffers of the slave */
+      for (i = 0; i < nupdate; i++)
+      {
+         if (update[i].slave == slave)
+         {
+            printf("Slave %d given more than once\n", slave);
+            return 0;
+         }
+      }
+      if (nupdate >= MAXUPDATE)
+      {
+         printf("Too many slaves, maximum is %d\n", MAXUPDATE);
+         return 0;
+      }
+      update[nupdate++].slave = (uint16)slave;
+   }
+   return 1;
+}
+
+void foeupdate(char *ifname, char *filename)
+{
+   int i, ok;
+
+   printf("Starting parallel firmware update\n");
+
+   /* initialise SOEM, bind socket to ifname */
+   if (ec_init(ifname))
+   {
+      printf("ec_init on %s succeeded.\n", ifname);
+      /* find and auto-config slaves */
+      if (ec_config_init(FALSE) > 0)
+      {
+         printf("%d slaves found and configured.\n", ec_slavecount);
+
+         /* wait for all slaves to reach PRE_OP state */
+         ec_statecheck(0, EC_STATE_PRE_OP, EC_TIMEOUTSTATE * 4);
+
+         ok = 1;
+         for (i = 0; i < nupdate; i++)
+         {
+            if ((update[i].slave < 1) || (update[i].slave > ec_slavecount))
+            {
+               printf("Slave %d does not exist.\n", update[i].slave);
+               ok = 0;
+               break;
+            }
+            files[i] = fopen(filename, "rb");
+            if (files[i] == NULL)
+            {
+               printf("File %s not read OK.\n", filename);
+               ok = 0;
+               break;
+            }
+            update[i].stream = input_bin;
+            update[i].userdata = files[i];
+         }
+         if (ok)
+         {
+            ec_FOEdefinehook(foe_progress);
+            printf("FoE write to %d slaves....\n", nupdate);
+            ok = ec_FOEupdate(update, nupdate, filename, 0, EC_TIMEOUTSTATE * 10);
+            for (i = 0; i < nupdate; i++)
+            {
+               printf("Slave %d: result %d, %d bytes.\n", update[i].slave,
+                  update[i].wkc, update[i].datasent);
+            }
+            printf("%d of %d slaves updated.\n", ok, nupdate);
+         }
+         for (i = 0; i < nupdate; i++)
+         {
+            if (files[i])
+               fclose(files[i]);
+         }
+      }
+      else
+      {
+         printf("No slaves found!\n");
+      }
+      printf("End firmware update, close socket\n");
+      /* stop SOEM, close socket */
+      ec_close();
+   }
+   else
+   {
+      printf("No socket connection on %s\nExecute as root\n", ifname);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+
+   printf("SOEM (Simple Open EtherCAT Master)\nParallel firmware update\n");
+
+   if (argc > 3)
+   {
+      for (i = 3; i < argc; i++)
+      {
+         if (!add_slaves(argv[i]))
+         {
+            return 1;
+         }
+      }
+      foeupdate(argv[1], argv[2]);
+   }
+   else
+   {
+      printf("Usage: foe_update ifname1 fname slave [slave ...]\n");
+      printf("ifname = eth0 for example\n");
+      printf("fname = binary file to store in the slaves\n");
+      printf("slave = slave number in EtherCAT order 1..n or a range like 1-60\n");
+      printf("CAUTION! Using the wrong file can result in bricked slaves!\n");
+   }
+
+   printf("End program\n");
+   return (0);
+}
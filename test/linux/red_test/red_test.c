@@ -24,8 +24,8 @@
 
 #include "ethercat.h"
 
-#define NSEC_PER_SEC 1000000000
 #define EC_TIMEOUTMON 500
+#define stack64k (64 * 1024)
 
 struct sched_param schedp;
 char IOmap[4096];
@@ -33,7 +33,9 @@ pthread_t thread1, thread2;
 struct timeval tv, t1, t2;
 int dorun = 0;
 int deltat, tmax = 0;
-int64 toff, gl_delta;
+ec_dcschedt dcsched;
+int cycletime_us;
+int rtcpu = -1;
 int DCdiff;
 int os;
 uint8 ob;
@@ -46,9 +48,35 @@ boolean inOP;
 uint8 currentgroup = 0;
 
 
+/* cyclic hook before process data is sent */
+void ecatpre(ecx_contextt *context, ec_dcschedt *sched)
+{
+   (void)context;
+   (void)sched;
+   dorun++;
+   /* if we have some digital output, cycle */
+   if( digout ) *digout = (uint8) ((dorun / 16) & 0xff);
+}
+
+/* cyclic hook after process data is received */
+void ecatpost(ecx_contextt *context, ec_dcschedt *sched)
+{
+   (void)context;
+   wkc = sched->wkc;
+}
+
+/* RT EtherCAT thread, process data cycle synced to DC time */
+OSAL_THREAD_FUNC_RT ecatthread(void *ptr)
+{
+   (void)ptr;
+   ec_dcsched_run(&dcsched);
+}
+
 void redtest(char *ifname, char *ifname2)
 {
    int cnt, i, j, oloop, iloop;
+   osal_thread_attrt rtattr;
+   ec_cycleplant plan;
 
    printf("Starting Redundant test\n");
 
@@ -67,6 +95,16 @@ void redtest(char *ifname, char *ifname2)
 
          /* configure DC options for every DC capable slave found in the list */
          ec_configdc();
+         /* compensate static drift of slave clocks before process data starts */
+         ec_dcdriftcomp(250, 100, NULL);
+         /* check if the cycle time fits the mapped process data */
+         ec_cycleplan_init(&plan);
+         if (!ec_cycleplan((int64)cycletime_us * 1000, &plan))
+         {
+            printf("Warning: cycle time too short, ");
+         }
+         printf("min. cycle %dus, margin %dus, %d frames\n",
+               (int)(plan.mincycle / 1000), (int)(plan.margin / 1000), plan.group[0].frames);
 
          /* read indevidual slave state and store in ec_slave[] */
          ec_readstate();
@@ -86,12 +124,34 @@ void redtest(char *ifname, char *ifname2)
          expectedWKC = (ec_group[0].outputsWKC * 2) + ec_group[0].inputsWKC;
          printf("Calculated workcounter %d\n", expectedWKC);
 
+         /* activate cyclic process data, frame passes DC reference 50us after
+          * DC cycle start, just as example */
+         ec_dcsched_init(&dcsched, (int64)cycletime_us * 1000, 50000);
+         dcsched.pre = ecatpre;
+         dcsched.post = ecatpost;
+         dorun = 1;
+         if (!ec_lockmemory(IOmap, sizeof(IOmap)))
+         {
+            printf("Master memory could not be locked\n");
+         }
+         /* pinned, locked and prefaulted so the first cycles do not page fault */
+         osal_thread_attr_init(&rtattr, stack64k * 2);
+         rtattr.lockmemory = TRUE;
+         rtattr.prefault = stack64k;
+         if (rtcpu >= 0)
+         {
+            rtattr.cpuset = 1ULL << rtcpu;
+         }
+         if (!osal_thread_create_rt_attr(&thread1, &rtattr, &ecatthread, NULL))
+         {
+            printf("No real-time scheduling, cyclic thread runs as normal thread\n");
+            osal_thread_create(&thread1, stack64k * 2, &ecatthread, NULL);
+         }
+
          printf("Request operational state for all slaves\n");
          ec_slave[0].state = EC_STATE_OPERATIONAL;
          /* request OP state for all slaves */
          ec_writestate(0);
-         /* activate cyclic process data */
-         dorun = 1;
          /* wait for all slaves to reach OP state */
          ec_statecheck(0, EC_STATE_OPERATIONAL,  5 * EC_TIMEOUTSTATE);
          oloop = ec_slave[0].Obytes;
@@ -107,8 +167,8 @@ void redtest(char *ifname, char *ifname2)
             /* acyclic loop 5000 x 20ms = 10s */
             for(i = 1; i <= 5000; i++)
             {
-               printf("Processdata cycle %5d , Wck %3d, DCtime %12"PRId64", dt %12"PRId64", O:",
-                  dorun, wkc , ec_DCtime, gl_delta);
+               printf("Processdata cycle %5d , Wck %3d, DCtime %12"PRId64", dt %12"PRId64"%s, O:",
+                  dorun, wkc , ec_DCtime, dcsched.delta, dcsched.locked ? " locked" : "");
                for(j = 0 ; j < oloop; j++)
                {
                   printf(" %2.2x", *(ec_slave[0].outputs + j));
@@ -122,7 +182,6 @@ void redtest(char *ifname, char *ifname2)
                fflush(stdout);
                osal_usleep(20000);
             }
-            dorun = 0;
             inOP = FALSE;
          }
          else
@@ -142,6 +201,10 @@ void redtest(char *ifname, char *ifname2)
          ec_slave[0].state = EC_STATE_SAFE_OP;
          /* request SAFE_OP state for all slaves */
          ec_writestate(0);
+         /* stop cyclic process data */
+         dcsched.run = FALSE;
+         osal_thread_join(&thread1);
+         dorun = 0;
       }
       else
       {
@@ -157,79 +220,6 @@ void redtest(char *ifname, char *ifname2)
    }
 }
 
-/* add ns to timespec */
-void add_timespec(struct timespec *ts, int64 addtime)
-{
-   int64 sec, nsec;
-
-   nsec = addtime % NSEC_PER_SEC;
-   sec = (addtime - nsec) / NSEC_PER_SEC;
-   ts->tv_sec += sec;
-   ts->tv_nsec += nsec;
-   if ( ts->tv_nsec >= NSEC_PER_SEC )
-   {
-      nsec = ts->tv_nsec % NSEC_PER_SEC;
-      ts->tv_sec += (ts->tv_nsec - nsec) / NSEC_PER_SEC;
-      ts->tv_nsec = nsec;
-   }
-}
-
-/* PI calculation to get linux time synced to DC time */
-void ec_sync(int64 reftime, int64 cycletime , int64 *offsettime)
-{
-   static int64 integral = 0;
-   int64 delta;
-   /* set linux sync point 50us later than DC sync, just as example */
-   delta = (reftime - 50000) % cycletime;
-   if(delta> (cycletime / 2)) { delta= delta - cycletime; }
-   if(delta>0){ integral++; }
-   if(delta<0){ integral--; }
-   *offsettime = -(delta / 100) - (integral / 20);
-   gl_delta = delta;
-}
-
-/* RT EtherCAT thread */
-OSAL_THREAD_FUNC_RT ecatthread(void *ptr)
-{
-   struct timespec   ts, tleft;
-   int ht;
-   int64 cycletime;
-
-   clock_gettime(CLOCK_MONOTONIC, &ts);
-   ht = (ts.tv_nsec / 1000000) + 1; /* round to nearest ms */
-   ts.tv_nsec = ht * 1000000;
-   if (ts.tv_nsec >= NSEC_PER_SEC) {
-      ts.tv_sec++;
-      ts.tv_nsec -= NSEC_PER_SEC;
-   }
-   cycletime = *(int*)ptr * 1000; /* cycletime in ns */
-   toff = 0;
-   dorun = 0;
-   ec_send_processdata();
-   while(1)
-   {
-      /* calculate next cycle start */
-      add_timespec(&ts, cycletime + toff);
-      /* wait to cycle start */
-      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, &tleft);
-      if (dorun>0)
-      {
-         wkc = ec_receive_processdata(EC_TIMEOUTRET);
-
-         dorun++;
-         /* if we have some digital output, cycle */
-         if( digout ) *digout = (uint8) ((dorun / 16) & 0xff);
-
-         if (ec_slave[0].hasdc)
-         {
-            /* calulate toff to get linux time and DC synced */
-            ec_sync(ec_DCtime, cycletime, &toff);
-         }
-         ec_send_processdata();
-      }
-   }
-}
-
 OSAL_THREAD_FUNC ecatcheck( void *ptr )
 {
     int slave;
@@ -308,21 +298,18 @@ OSAL_THREAD_FUNC ecatcheck( void *ptr )
     }
 }
 
-#define stack64k (64 * 1024)
-
 int main(int argc, char *argv[])
 {
-   int ctime;
-
    printf("SOEM (Simple Open EtherCAT Master)\nRedundancy test\n");
 
    if (argc > 3)
    {
       dorun = 0;
-      ctime = atoi(argv[3]);
-
-      /* create RT thread */
-      osal_thread_create_rt(&thread1, stack64k * 2, &ecatthread, (void*) &ctime);
+      cycletime_us = atoi(argv[3]);
+      if (argc > 4)
+      {
+         rtcpu = atoi(argv[4]);
+      }
 
       /* create thread to handle slave error handling in OP */
       osal_thread_create(&thread2, stack64k * 4, &ecatcheck, NULL);
@@ -332,7 +319,7 @@ int main(int argc, char *argv[])
    }
    else
    {
-      printf("Usage: red_test ifname1 ifname2 cycletime\nifname = eth0 for example\ncycletime in us\n");
+      printf("Usage: red_test ifname1 ifname2 cycletime [cpu]\nifname = eth0 for example\ncycletime in us\ncpu = CPU for the cyclic thread\n");
    }
 
    printf("End program\n");
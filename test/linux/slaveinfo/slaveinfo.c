@@ -20,6 +20,8 @@
 char IOmap[4096];
 ec_ODlistt ODlist;
 ec_OElistt OElist;
+ec_ODcachet ODcache;
+char *ODcachefile = NULL;
 boolean printSDO = FALSE;
 boolean printMAP = FALSE;
 char usdo[128];
@@ -524,7 +526,7 @@ void si_sdo(int cnt)
 
     ODlist.Entries = 0;
     memset(&ODlist, 0, sizeof(ODlist));
-    if( ec_readODlist(cnt, &ODlist))
+    if( ec_readODlist_cached(&ODcache, cnt, &ODlist))
     {
         printf(" CoE Object Description found, %d entries.\n",ODlist.Entries);
         for( i = 0 ; i < ODlist.Entries ; i++)
@@ -532,7 +534,6 @@ void si_sdo(int cnt)
             uint8_t max_sub;
             char name[128] = { 0 };
 
-            ec_readODdescription(i, &ODlist);
             while(EcatError) printf(" - %s\n", ec_elist2string());
             snprintf(name, sizeof(name) - 1, "\"%s\"", ODlist.Name[i]);
             if (ODlist.ObjectCode[i] == OTYPE_VAR)
@@ -547,7 +548,7 @@ void si_sdo(int cnt)
                        ODlist.MaxSub[i], ODlist.MaxSub[i]);
             }
             memset(&OElist, 0, sizeof(OElist));
-            ec_readOE(i, &ODlist, &OElist);
+            ec_readOE_cached(&ODcache, i, &ODlist, &OElist);
             while(EcatError) printf("- %s\n", ec_elist2string());
 
             if(ODlist.ObjectCode[i] != OTYPE_VAR)
@@ -696,6 +697,39 @@ void slaveinfo(char *ifname)
 
 char ifbuf[1024];
 
+/* object dictionary cache file, only used if it matches this build */
+void ODcache_load(void)
+{
+   FILE *f;
+
+   ec_ODcache_init(&ODcache);
+   f = fopen(ODcachefile, "rb");
+   if (f == NULL)
+   {
+      return;
+   }
+   if ((fread(&ODcache, sizeof(ODcache), 1, f) != 1) || !ec_ODcache_check(&ODcache))
+   {
+      printf("Ignoring %s, it does not match this build\n", ODcachefile);
+      ec_ODcache_init(&ODcache);
+   }
+   fclose(f);
+}
+
+void ODcache_save(void)
+{
+   FILE *f;
+
+   f = fopen(ODcachefile, "wb");
+   if (f == NULL)
+   {
+      printf("Cannot write %s\n", ODcachefile);
+      return;
+   }
+   fwrite(&ODcache, sizeof(ODcache), 1, f);
+   fclose(f);
+}
+
 int main(int argc, char *argv[])
 {
    ec_adaptert * adapter = NULL;
@@ -705,13 +739,16 @@ int main(int argc, char *argv[])
    {
       if ((argc > 2) && (strncmp(argv[2], "-sdo", sizeof("-sdo")) == 0)) printSDO = TRUE;
       if ((argc > 2) && (strncmp(argv[2], "-map", sizeof("-map")) == 0)) printMAP = TRUE;
+      if (printSDO && (argc > 3)) ODcachefile = argv[3];
+      if (ODcachefile) ODcache_load();
       /* start slaveinfo */
       strcpy(ifbuf, argv[1]);
       slaveinfo(ifbuf);
+      if (ODcachefile) ODcache_save();
    }
    else
    {
-      printf("Usage: slaveinfo ifname [options]\nifname = eth0 for example\nOptions :\n -sdo : print SDO info\n -map : print mapping\n");
+      printf("Usage: slaveinfo ifname [options]\nifname = eth0 for example\nOptions :\n -sdo [file] : print SDO info, object dictionaries are cached in file\n -map : print mapping\n");
 
       printf ("Available adapters\n");
       adapter = ec_find_adapters ();
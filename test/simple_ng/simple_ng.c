@@ -36,6 +36,7 @@ typedef struct {
     ec_PDOdesct     PDOdesc[EC_MAX_MAPT];
     ec_eepromSMt    eepSM;
     ec_eepromFMMUt  eepFMMU;
+    ec_mbxpoolt     mbxpool[EC_MAXSLAVE];
 } Fieldbus;
 
 
@@ -70,8 +71,10 @@ fieldbus_initialize(Fieldbus *fieldbus, char *iface)
     context->SMcommtype = fieldbus->SMcommtype;
     context->PDOassign = fieldbus->PDOassign;
     context->PDOdesc = fieldbus->PDOdesc;
+    context->maptworkers = EC_MAX_MAPT;
     context->eepSM = &fieldbus->eepSM;
     context->eepFMMU = &fieldbus->eepFMMU;
+    context->mbxpool = fieldbus->mbxpool;
     context->FOEhook = NULL;
     context->EOEhook = NULL;
     context->manualstatechange = 0;
@@ -283,7 +286,8 @@ fieldbus_check_state(Fieldbus *fieldbus)
 int
 main(int argc, char *argv[])
 {
-    Fieldbus fieldbus;
+    /* static, the mailbox pool alone is too large for the stack */
+    static Fieldbus fieldbus;
 
     if (argc != 2) {
         ec_adaptert * adapter = NULL;